@@ -8,7 +8,7 @@
 #include <limits>                    //Biggest int: std::numeric_limits<int>::max()
 #include "array_queue.hpp"
 #include "array_stack.hpp"
-#include "heap_priority_queue.hpp"
+#include "radix_heap_priority_queue.hpp"
 #include "hash_graph.hpp"
 #include "array_map.hpp"
 
@@ -37,9 +37,10 @@ class Info {
     std::string from = "?";
   };
   bool gt_info(const Info &a, const Info &b) { return a.cost < b.cost; }
+  int cost_key(const Info &i) { return i.cost; }
 
   typedef ics::HashGraph<int>                  DistGraph;
-  typedef ics::HeapPriorityQueue<Info, gt_info> CostPQ;
+  typedef ics::RadixHeapPriorityQueue<Info, cost_key> CostPQ;   //Costs are ints dequeued in non-decreasing order
   typedef ics::ArrayMap<std::string, Info>       CostMap;
   typedef ics::pair<std::string, Info>          CostMapEntry;
 
@@ -56,26 +57,23 @@ class Info {
     }
     info_map[start_node].cost=0;
 
-    //CostPQ info_pq(info_map);
+    //A node is enqueued again (by decrease_key) whenever a cheaper path to it is found: its earlier,
+    //  costlier Infos are dequeued after its cheapest one, and are skipped
     CostPQ info_pq;
-    for(const auto& info : info_map)
-      info_pq.enqueue(info.second);
+    info_pq.enqueue(info_map[start_node]);
 
     Info mini_cost_info;
     std::string min_node;
     int min_cost, temp_min_cost;
     int edge_value;
 
-    for(;!info_map.empty();){
+    while(!info_pq.empty()){
       mini_cost_info=info_pq.dequeue();
 
-      if(mini_cost_info.cost==std::numeric_limits<int>::max())
-        break;
-      while(answer_map.has_key(mini_cost_info.node))
-        mini_cost_info=info_pq.dequeue();
-
       min_node=mini_cost_info.node;
       min_cost=mini_cost_info.cost;
+      if(answer_map.has_key(min_node))
+        continue;
 
       info_map.erase(min_node);
       answer_map.put(min_node,mini_cost_info);
@@ -88,7 +86,7 @@ class Info {
           if(temp_min_cost < info_map[desti].cost){
             info_map[desti].cost=temp_min_cost;
             info_map[desti].from=min_node;
-            info_pq.enqueue(info_map[desti]);
+            info_pq.decrease_key(info_map[desti]);
           }
         }
       }
@@ -0,0 +1,736 @@
+#ifndef INDEXED_HEAP_PRIORITY_QUEUE_HPP_
+#define INDEXED_HEAP_PRIORITY_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <algorithm>            //For std::max
+#include "ics_exceptions.hpp"
+#include "array_stack.hpp"      //See operator <<
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+//A heap priority queue whose values can be found again, changed, and erased: enqueue returns a
+//  handle (a small int) that names its value until that value is dequeued or erased (after which
+//  the handle may be reused by enqueue). Each value stays where it is stored (indexed by its
+//  handle): the heap is an array of handles, with a position array locating each handle in it.
+//  So percolating moves ints, not Ts, and erase/update/decrease_key/increase_key are O(log N).
+//The handles in heap[used..length-1] are the unused ones, so enqueue takes heap[used].
+//
+//Instantiate the templated class supplying tgt(a,b): true, iff a has higher priority than b.
+//If tgt is defaulted to undefinedgt in the template, then a constructor must supply cgt.
+//If both tgt and cgt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class IndexedHeapPriorityQueue {
+  public:
+    typedef bool (*gtfunc) (const T& a, const T& b);
+
+    //Destructor/Constructors
+    ~IndexedHeapPriorityQueue();
+
+    IndexedHeapPriorityQueue(bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit IndexedHeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    IndexedHeapPriorityQueue(const IndexedHeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit IndexedHeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit IndexedHeapPriorityQueue (const Iterable& i, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+
+    //Queries
+    bool     empty       () const;
+    int      size        () const;
+    const T& peek        () const;
+    int      peek_handle () const;                   //The handle of the value peek returns
+    bool     has_handle  (int handle) const;         //Whether handle names a value in the queue
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    int  enqueue (const T& element);                 //Returns element's handle
+    T    dequeue ();
+    void clear   ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+    //Each raises KeyError if !has_handle(handle)
+    //For decrease_key the new value must not have lower priority (by gt) than the old (e.g., a
+    //  lower cost in Dijkstra's algorithm); for increase_key it must not have higher priority.
+    //  Each percolates in only one direction. update allows either.
+    T    erase        (int handle);
+    void update       (int handle, const T& value);
+    void decrease_key (int handle, const T& value);
+    void increase_key (int handle, const T& value);
+
+
+    //Operators
+    const T& operator [] (int handle) const;             //The value named by handle
+    IndexedHeapPriorityQueue<T,tgt>& operator = (const IndexedHeapPriorityQueue<T,tgt>& rhs);
+    bool operator == (const IndexedHeapPriorityQueue<T,tgt>& rhs) const;
+    bool operator != (const IndexedHeapPriorityQueue<T,tgt>& rhs) const;
+
+    template<class T2, bool (*gt2)(const T2& a, const T2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const IndexedHeapPriorityQueue<T2,gt2>& pq);
+
+
+
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of IndexedHeapPriorityQueue<T,tgt>
+        ~Iterator();
+        Iterator(const Iterator& to_copy);
+        Iterator& operator = (const Iterator& rhs);
+        T           erase();
+        std::string str  () const;
+        IndexedHeapPriorityQueue<T,tgt>::Iterator& operator ++ ();
+        IndexedHeapPriorityQueue<T,tgt>::Iterator  operator ++ (int);
+        bool operator == (const IndexedHeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        bool operator != (const IndexedHeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        const T& operator *  () const;
+        const T* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const IndexedHeapPriorityQueue<T,tgt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+
+        friend Iterator IndexedHeapPriorityQueue<T,tgt>::begin () const;
+        friend Iterator IndexedHeapPriorityQueue<T,tgt>::end   () const;
+
+      private:
+        //A heap of (a copy of) the handles not yet iterated over; dequeued (as ints) by ++
+        //If can_erase is false, the value has been removed from "it" (++ does nothing)
+        int*                             it;
+        int                              it_used;
+        IndexedHeapPriorityQueue<T,tgt>* ref_pq;
+        int                              expected_mod_count;
+        bool                             can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(IndexedHeapPriorityQueue<T,tgt>* iterate_over, bool from_begin);
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
+    T*   values;                         //values[h] is the value named by handle h
+    int* heap;                           //Handles, with the heap ordering property (by their values) in heap[0..used-1]
+    int* position;                       //heap[position[h]] == h for every handle h
+    int length    = 0;                   //Physical length of the arrays: must be >= .size()
+    int used      = 0;                   //Amount of heap used: invariant: 0 <= used <= length
+    int mod_count = 0;                   //For sensing concurrent modification
+
+
+    //Helper methods
+    void ensure_length  (int new_length);
+    void check_handle   (int handle, std::string where) const; //Raises KeyError if !has_handle(handle)
+    void copy           (const IndexedHeapPriorityQueue<T,tgt>& to_copy);
+    void percolate_up   (int i);
+    //Percolates down in heap a[0..n-1] of handles, updating position (if not nullptr): so it also
+    //  serves the Iterator's copy. Both move a hole, not swapping: one int move per level.
+    void percolate_down (int* a, int n, int i, int* pos) const;
+    void heapify        ();                   //Percolate down all handles in heap (from indexes used-1 to 0): O(N)
+  };
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//IndexedHeapPriorityQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::~IndexedHeapPriorityQueue() {
+  delete [] values;
+  delete [] heap;
+  delete [] position;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::IndexedHeapPriorityQueue(bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::default constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::default constructor: both specified and different");
+
+  values   = new T[length];
+  heap     = new int[length];
+  position = new int[length];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::IndexedHeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::length constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::length constructor: both specified and different");
+
+  values   = new T[0];
+  heap     = new int[0];
+  position = new int[0];
+  ensure_length(initial_length);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::IndexedHeapPriorityQueue(const IndexedHeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    gt = to_copy.gt;
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::copy constructor: both specified and different");
+
+  copy(to_copy);              //The copy's handles name the same values as to_copy's
+  if (gt != to_copy.gt)
+    heapify();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::IndexedHeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::initializer_list constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::initializer_list constructor: both specified and different");
+
+  values   = new T[0];
+  heap     = new int[0];
+  position = new int[0];
+  ensure_length(il.size());
+  for (const T& pq_elem : il)
+    values[used++] = pq_elem;  //handle h (at heap[h]) names values[h]
+  heapify();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+IndexedHeapPriorityQueue<T,tgt>::IndexedHeapPriorityQueue(const Iterable& i, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::Iterable constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("IndexedHeapPriorityQueue::Iterable constructor: both specified and different");
+
+  values   = new T[0];
+  heap     = new int[0];
+  position = new int[0];
+  ensure_length(i.size());
+  for (const T& pq_elem : i)
+    values[used++] = pq_elem;
+  heapify();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool IndexedHeapPriorityQueue<T,tgt>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int IndexedHeapPriorityQueue<T,tgt>::size() const {
+  return used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& IndexedHeapPriorityQueue<T,tgt>::peek () const {
+  if (empty())
+    throw EmptyError("IndexedHeapPriorityQueue::peek");
+
+  return values[heap[0]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int IndexedHeapPriorityQueue<T,tgt>::peek_handle () const {
+  if (empty())
+    throw EmptyError("IndexedHeapPriorityQueue::peek_handle");
+
+  return heap[0];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool IndexedHeapPriorityQueue<T,tgt>::has_handle (int handle) const {
+  return 0 <= handle && handle < length && position[handle] < used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string IndexedHeapPriorityQueue<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "IndexedHeapPriorityQueue[";
+
+  for (int i = 0; i < used; ++i)
+    answer << (i == 0 ? "" : ",") << i << ":" << heap[i] << "->" << values[heap[i]];
+
+  answer << "](length=" << length << ",used=" << used << ",mod_count=" << mod_count << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int IndexedHeapPriorityQueue<T,tgt>::enqueue(const T& element) {
+  this->ensure_length(used+1);
+  int handle = heap[used];
+  values[handle] = element;
+  percolate_up(used);
+  ++used;
+  ++mod_count;
+  return handle;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T IndexedHeapPriorityQueue<T,tgt>::dequeue() {
+  if (this->empty())
+    throw EmptyError("IndexedHeapPriorityQueue::dequeue");
+
+  return erase(heap[0]);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::clear() {
+  used = 0;
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template <class Iterable>
+int IndexedHeapPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i) {
+    enqueue(v);
+    ++count;
+  }
+
+  return count;
+}
+
+
+//Move the last handle into the erased one's place in the heap and percolate it (up or down); the
+//  erased handle goes just beyond the heap, becoming the next one enqueue uses
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T IndexedHeapPriorityQueue<T,tgt>::erase(int handle) {
+  check_handle(handle,"erase");
+  T to_return = values[handle];
+  int i = position[handle];
+  int last = heap[--used];
+  heap[used] = handle;
+  position[handle] = used;
+  if (i != used) {
+    heap[i] = last;
+    position[last] = i;
+    percolate_up(i);
+    if (heap[i] == last)
+      percolate_down(heap,used,i,position);
+  }
+
+  ++mod_count;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::update(int handle, const T& value) {
+  check_handle(handle,"update");
+  bool higher = gt(value,values[handle]);
+  values[handle] = value;
+  if (higher)
+    percolate_up(position[handle]);
+  else
+    percolate_down(heap,used,position[handle],position);
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::decrease_key(int handle, const T& value) {
+  check_handle(handle,"decrease_key");
+  if (gt(values[handle],value))
+    throw IcsError("IndexedHeapPriorityQueue::decrease_key: new value has lower priority");
+  values[handle] = value;
+  percolate_up(position[handle]);
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::increase_key(int handle, const T& value) {
+  check_handle(handle,"increase_key");
+  if (gt(value,values[handle]))
+    throw IcsError("IndexedHeapPriorityQueue::increase_key: new value has higher priority");
+  values[handle] = value;
+  percolate_down(heap,used,position[handle],position);
+  ++mod_count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& IndexedHeapPriorityQueue<T,tgt>::operator [] (int handle) const {
+  check_handle(handle,"operator []");
+  return values[handle];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>& IndexedHeapPriorityQueue<T,tgt>::operator = (const IndexedHeapPriorityQueue<T,tgt>& rhs) {
+  if (this == &rhs)
+    return *this;
+
+  gt = rhs.gt;   // if tgt != nullptr, gts are already equal (or compiler error)
+  delete [] values;
+  delete [] heap;
+  delete [] position;
+  copy(rhs);
+
+  ++mod_count;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool IndexedHeapPriorityQueue<T,tgt>::operator == (const IndexedHeapPriorityQueue<T,tgt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (gt != rhs.gt) //For PriorityQueues to be equal, they need the same gt function, and values
+    return false;
+  if (used != rhs.size())
+    return false;
+  IndexedHeapPriorityQueue<T,tgt>::Iterator l = this->begin(), r = rhs.begin();
+  for (int i=0; i<used; ++i, ++l, ++r)
+    if (*l != *r)
+      return false;
+
+  return true;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool IndexedHeapPriorityQueue<T,tgt>::operator != (const IndexedHeapPriorityQueue<T,tgt>& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::ostream& operator << (std::ostream& outs, const IndexedHeapPriorityQueue<T,tgt>& p) {
+  outs << "priority_queue[";
+
+  if (!p.empty()) {
+    ArrayStack<T> temp(p);
+    outs << temp.pop();
+    for (int i = 1; i < p.used; ++i)
+      outs << "," << temp.pop();
+  }
+
+  outs << "]:highest";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto IndexedHeapPriorityQueue<T,tgt>::begin () const -> IndexedHeapPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<IndexedHeapPriorityQueue<T,tgt>*>(this),true);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto IndexedHeapPriorityQueue<T,tgt>::end () const -> IndexedHeapPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<IndexedHeapPriorityQueue<T,tgt>*>(this),false);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//New handles (length..new_length-1) are put beyond the heap, as unused
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::ensure_length(int new_length) {
+  if (length >= new_length)
+    return;
+  T*   old_values   = values;
+  int* old_heap     = heap;
+  int* old_position = position;
+  int  old_length   = length;
+  length = std::max(new_length,2*length);
+  values   = new T[length];
+  heap     = new int[length];
+  position = new int[length];
+  for (int i=0; i<old_length; ++i) {
+    values[i]   = old_values[i];
+    heap[i]     = old_heap[i];
+    position[i] = old_position[i];
+  }
+  for (int h=old_length; h<length; ++h)
+    heap[h] = position[h] = h;
+
+  delete [] old_values;
+  delete [] old_heap;
+  delete [] old_position;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::check_handle(int handle, std::string where) const {
+  if (!has_handle(handle)) {
+    std::ostringstream answer;
+    answer << "IndexedHeapPriorityQueue::" << where << ": handle(" << handle << ") not in queue";
+    throw KeyError(answer.str());
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::copy(const IndexedHeapPriorityQueue<T,tgt>& to_copy) {
+  length   = to_copy.length;
+  used     = to_copy.used;
+  values   = new T[length];
+  heap     = new int[length];
+  position = new int[length];
+  for (int i=0; i<length; ++i) {
+    heap[i]     = to_copy.heap[i];
+    position[i] = to_copy.position[i];
+  }
+  for (int i=0; i<used; ++i)
+    values[heap[i]] = to_copy.values[heap[i]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::percolate_up(int i) {
+  int handle = heap[i];
+  for (/*parameter*/; i > 0 && gt(values[handle],values[heap[(i-1)/2]]); i = (i-1)/2) {
+    heap[i] = heap[(i-1)/2];
+    position[heap[i]] = i;
+  }
+  heap[i] = handle;
+  position[handle] = i;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::percolate_down(int* a, int n, int i, int* pos) const {
+  int handle = a[i];
+  for (int l = 2*i+1; l < n; l = 2*i+1) {
+    int max_child = (l+1 >= n || gt(values[a[l]],values[a[l+1]]) ? l : l+1);
+    if (!gt(values[a[max_child]],values[handle]))
+      break;
+    a[i] = a[max_child];
+    if (pos != nullptr)
+      pos[a[i]] = i;
+    i = max_child;
+  }
+  a[i] = handle;
+  if (pos != nullptr)
+    pos[handle] = i;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void IndexedHeapPriorityQueue<T,tgt>::heapify() {
+  for (int i = used-1; i >= 0; --i)
+    percolate_down(heap,used,i,position);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::Iterator::Iterator(IndexedHeapPriorityQueue<T,tgt>* iterate_over, bool from_begin)
+: it_used(from_begin ? iterate_over->used : 0), ref_pq(iterate_over), expected_mod_count(iterate_over->mod_count) {
+  it = new int[it_used];
+  for (int i=0; i<it_used; ++i)
+    it[i] = ref_pq->heap[i];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::Iterator::Iterator(const Iterator& to_copy)
+: it_used(to_copy.it_used), ref_pq(to_copy.ref_pq), expected_mod_count(to_copy.expected_mod_count), can_erase(to_copy.can_erase) {
+  it = new int[it_used];
+  for (int i=0; i<it_used; ++i)
+    it[i] = to_copy.it[i];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto IndexedHeapPriorityQueue<T,tgt>::Iterator::operator = (const Iterator& rhs) -> Iterator& {
+  if (this == &rhs)
+    return *this;
+  delete [] it;
+  it_used            = rhs.it_used;
+  ref_pq             = rhs.ref_pq;
+  expected_mod_count = rhs.expected_mod_count;
+  can_erase          = rhs.can_erase;
+  it = new int[it_used];
+  for (int i=0; i<it_used; ++i)
+    it[i] = rhs.it[i];
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+IndexedHeapPriorityQueue<T,tgt>::Iterator::~Iterator() {
+  delete [] it;
+}
+
+
+//Erasing by handle leaves the other values (and so the order of "it") unchanged
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T IndexedHeapPriorityQueue<T,tgt>::Iterator::erase() {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("IndexedHeapPriorityQueue::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("IndexedHeapPriorityQueue::Iterator::erase Iterator cursor already erased");
+  if (it_used == 0)
+    throw CannotEraseError("IndexedHeapPriorityQueue::Iterator::erase Iterator cursor beyond data structure");
+
+  can_erase = false;
+  int handle = it[0];
+  it[0] = it[--it_used];
+  if (it_used != 0)
+    ref_pq->percolate_down(it,it_used,0,nullptr);
+  T to_return = ref_pq->erase(handle);
+
+  expected_mod_count = ref_pq->mod_count;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string IndexedHeapPriorityQueue<T,tgt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_pq->str() << "/it=";
+  for (int i=0; i<it_used; ++i)
+    answer << (i == 0 ? "" : ",") << it[i];
+  answer << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  return answer.str();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto IndexedHeapPriorityQueue<T,tgt>::Iterator::operator ++ () -> IndexedHeapPriorityQueue<T,tgt>::Iterator& {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("IndexedHeapPriorityQueue::Iterator::operator ++");
+
+  if (it_used == 0)
+    return *this;
+
+  if (can_erase) {
+    it[0] = it[--it_used];
+    if (it_used != 0)
+      ref_pq->percolate_down(it,it_used,0,nullptr);
+  }
+  else
+    can_erase = true;
+
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto IndexedHeapPriorityQueue<T,tgt>::Iterator::operator ++ (int) -> IndexedHeapPriorityQueue<T,tgt>::Iterator {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("IndexedHeapPriorityQueue::Iterator::operator ++(int)");
+
+  if (it_used == 0)
+    return *this;
+
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool IndexedHeapPriorityQueue<T,tgt>::Iterator::operator == (const IndexedHeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("IndexedHeapPriorityQueue::Iterator::operator ==");
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("IndexedHeapPriorityQueue::Iterator::operator ==");
+  if (ref_pq != rhsASI->ref_pq)
+    throw ComparingDifferentIteratorsError("IndexedHeapPriorityQueue::Iterator::operator ==");
+
+  //Two iterators on the same heap are equal if their sizes are equal
+  return this->it_used == rhsASI->it_used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool IndexedHeapPriorityQueue<T,tgt>::Iterator::operator != (const IndexedHeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& IndexedHeapPriorityQueue<T,tgt>::Iterator::operator *() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("IndexedHeapPriorityQueue::Iterator::operator *");
+  if (!can_erase || it_used == 0)
+    throw IteratorPositionIllegal("IndexedHeapPriorityQueue::Iterator::operator * Iterator illegal");
+
+  return ref_pq->values[it[0]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T* IndexedHeapPriorityQueue<T,tgt>::Iterator::operator ->() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("IndexedHeapPriorityQueue::Iterator::operator ->");
+  if (!can_erase || it_used == 0)
+    throw IteratorPositionIllegal("IndexedHeapPriorityQueue::Iterator::operator -> Iterator illegal");
+
+  return &ref_pq->values[it[0]];
+}
+
+}
+
+#endif /* INDEXED_HEAP_PRIORITY_QUEUE_HPP_ */
@@ -0,0 +1,388 @@
+#ifndef RADIX_HEAP_PRIORITY_QUEUE_HPP_
+#define RADIX_HEAP_PRIORITY_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <utility>              //For std::move
+#include <algorithm>            //For std::max
+#include "ics_exceptions.hpp"
+
+
+namespace ics {
+
+
+#ifndef undefinedkeydefined
+#define undefinedkeydefined
+template<class T>
+int undefinedkey (const T& a) {return -1;}
+#endif /* undefinedkeydefined */
+
+//A monotone priority queue for values with non-negative int keys (e.g., costs in Dijkstra's
+//  algorithm), dequeued smallest key first, where no value is enqueued with a key smaller than
+//  the last key dequeued (last): enqueue raises IcsError if it is.
+//Bucket 0 stores values whose key == last; bucket b (1 <= b <= 31) stores values whose key
+//  first differs from last in bit b-1 (counting from 0 at the right): the highest differing bit.
+//  When bucket 0 is empty, dequeue finds the smallest key in the first non-empty bucket, makes it
+//  last, and moves that bucket's values into lower-numbered buckets. A value moves down at most
+//  31 times, so each operation is amortized O(log C) (C the biggest key), and each bucket is a pair
+//  of arrays scanned/appended sequentially.
+//There is no way to find a value again: to decrease a value's key, enqueue it again with the
+//  smaller key (decrease_key does just this) and ignore its other (now stale) copy when it is
+//  dequeued later, as Dijkstra's algorithm does with nodes whose cost is already known.
+//
+//Instantiate the templated class supplying tkey(a): the key of value a.
+//If tkey is defaulted to undefinedkey in the template, then a constructor must supply ckey.
+//If both tkey and ckey are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedkey value supplied by tkey/ckey is stored in the instance variable key.
+template<class T, int (*tkey)(const T& a) = undefinedkey<T>> class RadixHeapPriorityQueue {
+  public:
+    typedef int (*keyfunc) (const T& a);
+
+    //Destructor/Constructors
+    ~RadixHeapPriorityQueue();
+
+    RadixHeapPriorityQueue(int (*ckey)(const T& a) = undefinedkey<T>);
+    RadixHeapPriorityQueue(const RadixHeapPriorityQueue<T,tkey>& to_copy, int (*ckey)(const T& a) = undefinedkey<T>);
+    explicit RadixHeapPriorityQueue(const std::initializer_list<T>& il, int (*ckey)(const T& a) = undefinedkey<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit RadixHeapPriorityQueue (const Iterable& i, int (*ckey)(const T& a) = undefinedkey<T>);
+
+
+    //Queries
+    bool     empty    () const;
+    int      size     () const;
+    const T& peek     () const;              //A value with the smallest key
+    int      last_key () const;              //The smallest key that enqueue allows
+    std::string str () const; //supplies useful debugging information
+
+
+    //Commands
+    int  enqueue      (const T& element);
+    int  decrease_key (const T& element);    //Same as enqueue: see above
+    T    dequeue      ();
+    void clear        ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    RadixHeapPriorityQueue<T,tkey>& operator = (const RadixHeapPriorityQueue<T,tkey>& rhs);
+
+
+  private:
+    class Bucket {
+      public:
+        int* keys   = nullptr;               //keys[i] is the key of values[i]
+        T*   values = nullptr;
+        int  length = 0;                     //Physical length of both arrays
+        int  used   = 0;                     //Amount of both arrays used
+
+        ~Bucket();
+        void ensure_length (int new_length);
+        void append        (int key, T&& value);
+    };
+
+    static const int BUCKETS = 8*sizeof(int);  //0..31: keys are non-negative ints (31 bits)
+
+    int (*key) (const T& a);                 //The key used by enqueue (from template or constructor)
+    Bucket buckets[BUCKETS];
+    int last = 0;                            //Last key dequeued (0 initially)
+    int used = 0;                            //Number of values in all buckets
+
+
+    //Helper methods
+    int  bucket_of  (int k) const;           //Bucket storing a value whose key is k
+    int  min_bucket () const;                //Lowest-numbered non-empty bucket (when !empty())
+    int  min_index  (const Bucket& b) const; //Index of the smallest key in b (when b.used > 0)
+    void copy_from  (const RadixHeapPriorityQueue<T,tkey>& other);
+  };
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//RadixHeapPriorityQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, int (*tkey)(const T& a)>
+RadixHeapPriorityQueue<T,tkey>::~RadixHeapPriorityQueue()
+{}
+
+
+template<class T, int (*tkey)(const T& a)>
+RadixHeapPriorityQueue<T,tkey>::RadixHeapPriorityQueue(int (*ckey)(const T& a))
+: key(tkey != (keyfunc)undefinedkey<T> ? tkey : ckey) {
+  if (key == (keyfunc)undefinedkey<T>)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::default constructor: neither specified");
+  if (tkey != (keyfunc)undefinedkey<T> && ckey != (keyfunc)undefinedkey<T> && tkey != ckey)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::default constructor: both specified and different");
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+RadixHeapPriorityQueue<T,tkey>::RadixHeapPriorityQueue(const RadixHeapPriorityQueue<T,tkey>& to_copy, int (*ckey)(const T& a))
+: key(tkey != (keyfunc)undefinedkey<T> ? tkey : ckey) {
+  if (key == (keyfunc)undefinedkey<T>)
+    key = to_copy.key;
+  if (tkey != (keyfunc)undefinedkey<T> && ckey != (keyfunc)undefinedkey<T> && tkey != ckey)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::copy constructor: both specified and different");
+
+  if (key == to_copy.key)
+    copy_from(to_copy);
+  else                                   //Different key: recompute each value's bucket
+    for (const Bucket& b : to_copy.buckets)
+      for (int i=0; i<b.used; ++i)
+        enqueue(b.values[i]);
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+RadixHeapPriorityQueue<T,tkey>::RadixHeapPriorityQueue(const std::initializer_list<T>& il, int (*ckey)(const T& a))
+: key(tkey != (keyfunc)undefinedkey<T> ? tkey : ckey) {
+  if (key == (keyfunc)undefinedkey<T>)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::initializer_list constructor: neither specified");
+  if (tkey != (keyfunc)undefinedkey<T> && ckey != (keyfunc)undefinedkey<T> && tkey != ckey)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::initializer_list constructor: both specified and different");
+
+  for (const T& pq_elem : il)
+    enqueue(pq_elem);
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+template<class Iterable>
+RadixHeapPriorityQueue<T,tkey>::RadixHeapPriorityQueue(const Iterable& i, int (*ckey)(const T& a))
+: key(tkey != (keyfunc)undefinedkey<T> ? tkey : ckey) {
+  if (key == (keyfunc)undefinedkey<T>)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::Iterable constructor: neither specified");
+  if (tkey != (keyfunc)undefinedkey<T> && ckey != (keyfunc)undefinedkey<T> && tkey != ckey)
+    throw TemplateFunctionError("RadixHeapPriorityQueue::Iterable constructor: both specified and different");
+
+  enqueue_all(i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, int (*tkey)(const T& a)>
+bool RadixHeapPriorityQueue<T,tkey>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::size() const {
+  return used;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+const T& RadixHeapPriorityQueue<T,tkey>::peek () const {
+  if (empty())
+    throw EmptyError("RadixHeapPriorityQueue::peek");
+
+  const Bucket& b = buckets[min_bucket()];
+  return b.values[min_index(b)];
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::last_key () const {
+  return last;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+std::string RadixHeapPriorityQueue<T,tkey>::str() const {
+  std::ostringstream answer;
+  answer << "radix_heap_priority_queue[";
+  bool first = true;
+  for (int b=0; b<BUCKETS; ++b)
+    if (buckets[b].used > 0) {
+      answer << (first ? "" : ",") << b << ":[";
+      for (int i=0; i<buckets[b].used; ++i)
+        answer << (i == 0 ? "" : ",") << buckets[b].keys[i] << "->" << buckets[b].values[i];
+      answer << "]";
+      first = false;
+    }
+  answer << "](last=" << last << ",used=" << used << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::enqueue(const T& element) {
+  int k = key(element);
+  if (k < last) {
+    std::ostringstream answer;
+    answer << "RadixHeapPriorityQueue::enqueue: key(" << k << ") < last dequeued key(" << last << ")";
+    throw IcsError(answer.str());
+  }
+  buckets[bucket_of(k)].append(k,T(element));
+  ++used;
+  return 1;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::decrease_key(const T& element) {
+  return enqueue(element);
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+T RadixHeapPriorityQueue<T,tkey>::dequeue() {
+  if (empty())
+    throw EmptyError("RadixHeapPriorityQueue::dequeue");
+
+  Bucket& zero = buckets[0];
+  if (zero.used == 0) {
+    //Redistribute the first non-empty bucket around its smallest key: every value moves to a
+    //  lower-numbered bucket (they all agree with the new last above the bucket's bit)
+    Bucket& b = buckets[min_bucket()];
+    last = b.keys[min_index(b)];
+    for (int i=0; i<b.used; ++i)
+      buckets[bucket_of(b.keys[i])].append(b.keys[i],std::move(b.values[i]));
+    b.used = 0;
+  }
+  --used;
+  return std::move(zero.values[--zero.used]);
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+void RadixHeapPriorityQueue<T,tkey>::clear() {
+  for (Bucket& b : buckets)
+    b.used = 0;
+  used = 0;
+  last = 0;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+template<class Iterable>
+int RadixHeapPriorityQueue<T,tkey>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, int (*tkey)(const T& a)>
+RadixHeapPriorityQueue<T,tkey>& RadixHeapPriorityQueue<T,tkey>::operator = (const RadixHeapPriorityQueue<T,tkey>& rhs) {
+  if (this == &rhs)
+    return *this;
+  key = rhs.key;
+  copy_from(rhs);
+  return *this;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Bucket definitions
+
+template<class T, int (*tkey)(const T& a)>
+RadixHeapPriorityQueue<T,tkey>::Bucket::~Bucket() {
+  delete [] keys;
+  delete [] values;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+void RadixHeapPriorityQueue<T,tkey>::Bucket::ensure_length(int new_length) {
+  if (length >= new_length)
+    return;
+  int* keys_old   = keys;
+  T*   values_old = values;
+  length = std::max(new_length, 2*length);
+  keys   = new int[length];
+  values = new T[length];
+  for (int i=0; i<used; ++i) {
+    keys[i]   = keys_old[i];
+    values[i] = std::move(values_old[i]);
+  }
+  delete [] keys_old;
+  delete [] values_old;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+void RadixHeapPriorityQueue<T,tkey>::Bucket::append(int key, T&& value) {
+  ensure_length(used+1);
+  keys[used]     = key;
+  values[used++] = std::move(value);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::bucket_of(int k) const {
+  unsigned differ = (unsigned)k ^ (unsigned)last;
+  return differ == 0 ? 0 : BUCKETS - __builtin_clz(differ);
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::min_bucket() const {
+  int b = 0;
+  while (buckets[b].used == 0)
+    ++b;
+  return b;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+int RadixHeapPriorityQueue<T,tkey>::min_index(const Bucket& b) const {
+  int answer = 0;
+  for (int i=1; i<b.used; ++i)
+    if (b.keys[i] < b.keys[answer])
+      answer = i;
+  return answer;
+}
+
+
+template<class T, int (*tkey)(const T& a)>
+void RadixHeapPriorityQueue<T,tkey>::copy_from(const RadixHeapPriorityQueue<T,tkey>& other) {
+  for (int b=0; b<BUCKETS; ++b) {
+    Bucket&       to   = buckets[b];
+    const Bucket& from = other.buckets[b];
+    to.used = 0;
+    to.ensure_length(from.used);
+    for (int i=0; i<from.used; ++i) {
+      to.keys[i]   = from.keys[i];
+      to.values[i] = from.values[i];
+    }
+    to.used = from.used;
+  }
+  last = other.last;
+  used = other.used;
+}
+
+}
+
+#endif /* RADIX_HEAP_PRIORITY_QUEUE_HPP_ */
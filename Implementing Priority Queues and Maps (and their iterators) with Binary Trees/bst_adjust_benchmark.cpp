@@ -0,0 +1,73 @@
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cmath>              //For std::pow
+#include <cstdlib>            //For std::atof
+#include "bst_map.hpp"
+
+
+//has_key time of each BSTMap Adjust mode (see set_adjust) on a Zipfian trace: the key of rank r
+//  (ranks assigned to the keys at random) is looked up with probability proportional to 1/r^s.
+//N keys are put in random order, then Q lookups are timed; s = 0 makes the lookups uniform.
+
+const int N = 1000000;
+const int Q = 5000000;
+
+bool int_lt(const int& a, const int& b) {return a < b;}
+
+typedef ics::BSTMap<int,int,int_lt> Map;
+
+
+//The optional arguments are the values of s (default: 0, 0.99, 1.2, 1.5)
+int main(int argc, char* argv[]) {
+  std::vector<double> exponents;
+  for (int i=1; i<argc; ++i)
+    exponents.push_back(std::atof(argv[i]));
+  if (exponents.empty())
+    exponents = {0, 0.99, 1.2, 1.5};
+
+  std::mt19937 random(7);
+  std::vector<int> keys(N);
+  for (int i=0; i<N; ++i)
+    keys[i] = 2*i;
+  std::shuffle(keys.begin(),keys.end(),random);
+
+  std::cout << "s      BALANCED  UNBALANCED  SPLAY  SEMI_SPLAY  (ns/lookup)" << std::endl;
+  for (double s : exponents) {
+    std::vector<double> cdf(N);
+    double sum = 0;
+    for (int i=0; i<N; ++i)
+      cdf[i] = sum += 1/std::pow(i+1,s);
+    std::uniform_real_distribution<double> uniform(0,sum);
+    std::vector<int> lookups(Q);
+    for (int i=0; i<Q; ++i)
+      lookups[i] = keys[std::lower_bound(cdf.begin(),cdf.end(),uniform(random)) - cdf.begin()];
+
+    std::cout << s;
+    for (int mode=0; mode<4; ++mode) {
+      Map m;
+      m.set_adjust(Map::Adjust(mode));
+      for (int k : keys)
+        m.put(k,k);
+      auto start = std::chrono::steady_clock::now();
+      long long found = 0;
+      for (int k : lookups)
+        found += m.has_key(k);
+      double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+      std::cout << "  " << seconds/Q*1e9 << (found == Q ? "" : " (MISSED)");
+    }
+    std::cout << std::endl;
+  }
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2): the writes that splaying does on every read cost more than
+//  its shorter paths save, even at s = 1.5 (see the comment on Adjust).
+//s      BALANCED  UNBALANCED  SPLAY  SEMI_SPLAY  (ns/lookup)
+//0         554      1515       2002    1947
+//0.99      251       480        920     760
+//1.2       109       139        353     371
+//1.5        47        42         98     122
@@ -9,9 +9,12 @@
 #include <iostream>
 #include <sstream>
 #include <initializer_list>
+#include <atomic>                //For NB::live (TNs may be deleted by parallel set operations)
+#include <future>                //For std::async in parallel set operations
+#include <thread>
 #include "ics_exceptions.hpp"
 #include "pair.hpp"
-#include "array_queue.hpp"   //For traversal
+#include "frozen_map.hpp"         //See freeze
 
 
 namespace ics {
@@ -33,6 +36,17 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedl
     typedef pair<KEY,T> Entry;
     typedef bool (*ltfunc) (const KEY& a, const KEY& b);
 
+    //How the tree changes its shape as it is used (see set_adjust):
+    //  BALANCED:   weight balanced by join (the default)
+    //  UNBALANCED: a plain BST (no rebalancing)
+    //  SPLAY:      every access (put, erase, [], has_key) moves its node to the root, so
+    //                frequently accessed keys stay near the root (amortized O(log N))
+    //  SEMI_SPLAY: like SPLAY for put/erase, but has_key and [] semi-splay (rotating about half as
+    //                often, and moving their nodes only about halfway up), to limit writes on reads
+    //Splaying writes to the tree on every read, so it pays only when accesses are very skewed
+    //  and the map is large; measured on Zipfian lookups, BALANCED was still 2-3x faster
+    enum Adjust {BALANCED, UNBALANCED, SPLAY, SEMI_SPLAY};
+
     //Destructor/Constructors
     ~BSTMap();
 
@@ -41,6 +55,7 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedl
     explicit BSTMap (const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
 
     //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    //If i iterates in increasing key order, the tree is built directly (see put_all_sorted)
     template <class Iterable>
     explicit BSTMap (const Iterable& i, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
 
@@ -52,16 +67,44 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedl
     bool has_value  (const T& value) const;
     std::string str () const; //supplies useful debugging information; contrast to operator <<
 
+    //A copy that cannot change, in an array laid out for faster searching (see frozen_map.hpp):
+    //  for maps that are built once and then only searched
+    FrozenMap<KEY,T,tlt> freeze () const;
+
 
     //Commands
     T    put   (const KEY& key, const T& value);
     T    erase (const KEY& key);
     void clear ();
+    void set_adjust (Adjust how);              //Changing to BALANCED rebuilds the tree (O(N))
+    Adjust adjust   () const;
 
     //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
     template <class Iterable>
     int put_all(const Iterable& i);
 
+    //Bulk loads: i should iterate in increasing key order (for equal keys, the last value is kept).
+    //put_all_sorted builds an empty map as a height-balanced tree in O(N), with all its TNs in one
+    //  allocation; for a non-empty map it merges. merge inserts a sorted run into this map: a long
+    //  run is merged with this map's associations in O(N+M) and the tree rebuilt; a short one is put.
+    //Either falls back to put (one association at a time) if i is not actually sorted.
+    template <class Iterable>
+    int put_all_sorted(const Iterable& i);
+    template <class Iterable>
+    int merge(const Iterable& sorted_run);
+
+    //Join-based operations: split/join are O(log N); the set operations are O(m log(n/m+1)) for
+    //  maps of sizes m <= n. Above PARALLEL_CUTOFF associations, a set operation computes its two
+    //  recursive halves on separate threads (down to a depth that keeps all cores busy).
+    //They recurse on the trees' shapes, so a map that is not BALANCED (whose tree may be a path)
+    //  is first rebuilt balanced (adding O(N), or O(M) for a copy of other).
+    //For union_with, other's values replace this map's values for keys in both maps.
+    void split          (const KEY& key, BSTMap<KEY,T,tlt>& greater); //Move keys >= key into greater (its old ones are cleared)
+    void join           (BSTMap<KEY,T,tlt>& greater);                 //Move all of greater (keys all > this map's) into this map
+    void union_with     (const BSTMap<KEY,T,tlt>& other);             //Put all of other's associations
+    void intersect_with (const BSTMap<KEY,T,tlt>& other);             //Erase the keys not in other
+    void difference     (const BSTMap<KEY,T,tlt>& other);             //Erase the keys in other
+
 
     //Operators
 
@@ -76,6 +119,10 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedl
 
 
 
+  private:
+    class TN;
+
+  public:
     class Iterator {
       public:
         //Private constructor called in begin/end, which are friends of BSTMap<T>
@@ -92,18 +139,30 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedl
           outs << i.str(); //Use the same meaning as the debugging .str() method
           return outs;
         }
-        friend Iterator BSTMap<KEY,T,tlt>::begin () const;
-        friend Iterator BSTMap<KEY,T,tlt>::end   () const;
+        friend class BSTMap<KEY,T,tlt>;
 
       private:
-        //If can_erase is false, the value has been removed from "it" (++ does nothing)
-        ArrayQueue<Entry> it;                 //Queue for all associations (from begin); use it as iterator with dequeue
+        //Iterates in key order (an in-order walk using parent pointers)
+        //If can_erase is false, current is already the "next" node (++ does nothing)
+        TN*                current;           //nullptr when beyond the last association
         BSTMap<KEY,T,tlt>* ref_map;
-        int               expected_mod_count;
-        bool              can_erase = true;
+        int                expected_mod_count;
+        bool               can_erase = true;
 
-        //Called in friends begin/end
-        Iterator(BSTMap<KEY,T,tlt>* iterate_over, bool from_begin);
+        //Called in begin/end/lower_bound/upper_bound/select
+        Iterator(BSTMap<KEY,T,tlt>* iterate_over, TN* initial);
+    };
+
+
+    //The associations whose keys are in [lo,hi), in key order: use in a "for-each" loop
+    class Range {
+      public:
+        Iterator begin () const {return first;}
+        Iterator end   () const {return last;}
+      private:
+        Iterator first, last;
+        Range(const Iterator& f, const Iterator& l) : first(f), last(l){}
+        friend class BSTMap<KEY,T,tlt>;
     };
 
 
@@ -111,37 +170,128 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedl
     Iterator end   () const;
 
 
+    //Order statistics (each walks one root-to-leaf path, using the subtree sizes cached in TN)
+    Iterator lower_bound    (const KEY& key)                 const; //First association whose key is not less than key
+    Iterator upper_bound    (const KEY& key)                 const; //First association whose key is greater than key
+    int      rank           (const KEY& key)                 const; //Number of keys less than key
+    Iterator select         (int k)                          const; //Association whose rank is k (end() if k is not in [0,size()))
+    Range    range          (const KEY& lo, const KEY& hi)   const; //Associations whose keys are in [lo,hi)
+    int      count_in_range (const KEY& lo, const KEY& hi)   const; //Number of keys in [lo,hi)
+
+    //Finger searches: start at hint's node (the root for end()), climbing only as far as needed to
+    //  reach a subtree that could hold key, so a key d positions away takes about O(log d) compares.
+    //  put/erase/[] (non-const)/find do the same from the node last accessed by one of them (its
+    //  "finger"), so runs of nearby keys (e.g., sorted or clustered ones) are found quickly; while
+    //  accesses are not near each other, they search from the root (see start). put_hint returns
+    //  an Iterator at key (for use as the next hint); find_near and find return one at key, or
+    //  end() if key is absent.
+    //The const has_key and [] always search from the root and never move the finger, so (except
+    //  in the splaying modes, whose reads change the tree) several threads may read a map at once;
+    //  use find for runs of nearby lookups.
+    Iterator put_hint       (const Iterator& hint, const KEY& key, const T& value);
+    Iterator find_near      (const Iterator& hint, const KEY& key)   const;
+    Iterator find           (const KEY& key);
+
+
   private:
+    class NB;
+
     class TN {
       public:
-        TN ()                     : left(nullptr), right(nullptr){}
-        TN (const TN& tn)         : value(tn.value), left(tn.left), right(tn.right){}
+        TN ()                     : left(nullptr), right(nullptr), parent(nullptr), size(1), block(nullptr){}
+        TN (const TN& tn)         : value(tn.value), left(tn.left), right(tn.right), parent(tn.parent), size(tn.size), block(nullptr){}
         TN (Entry v, TN* l = nullptr,
-                     TN* r = nullptr) : value(v), left(l), right(r){}
+                     TN* r = nullptr) : value(v), left(l), right(r), parent(nullptr), size(1), block(nullptr){}
 
         Entry value;
         TN*   left;
         TN*   right;
+        TN*   parent;                   //nullptr at the root: lets Iterator find in-order successors
+        int   size;                     //Number of nodes in this subtree (for rank/select)
+        NB*   block;                    //nullptr if allocated by itself with new; otherwise, see NB
     };
 
-  bool (*lt) (const KEY& a, const KEY& b); // The lt used for searching BST (from template or constructor)
-  TN* map       = nullptr;
-  int used      = 0;                       //Cache the number of key->value pairs in the BST
-  int mod_count = 0;                       //For sensing concurrent modification
+    //A block of TNs allocated together by a bulk build; the storage is freed when its last TN is
+    //  deleted (see delete_node), so TNs from blocks and TNs allocated by new can mix in one tree.
+    class NB {
+      public:
+        NB (int n) : nodes(static_cast<TN*>(::operator new(n*sizeof(TN)))), live(n){}
+
+        TN*              nodes;
+        std::atomic<int> live;          //Number of TNs in nodes not yet deleted
+    };
 
-  //Helper methods (find_key written iteratively, the rest recursively)
+  //The tree is weight balanced: for every node, each subtree's weight (size+1) is at least
+  //  ALPHA_PERCENT percent of the node's weight, so its height is at most about 2*log2(N).
+  //All rebalancing is done by join (see Blelloch, Ferizovic, and Sun, "Just Join for Parallel
+  //  Ordered Sets"), which put/erase call on each node along their paths.
+  static const int ALPHA_PERCENT   = 29;
+  static const int PARALLEL_CUTOFF = 1<<16;
+
+  bool (*lt) (const KEY& a, const KEY& b); // The lt used for searching BST (from template or constructor)
+  mutable TN* map = nullptr;               //mutable: has_key and [] const may splay
+  int used        = 0;                     //Cache the number of key->value pairs in the BST
+  int mod_count   = 0;                     //For sensing concurrent modification
+  Adjust how      = BALANCED;
+  TN* finger      = nullptr;               //Last node accessed by put/erase/[]/find (or nullptr)
+  int finger_credit = 1;                   //> 0: last finger search was near; < 0: root searches left before retrying
+  static const int FINGER_RETRY = 16;
+
+  //Helper methods (all iterative, as an UNBALANCED/SPLAY tree may be a path of N nodes)
   TN*   find_key            (TN*  root, const KEY& key)                 const; //Returns reference to key's node or nullptr
   bool  has_value           (TN*  root, const T& value)                 const; //Returns whether value is is root's tree
   TN*   copy                (TN*  root)                                 const; //Copy the keys/values in root's tree (identical structure)
-  void  copy_to_queue       (TN* root, ArrayQueue<Entry>& q)            const; //Fill queue with root's tree value
   bool  equals              (TN*  root, const BSTMap<KEY,T,tlt>& other) const; //Returns whether root's keys/value are all in other
   std::string string_rotated(TN* root, std::string indent)              const; //Returns string representing root's tree
 
-  T     insert              (TN*& root, const KEY& key, const T& value);       //Put key->value, returning key's old value (or new one's, if key absent)
-  T&    find_addempty       (TN*& root, const KEY& key);                       //Return reference to key's value (adding key->T() first, if key absent)
-  Entry remove_closest      (TN*& root);                                       //Helper for remove
-  T     remove              (TN*& root, const KEY& key);                       //Remove key->value from root's tree
-  void  delete_BST          (TN*& root);                                       //Deallocate all TN in tree; root == nullptr
+  TN*   near                (TN*  from, const KEY& key)                 const; //Lowest ancestor of from whose subtree could hold key (map for nullptr)
+  TN*   start               (const KEY& key);                                  //Where put/erase/[]/find search for key: near(finger,key) or map
+  TN*   find_addempty       (TN* start, const KEY& key, const T& value, bool& added); //Return key's node (adding key->value first, if key absent)
+  void  fix_up              (TN* node);                                        //Restore sizes (and balance) from node up to the root
+  void  replace_child       (TN* parent, TN* old_child, TN* new_child) const;  //Make new_child parent's (or the root, if nullptr)
+  static void delete_BST    (TN*& root);                                       //Deallocate all TN in tree; root == nullptr
+  void  rebalance           ();                                                //Rebuild the tree perfectly balanced (O(N))
+
+  //Helpers for splaying (const, as has_key/[] const splay)
+  void  rotate_up           (TN* node)                                  const; //Rotate node above its parent
+  void  splay               (TN* node)                                  const; //Rotate node up to the root
+  void  semi_splay          (TN* node)                                  const;
+  TN*   accessed            (TN* node, bool read)                       const; //Splay node as how says; return it
+  TN*   rebuild             (TN** nodes, int low, int high);                   //Perfectly balanced tree of nodes[low,high)
+
+  //Helpers for subtree sizes/parents and in-order walks (all iterative)
+  static int  size_of  (TN* root);                                             //0 for nullptr
+  static void update   (TN* root);                                             //Recompute root's size; point its children back at it
+  static TN*  leftmost (TN* root);
+  static TN*  successor(TN* node);                                             //Next node in key order (nullptr at the end)
+
+  //Helpers for bulk loads
+  static void delete_node   (TN* node);                                        //delete node, whether or not it is in an NB
+  TN*   build_balanced      (Entry* sorted, int n)                      const; //Height-balanced tree of sorted[0,n), in one NB
+  TN*   build_balanced      (Entry* sorted, int low, int high, NB* nb, int& next) const;
+  int   flatten             (Entry* into)                               const; //Copy associations into "into" in key order
+  int   compact_sorted      (Entry* run, int n)                         const; //Drop equal keys (keep last); -1 if not sorted
+  void  merge_sorted        (Entry* run, int n);                               //Put all of sorted (compacted) run[0,n)
+  template <class Iterable>
+  int   to_array            (const Iterable& i, Entry*& into)           const; //Allocate into (doubling as needed), copy i into it
+  TN*   lower_node          (const KEY& key, bool strict)               const; //First node with key >= key (> key if strict)
+
+  //Helpers for balancing: each returns the root of the tree it builds (whose parent is not set)
+  static bool balanced      (int weight1, int weight2);                        //Could be siblings in a balanced tree
+  static TN*  link          (TN* m, TN* l, TN* r);                             //m with subtrees l and r (no rebalancing)
+  static TN*  rotate_left   (TN* root);
+  static TN*  rotate_right  (TN* root);
+  static TN*  join          (TN* l, TN* m, TN* r);                             //Balanced tree of l, m, r (l's keys < m's < r's)
+  static TN*  join_right    (TN* l, TN* m, TN* r);                             //join when l is much heavier than r
+  static TN*  join_left     (TN* l, TN* m, TN* r);                             //join when r is much heavier than l
+  static TN*  join2         (TN* l, TN* r);                                    //join without a middle node
+  static TN*  split_last    (TN* root, TN*& rest);                             //Return root's last node; rest is the others (iterative)
+  static TN*  splice        (TN* l, TN* r);                                    //join2 by moving l's last node up (no rebalancing)
+  static int  parallel_depth();                                                //How many levels of set operations fork
+  void  split               (TN* root, const KEY& key, TN*& less, TN*& found, TN*& greater) const; //Iterative
+  TN*   union_of            (TN* root, TN* other, int depth)            const; //other's tree is copied, not changed
+  TN*   intersection_of     (TN* root, TN* other, int depth)            const;
+  TN*   difference_of       (TN* root, TN* other, int depth)            const;
 };
 
 
@@ -172,7 +322,7 @@ BSTMap<KEY,T,tlt>::BSTMap(bool (*clt)(const KEY& a, const KEY& b))
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 BSTMap<KEY,T,tlt>::BSTMap(const BSTMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b))
-    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt), mod_count(to_copy.mod_count){
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt), mod_count(to_copy.mod_count), how(to_copy.how){
   if(lt==(ltfunc)undefinedlt<KEY>)
     lt=to_copy.lt;
   if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
@@ -181,6 +331,8 @@ BSTMap<KEY,T,tlt>::BSTMap(const BSTMap<KEY,T,tlt>& to_copy, bool (*clt)(const KE
   if(lt==to_copy.lt) {
     used=to_copy.used;
     map = copy(to_copy.map);
+    if(map!= nullptr)
+      map->parent= nullptr;
   }
   else{
     lt=to_copy.lt;
@@ -211,8 +363,7 @@ BSTMap<KEY,T,tlt>::BSTMap(const Iterable& i, bool (*clt)(const KEY& a, const KEY
     throw TemplateFunctionError("BSTMap::Iterable constructor: neither specified");
   if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
     throw TemplateFunctionError("BSTMap::Iterable constructor: both specified and different");
-  for(const BSTMap::Entry& e:i)
-    put(e.first,e.second);
+  put_all_sorted(i);
 }
 
 
@@ -234,7 +385,10 @@ int BSTMap<KEY,T,tlt>::size() const {
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 bool BSTMap<KEY,T,tlt>::has_key (const KEY& key) const {
-  return find_key(map,key)!= nullptr;
+  TN* node=find_key(map,key);
+  if(node!= nullptr)
+    accessed(node,true);
+  return node!= nullptr;
 }
 
 
@@ -252,6 +406,12 @@ std::string BSTMap<KEY,T,tlt>::str() const {
 }
 
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::freeze() const -> FrozenMap<KEY,T,tlt> {
+  return FrozenMap<KEY,T,tlt>(*this,lt);   //Iterates in key order, so O(N)
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 //Commands
@@ -259,13 +419,30 @@ std::string BSTMap<KEY,T,tlt>::str() const {
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 T BSTMap<KEY,T,tlt>::put(const KEY& key, const T& value) {
   ++mod_count;
-  return insert(map,key,value);
+  bool added;
+  TN* node=finger=accessed(find_addempty(start(key),key,value,added),false);
+  if(added)
+    return value;
+  T to_return=node->value.second;
+  node->value.second=value;
+  return to_return;
 }
 
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 T BSTMap<KEY,T,tlt>::erase(const KEY& key) {
-  T removed=remove(map,key);
+  TN* node=find_key(start(key),key);
+  if(node== nullptr){
+    std::ostringstream answer;
+    answer << "BSTMap::erase: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  T removed=node->value.second;
+  TN* parent=node->parent;
+  replace_child(parent,node,how==BALANCED ? join2(node->left,node->right) : splice(node->left,node->right));
+  delete_node(node);
+  fix_up(parent);
+  finger=(parent!= nullptr ? accessed(parent,false) : map);
   --used;
   ++mod_count;
   return removed;
@@ -275,11 +452,28 @@ T BSTMap<KEY,T,tlt>::erase(const KEY& key) {
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 void BSTMap<KEY,T,tlt>::clear() {
   delete_BST(map);
+  finger= nullptr;
   mod_count++;
   used=0;
 }
 
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::set_adjust(Adjust how) {
+  if(how==BALANCED && this->how!=BALANCED && map!= nullptr){
+    rebalance();
+    ++mod_count;
+  }
+  this->how=how;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::adjust() const -> Adjust {
+  return how;
+}
+
+
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 template<class Iterable>
 int BSTMap<KEY,T,tlt>::put_all(const Iterable& i) {
@@ -292,13 +486,185 @@ int BSTMap<KEY,T,tlt>::put_all(const Iterable& i) {
 }
 
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int BSTMap<KEY,T,tlt>::put_all_sorted(const Iterable& i) {
+  if(map!= nullptr)
+    return merge(i);
+  Entry* run;
+  int count=to_array(i,run);
+  int n=compact_sorted(run,count);
+  if(n==-1)
+    for(int j=0; j<count; ++j)
+      put(run[j].first,run[j].second);
+  else if(n>0){
+    map=build_balanced(run,n);
+    used=n;
+    ++mod_count;
+  }
+  delete [] run;
+  return count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int BSTMap<KEY,T,tlt>::merge(const Iterable& sorted_run) {
+  Entry* run;
+  int count=to_array(sorted_run,run);
+  int n=compact_sorted(run,count);
+  if(n==-1)
+    for(int j=0; j<count; ++j)
+      put(run[j].first,run[j].second);
+  else
+    merge_sorted(run,n);
+  delete [] run;
+  return count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::split(const KEY& key, BSTMap<KEY,T,tlt>& greater) {
+  if(this==&greater)
+    return;
+  greater.clear();
+  greater.lt=lt;
+  finger= nullptr;
+  if(how!=BALANCED)
+    rebalance();
+  TN *less, *found;
+  split(map,key,less,found,greater.map);
+  if(found!= nullptr)
+    greater.map=join(nullptr,found,greater.map);
+  map=less;
+  if(map!= nullptr)
+    map->parent= nullptr;
+  if(greater.map!= nullptr)
+    greater.map->parent= nullptr;
+  used=size_of(map);
+  greater.used=size_of(greater.map);
+  ++mod_count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::join(BSTMap<KEY,T,tlt>& greater) {
+  if(this==&greater || greater.map== nullptr)
+    return;
+  TN* last=map;
+  while(last!= nullptr && last->right!= nullptr)
+    last=last->right;
+  if(last!= nullptr && !lt(last->value.first, leftmost(greater.map)->value.first)){
+    std::ostringstream answer;
+    answer << "BSTMap::join: key(" << leftmost(greater.map)->value.first << ") not greater than all keys in Map";
+    throw KeyError(answer.str());
+  }
+  if(how!=BALANCED)
+    rebalance();
+  if(greater.how!=BALANCED)
+    greater.rebalance();
+  map=join2(map,greater.map);
+  map->parent= nullptr;
+  used+=greater.used;
+  finger=greater.finger= nullptr;
+  greater.map= nullptr;
+  greater.used=0;
+  ++greater.mod_count;
+  ++mod_count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::union_with(const BSTMap<KEY,T,tlt>& other) {
+  if(this==&other)
+    return;
+  if(lt!=other.lt){
+    put_all(other);
+    return;
+  }
+  if(other.how!=BALANCED){
+    BSTMap<KEY,T,tlt> balanced_other(other);
+    balanced_other.set_adjust(BALANCED);
+    union_with(balanced_other);
+    return;
+  }
+  if(how!=BALANCED)
+    rebalance();
+  map=union_of(map,other.map,parallel_depth());
+  if(map!= nullptr)
+    map->parent= nullptr;
+  used=size_of(map);
+  finger= nullptr;
+  ++mod_count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::intersect_with(const BSTMap<KEY,T,tlt>& other) {
+  if(this==&other)
+    return;
+  if(lt!=other.lt){
+    for(auto i=begin(); i!=end(); ++i)
+      if(!other.has_key(i->first))
+        i.erase();
+    return;
+  }
+  if(other.how!=BALANCED){
+    BSTMap<KEY,T,tlt> balanced_other(other);
+    balanced_other.set_adjust(BALANCED);
+    intersect_with(balanced_other);
+    return;
+  }
+  if(how!=BALANCED)
+    rebalance();
+  map=intersection_of(map,other.map,parallel_depth());
+  if(map!= nullptr)
+    map->parent= nullptr;
+  used=size_of(map);
+  finger= nullptr;
+  ++mod_count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::difference(const BSTMap<KEY,T,tlt>& other) {
+  if(this==&other){
+    clear();
+    return;
+  }
+  if(lt!=other.lt){
+    for(const Entry& e : other)
+      if(has_key(e.first))
+        erase(e.first);
+    return;
+  }
+  if(other.how!=BALANCED){
+    BSTMap<KEY,T,tlt> balanced_other(other);
+    balanced_other.set_adjust(BALANCED);
+    difference(balanced_other);
+    return;
+  }
+  if(how!=BALANCED)
+    rebalance();
+  map=difference_of(map,other.map,parallel_depth());
+  if(map!= nullptr)
+    map->parent= nullptr;
+  used=size_of(map);
+  finger= nullptr;
+  ++mod_count;
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 //Operators
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 T& BSTMap<KEY,T,tlt>::operator [] (const KEY& key) {
-  return find_addempty(map, key);
+  bool added;
+  TN* node=find_addempty(start(key),key,T(),added);
+  finger=accessed(node,!added);
+  return node->value.second;
 }
 
 
@@ -310,7 +676,7 @@ const T& BSTMap<KEY,T,tlt>::operator [] (const KEY& key) const {
     answer << "BSTMap::operator []: key(" << key << ") not in Map";
     throw KeyError(answer.str());
   }
-  return node->value.second;
+  return accessed(node,true)->value.second;
 }
 
 
@@ -319,9 +685,12 @@ BSTMap<KEY,T,tlt>& BSTMap<KEY,T,tlt>::operator = (const BSTMap<KEY,T,tlt>& rhs)
   if (this == &rhs)
     return *this;
   this->clear(); //deallocate the old one
+  how=rhs.how;
   if(lt==rhs.lt){
     used=rhs.used;
-    copy(rhs.map);
+    map=copy(rhs.map);
+    if(map!= nullptr)
+      map->parent= nullptr;
   }else{
     lt=rhs.lt;
     for(auto e : rhs)
@@ -354,10 +723,9 @@ std::ostream& operator << (std::ostream& outs, const BSTMap<KEY,T,tlt>& m) {
 
   outs << "map[";
   if(!m.empty()) {
-    outs << m.map->value.first << "->" << m.map->value.second;
     auto i = m.begin();
-    ++i;
-    for (; i != m.end(); ++i)
+    outs << (*i).first << "->" << (*i).second;
+    for (++i; i != m.end(); ++i)
       outs << "," << (*i).first << "->" << (*i).second; //outs<<e.first<<"->"<<e.second;
   }
   outs << "]";
@@ -371,12 +739,75 @@ std::ostream& operator << (std::ostream& outs, const BSTMap<KEY,T,tlt>& m) {
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 auto BSTMap<KEY,T,tlt>::begin () const -> BSTMap<KEY,T,tlt>::Iterator {
-  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),true);
+  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),leftmost(map));
 }
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 auto BSTMap<KEY,T,tlt>::end () const -> BSTMap<KEY,T,tlt>::Iterator {
-  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),false);
+  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),nullptr);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Order statistics
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::lower_bound (const KEY& key) const -> BSTMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),lower_node(key,false));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::upper_bound (const KEY& key) const -> BSTMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),lower_node(key,true));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BSTMap<KEY,T,tlt>::rank (const KEY& key) const {
+  int answer=0;
+  for(TN* temp=map; temp!= nullptr; )
+    if(lt(temp->value.first,key)){
+      answer+=size_of(temp->left)+1;
+      temp=temp->right;
+    }else
+      temp=temp->left;
+  return answer;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::select (int k) const -> BSTMap<KEY,T,tlt>::Iterator {
+  TN* temp=(k<0 || k>=used ? nullptr : map);
+  while(temp!= nullptr){
+    int left_size=size_of(temp->left);
+    if(k==left_size)
+      break;
+    else if(k<left_size)
+      temp=temp->left;
+    else{
+      k-=left_size+1;
+      temp=temp->right;
+    }
+  }
+  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),temp);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::range (const KEY& lo, const KEY& hi) const -> BSTMap<KEY,T,tlt>::Range {
+  if(!lt(lo,hi))
+    return Range(end(),end());
+  return Range(lower_bound(lo),lower_bound(hi));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BSTMap<KEY,T,tlt>::count_in_range (const KEY& lo, const KEY& hi) const {
+  if(!lt(lo,hi))
+    return 0;
+  return rank(hi)-rank(lo);
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -399,158 +830,723 @@ typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::find_key (TN* root, const KEY
 }
 
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::put_hint (const Iterator& hint, const KEY& key, const T& value) -> BSTMap<KEY,T,tlt>::Iterator {
+  if(hint.ref_map!=this)
+    throw IteratorPositionIllegal("BSTMap::put_hint: hint is not an Iterator for this Map");
+  if(hint.expected_mod_count!=mod_count)
+    throw ConcurrentModificationError("BSTMap::put_hint");
+  ++mod_count;
+  bool added;
+  TN* node=finger=accessed(find_addempty(near(hint.current,key),key,value,added),false);
+  if(!added)
+    node->value.second=value;
+  return Iterator(this,node);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::find_near (const Iterator& hint, const KEY& key) const -> BSTMap<KEY,T,tlt>::Iterator {
+  if(hint.ref_map!=this)
+    throw IteratorPositionIllegal("BSTMap::find_near: hint is not an Iterator for this Map");
+  if(hint.expected_mod_count!=mod_count)
+    throw ConcurrentModificationError("BSTMap::find_near");
+  return Iterator(const_cast<BSTMap<KEY,T,tlt>*>(this),find_key(near(hint.current,key),key));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BSTMap<KEY,T,tlt>::find (const KEY& key) -> BSTMap<KEY,T,tlt>::Iterator {
+  TN* node=find_key(start(key),key);
+  if(node!= nullptr)
+    finger=accessed(node,true);
+  return Iterator(this,node);
+}
+
+
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 bool BSTMap<KEY,T,tlt>::has_value (TN* root, const T& value) const {
-  if(root== nullptr)
-    return false;
-  else
-    if(value == root->value.second)
+  for(TN* temp=leftmost(root); temp!= nullptr; temp=successor(temp))
+    if(value == temp->value.second)
       return true;
-    else
-      return has_value(root->left,value) || has_value(root->right,value);
+  return false;
 }
 
 
+//Walk root's tree by its parent pointers, moving to (and copying) each child not yet copied,
+//  and back up once both are; to always follows the copy of from
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::copy (TN* root) const {
   if(root==nullptr)
     return nullptr;
+  TN* to_return=new TN(root->value);
+  try{
+    for(TN *from=root, *to=to_return; ; )
+      if(from->left!= nullptr && to->left== nullptr){
+        to->left=new TN(from->left->value);
+        to->left->parent=to;
+        from=from->left;
+        to=to->left;
+      }else if(from->right!= nullptr && to->right== nullptr){
+        to->right=new TN(from->right->value);
+        to->right->parent=to;
+        from=from->right;
+        to=to->right;
+      }else{
+        to->size=from->size;
+        if(from==root)
+          break;
+        from=from->parent;
+        to=to->parent;
+      }
+  }catch(...){
+    delete_BST(to_return);
+    throw;
+  }
+  return to_return;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BSTMap<KEY,T,tlt>::equals (TN* root, const BSTMap<KEY,T,tlt>& other) const {
+  if(lt==other.lt){                   //Same order (and, from ==, same size): walk both in step
+    for(TN *temp=leftmost(root), *o=leftmost(other.map); temp!= nullptr; temp=successor(temp), o=successor(o))
+      if(!(temp->value.first == o->value.first) || !(temp->value.second == o->value.second))
+        return false;
+    return true;
+  }
+  for(TN* temp=leftmost(root); temp!= nullptr; temp=successor(temp)){
+    TN* node=find_key(other.map,temp->value.first);
+    if(node== nullptr || !(node->value.second == temp->value.second))
+      return false;
+  }
+  return true;
+}
+
+
+//Nodes in reverse key order, each indented ".." per level below root
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string BSTMap<KEY,T,tlt>::string_rotated(TN* root, std::string indent) const {
+  std::stringstream ss;
+  int depth=0;
+  TN* temp=root;
+  for( ; temp!= nullptr && temp->right!= nullptr; ++depth)
+    temp=temp->right;
+  while(temp!= nullptr){
+    ss<<indent;
+    for(int i=0; i<depth; ++i)
+      ss<<"..";
+    ss<<temp->value.first<<"->"<<temp->value.second<<"\n";
+    if(temp->left!= nullptr){                                 //Predecessor: last node in left subtree
+      for(temp=temp->left, ++depth; temp->right!= nullptr; ++depth)
+        temp=temp->right;
+    }else{                                                    //...or the lowest ancestor it is right of
+      for( ; temp!=root && temp->parent->left==temp; --depth)
+        temp=temp->parent;
+      temp=(temp==root ? nullptr : temp->parent);
+      --depth;
+    }
+  }
+  return ss.str();
+}
+
+
+//Climb from from while key is outside the range of keys its subtree can hold: for key < from's key
+//  that range is bounded below by the nearest ancestor that from's subtree is to the right of
+//  (symmetrically for key > from's key), so only those ancestors need comparing with key.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::near (TN* from, const KEY& key) const {
+  if(from== nullptr || key == from->value.first)
+    return from== nullptr ? map : from;
+  bool less=lt(key,from->value.first);
+  TN* answer=from;
+  for(TN* parent=from->parent; parent!= nullptr; from=parent, parent=parent->parent)
+    if((parent->right==from) == less){
+      if(key == parent->value.first)
+        return parent;
+      if(lt(parent->value.first,key) == less)
+        break;
+      answer=parent;                     //key is beyond this bound too: keep climbing
+    }
+  return answer;
+}
+
+
+//A finger search for a random key climbs nearly to the root, and (as each search then depends on
+//  the last) the CPU can no longer overlap the cache misses of successive searches: random lookups
+//  ran about 50% slower. So after two far finger searches in a row, search from the root for the
+//  next FINGER_RETRY accesses before trying the finger again.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::start (const KEY& key) {
+  if(finger_credit<0){
+    ++finger_credit;
+    return map;
+  }
+  TN* answer=near(finger,key);
+  if(answer!= nullptr && answer->size<=used/8)
+    finger_credit=1;
   else
-    return new TN(root->value, copy(root->left), copy(root->right));
+    finger_credit=(finger_credit>0 ? 0 : -FINGER_RETRY);
+  return answer;
 }
 
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-void BSTMap<KEY,T,tlt>::copy_to_queue (TN* root, ArrayQueue<Entry>& q) const {
-  if(root== nullptr)
-    return;
-  else {
-    q.enqueue(root->value);
-    copy_to_queue(root->left, q);
-    copy_to_queue(root->right,q);
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::find_addempty (TN* start, const KEY& key, const T& value, bool& added) {
+  TN* parent= nullptr;
+  bool left=false;
+  for(TN* temp=start; temp!= nullptr; ){
+    if(key==temp->value.first){
+      added=false;
+      return temp;
+    }
+    parent=temp;
+    left=lt(key,temp->value.first);
+    temp=(left ? temp->left : temp->right);
   }
+  TN* node=new TN(Entry(key,value));
+  if(parent== nullptr)
+    map=node;
+  else if(left)
+    parent->left=node;
+  else
+    parent->right=node;
+  node->parent=parent;
+  fix_up(parent);
+  ++used;
+  added=true;
+  return node;
 }
 
 
+//Join each node on the path back to the root (just updating sizes, unless how is BALANCED):
+//  the same rebalancing as a recursive put/erase would do on its way back up
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-bool BSTMap<KEY,T,tlt>::equals (TN* root, const BSTMap<KEY,T,tlt>& other) const {
-    if(root== nullptr)
-      return true;
-    else{
-      TN* node=find_key(other.map,root->value.first);
-      if(node== nullptr)
-        return false;
-      return (node->value.second == root->value.second)
-             &&equals(root->left,other) && equals(root->right,other);
+void BSTMap<KEY,T,tlt>::fix_up (TN* node) {
+  while(node!= nullptr){
+    TN* parent=node->parent;
+    if(how==BALANCED)
+      replace_child(parent,node,join(node->left,node,node->right));
+    else
+      update(node);
+    node=parent;
+  }
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::replace_child (TN* parent, TN* old_child, TN* new_child) const {
+  if(parent== nullptr)
+    map=new_child;
+  else if(parent->left==old_child)
+    parent->left=new_child;
+  else
+    parent->right=new_child;
+  if(new_child!= nullptr)
+    new_child->parent=parent;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::delete_BST (TN*& root) {
+  TN* temp=root;
+  while(temp!= nullptr)
+    if(temp->left!= nullptr){            //Rotate the left child up, so eventually temp has none
+      TN* l=temp->left;
+      temp->left=l->right;
+      l->right=temp;
+      temp=l;
+    }else{
+      TN* r=temp->right;
+      delete_node(temp);
+      temp=r;
     }
+  root= nullptr;
 }
 
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-std::string BSTMap<KEY,T,tlt>::string_rotated(TN* root, std::string indent) const {
-  if(root== nullptr)
-    return "";
+void BSTMap<KEY,T,tlt>::rebalance () {
+  if(map== nullptr)
+    return;
+  TN** nodes=new TN*[used];
+  int n=0;
+  for(TN* temp=leftmost(map); temp!= nullptr; temp=successor(temp))
+    nodes[n++]=temp;
+  map=rebuild(nodes,0,n);
+  map->parent= nullptr;
+  delete [] nodes;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BSTMap<KEY,T,tlt>::size_of (TN* root) {
+  return root== nullptr ? 0 : root->size;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::update (TN* root) {
+  root->size=1+size_of(root->left)+size_of(root->right);
+  if(root->left!= nullptr)
+    root->left->parent=root;
+  if(root->right!= nullptr)
+    root->right->parent=root;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::leftmost (TN* root) {
+  if(root!= nullptr)
+    while(root->left!= nullptr)
+      root=root->left;
+  return root;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::successor (TN* node) {
+  if(node->right!= nullptr)
+    return leftmost(node->right);
+  while(node->parent!= nullptr && node->parent->right==node)
+    node=node->parent;
+  return node->parent;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::delete_node (TN* node) {
+  NB* nb=node->block;
+  if(nb== nullptr)
+    delete node;
   else{
-    std::string left=string_rotated(root->right, indent+"..");
-    std::stringstream ss;
-    ss<<indent<<root->value.first<<"->"<<root->value.second<<"\n";
-    std::string result=ss.str();
-    std::string right=string_rotated(root->left, indent+"..");
-    result=left+result+right;
-    return result;
+    node->~TN();
+    if(--nb->live==0){
+      ::operator delete(nb->nodes);
+      delete nb;
+    }
   }
 }
 
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-T BSTMap<KEY,T,tlt>::insert (TN*& root, const KEY& key, const T& value) {
-  if (root == nullptr) {
-    this->used++;
-    root = new TN(BSTMap::Entry(key, value));
-    return value;
-  } else {
-    if (key == root->value.first) {
-      T to_return = root->value.second;
-      root->value.second = value;
-      return to_return;
-    } else if (lt(key, root->value.first))
-      return insert(root->left, key, value);
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::build_balanced (Entry* sorted, int n) const {
+  NB* nb=new NB(n);
+  int next=0;
+  TN* root=build_balanced(sorted,0,n,nb,next);
+  root->parent= nullptr;
+  return root;
+}
+
+
+//Nodes are placed in nb in preorder (parents before their subtrees), so each root-to-leaf
+//  search moves forward through one allocation.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::build_balanced (Entry* sorted, int low, int high, NB* nb, int& next) const {
+  if(low>=high)
+    return nullptr;
+  int mid=low+(high-low)/2;
+  TN* root=new (nb->nodes+next++) TN(sorted[mid]);
+  root->block=nb;
+  root->left =build_balanced(sorted,low,mid,nb,next);
+  root->right=build_balanced(sorted,mid+1,high,nb,next);
+  update(root);
+  return root;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BSTMap<KEY,T,tlt>::flatten (Entry* into) const {
+  int n=0;
+  for(TN* temp=leftmost(map); temp!= nullptr; temp=successor(temp))
+    into[n++]=temp->value;
+  return n;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BSTMap<KEY,T,tlt>::compact_sorted (Entry* run, int n) const {
+  if(n==0)
+    return 0;
+  int last=0;
+  for(int i=1; i<n; ++i)
+    if(run[i].first==run[last].first)
+      run[last].second=run[i].second;
+    else if(lt(run[last].first,run[i].first))
+      run[++last]=run[i];
     else
-      return insert(root->right, key, value);
+      return -1;
+  return last+1;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::merge_sorted (Entry* run, int n) {
+  //A short run costs n*log(used) with put; a long one used+n with a merge and rebuild
+  int log_used=0;
+  for(int u=used; u>0; u/=2)
+    ++log_used;
+  if((long long)n*log_used<used){
+    for(int i=0; i<n; ++i)
+      put(run[i].first,run[i].second);
+    return;
   }
+
+  Entry* mine=new Entry[used];
+  int m=flatten(mine);
+  Entry* all=new Entry[m+n];
+  int a=0, i=0, j=0;
+  while(i<m && j<n)
+    if(lt(mine[i].first,run[j].first))
+      all[a++]=mine[i++];
+    else if(lt(run[j].first,mine[i].first))
+      all[a++]=run[j++];
+    else{
+      all[a++]=run[j++];            //run's value replaces this map's (as put would)
+      ++i;
+    }
+  while(i<m)
+    all[a++]=mine[i++];
+  while(j<n)
+    all[a++]=run[j++];
+  delete [] mine;
+
+  delete_BST(map);
+  finger= nullptr;
+  map=(a==0 ? nullptr : build_balanced(all,a));
+  used=a;
+  ++mod_count;
+  delete [] all;
 }
 
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int BSTMap<KEY,T,tlt>::to_array (const Iterable& i, Entry*& into) const {
+  int length=16, n=0;
+  into=new Entry[length];
+  for(const Entry& ele:i){
+    if(n==length){
+      Entry* bigger=new Entry[2*length];
+      for(int j=0; j<n; ++j)
+        bigger[j]=into[j];
+      delete [] into;
+      into=bigger;
+      length*=2;
+    }
+    into[n++]=ele;
+  }
+  return n;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::lower_node (const KEY& key, bool strict) const {
+  TN* answer= nullptr;
+  for(TN* temp=map; temp!= nullptr; )
+    if(strict ? lt(key,temp->value.first) : !lt(temp->value.first,key)){
+      answer=temp;
+      temp=temp->left;
+    }else
+      temp=temp->right;
+  return answer;
+}
+
+
+
+
 
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-T& ics::BSTMap<KEY,T,tlt>::find_addempty (TN*& root, const KEY& key) {
-  if(root== nullptr){
-    root=new TN(BSTMap::Entry(key,T()));
-    used++;
-    return root->value.second;
+void BSTMap<KEY,T,tlt>::rotate_up (TN* node) const {
+  TN* parent=node->parent;
+  TN* grandparent=parent->parent;
+  if(parent->left==node){
+    parent->left=node->right;
+    node->right=parent;
   }else{
-    if (lt(key,root->value.first))
-      return find_addempty(root->left, key);
-    else if (lt(root->value.first,key))
-      return find_addempty(root->right, key);
-    else
-      return root->value.second;
+    parent->right=node->left;
+    node->left=parent;
+  }
+  update(parent);
+  update(node);
+  replace_child(grandparent,parent,node);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::splay (TN* node) const {
+  while(node->parent!= nullptr){
+    TN* parent=node->parent;
+    TN* grandparent=parent->parent;
+    if(grandparent== nullptr)                                          //zig
+      rotate_up(node);
+    else if((grandparent->left==parent) == (parent->left==node)){      //zig-zig
+      rotate_up(parent);
+      rotate_up(node);
+    }else{                                                             //zig-zag
+      rotate_up(node);
+      rotate_up(node);
+    }
   }
+}
+
+
+//Sleator and Tarjan's semi-splaying: a zig-zig rotates only the parent and continues from it
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BSTMap<KEY,T,tlt>::semi_splay (TN* node) const {
+  while(node->parent!= nullptr && node->parent->parent!= nullptr){
+    TN* parent=node->parent;
+    TN* grandparent=parent->parent;
+    if((grandparent->left==parent) == (parent->left==node)){
+      rotate_up(parent);
+      node=parent;
+    }else{
+      rotate_up(node);
+      rotate_up(node);
+    }
+  }
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::accessed (TN* node, bool read) const {
+  if(how==SPLAY || (how==SEMI_SPLAY && !read))
+    splay(node);
+  else if(how==SEMI_SPLAY)
+    semi_splay(node);
+  return node;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::rebuild (TN** nodes, int low, int high) {
+  if(low>=high)
+    return nullptr;
+  int mid=low+(high-low)/2;
+  return link(nodes[mid],rebuild(nodes,low,mid),rebuild(nodes,mid+1,high));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BSTMap<KEY,T,tlt>::balanced (int weight1, int weight2) {
+  long long total=(long long)weight1+weight2;
+  return ALPHA_PERCENT*total<=100LL*weight1 && ALPHA_PERCENT*total<=100LL*weight2;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::link (TN* m, TN* l, TN* r) {
+  m->left=l;
+  m->right=r;
+  update(m);
+  return m;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::rotate_left (TN* root) {
+  TN* r=root->right;
+  return link(r, link(root,root->left,r->left), r->right);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::rotate_right (TN* root) {
+  TN* l=root->left;
+  return link(l, l->left, link(root,l->right,root->right));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::join (TN* l, TN* m, TN* r) {
+  int wl=size_of(l)+1, wr=size_of(r)+1;
+  if(balanced(wl,wr))
+    return link(m,l,r);
+  return wl>wr ? join_right(l,m,r) : join_left(l,m,r);
+}
+
+
+//Walk down l's right spine to a subtree that balances with r, put m there, and rotate
+//  (singly or doubly) on the way back up wherever the new subtree is too heavy
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::join_right (TN* l, TN* m, TN* r) {
+  if(size_of(l)<=size_of(r) || balanced(size_of(l)+1,size_of(r)+1))
+    return link(m,l,r);
+  TN* t=join_right(l->right,m,r);
+  int wll=size_of(l->left)+1;
+  if(balanced(wll,t->size+1))
+    return link(l,l->left,t);
+  if(t->left== nullptr || (balanced(wll,size_of(t->left)+1) && balanced(wll+size_of(t->left)+1,size_of(t->right)+1)))
+    return rotate_left(link(l,l->left,t));
+  return rotate_left(link(l,l->left,rotate_right(t)));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::join_left (TN* l, TN* m, TN* r) {
+  if(size_of(r)<=size_of(l) || balanced(size_of(l)+1,size_of(r)+1))
+    return link(m,l,r);
+  TN* t=join_left(l,m,r->left);
+  int wrr=size_of(r->right)+1;
+  if(balanced(t->size+1,wrr))
+    return link(r,t,r->right);
+  if(t->right== nullptr || (balanced(size_of(t->right)+1,wrr) && balanced(size_of(t->left)+1,size_of(t->right)+1+wrr)))
+    return rotate_right(link(r,t,r->right));
+  return rotate_right(link(r,rotate_left(t),r->right));
+}
+
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::join2 (TN* l, TN* r) {
+  if(l== nullptr)
+    return r;
+  TN* rest;
+  TN* last=split_last(l,rest);
+  return join(rest,last,r);
+}
+
+
+//Walk down root's right spine, then back up it by parent pointers (saving each parent before
+//  join relinks the node), joining each node with the rest as a recursive version would
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::split_last (TN* root, TN*& rest) {
+  TN* last=root;
+  while(last->right!= nullptr)
+    last=last->right;
+  rest=last->left;
+  for(TN* node=(last==root ? nullptr : last->parent); node!= nullptr; ){
+    TN* up=(node==root ? nullptr : node->parent);
+    rest=join(node->left,node,rest);
+    node=up;
+  }
+  return last;
 }
 
 
+//The standard BST deletion (iterative, as an UNBALANCED/SPLAY tree may be very deep)
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-pair<KEY,T> BSTMap<KEY,T,tlt>::remove_closest(TN*& root) {
-  if (root->right != nullptr)
-    return remove_closest(root->right);
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::splice (TN* l, TN* r) {
+  if(l== nullptr)
+    return r;
+  TN* last=l;
+  while(last->right!= nullptr)
+    last=last->right;
+  if(last==l)
+    l=l->left;
   else{
-    Entry to_return = root->value;
-    TN* to_delete = root;
-    root = root->left;
-    delete to_delete;
-    return to_return;
+    TN* parent=last->parent;
+    parent->right=last->left;
+    for(TN* temp=parent; ; temp=temp->parent){
+      update(temp);
+      if(temp==l)
+        break;
+    }
   }
+  return link(last,l,r);
+}
+
 
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BSTMap<KEY,T,tlt>::parallel_depth () {
+  int depth=0;
+  for(unsigned cores=std::thread::hardware_concurrency(); cores>1; cores/=2)
+    ++depth;
+  return depth;
 }
 
 
+//Search down for key, then walk back up the search path by parent pointers (as in split_last),
+//  joining each node on it into greater (if key went left of it) or less
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-T BSTMap<KEY,T,tlt>::remove (TN*& root, const KEY& key) {
-  if (root == nullptr) {
-    std::ostringstream answer;
-    answer << "BSTMap::erase: key(" << key << ") not in Map";
-    throw KeyError(answer.str());
-  }else
-    if (key == root->value.first) {
-      T to_return = root->value.second;
-      if (root->left == nullptr) {
-        TN* to_delete = root;
-        root = root->right;
-        delete to_delete;
-      }else if (root->right == nullptr) {
-        TN* to_delete = root;
-        root = root->left;
-        delete to_delete;
-      }else
-        root->value = remove_closest(root->left);
-      return to_return;
-    }else
-      return remove( (lt(key,root->value.first) ? root->left : root->right), key);
+void BSTMap<KEY,T,tlt>::split (TN* root, const KEY& key, TN*& less, TN*& found, TN*& greater) const {
+  less=found=greater= nullptr;
+  TN* last= nullptr;                                   //Lowest node on the path other than key's
+  for(TN* temp=root; temp!= nullptr; ){
+    if(key==temp->value.first){
+      less=temp->left;
+      found=temp;
+      greater=temp->right;
+      break;
+    }
+    last=temp;
+    temp=(lt(key,temp->value.first) ? temp->left : temp->right);
+  }
+  for(TN* node=last; node!= nullptr; ){
+    TN* up=(node==root ? nullptr : node->parent);
+    if(lt(key,node->value.first))
+      greater=join(greater,node,node->right);
+    else
+      less=join(node->left,node,less);
+    node=up;
+  }
 }
 
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-void BSTMap<KEY,T,tlt>::delete_BST (TN*& root) {
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::union_of (TN* root, TN* other, int depth) const {
+  if(other== nullptr)
+    return root;
   if(root== nullptr)
-    return;
-  else{
-    delete_BST(root->left);
-    delete_BST(root->right);
-    delete root;
+    return copy(other);
+  bool parallel=depth>0 && root->size+other->size>PARALLEL_CUTOFF;  //Before split relinks root
+  TN *less, *found, *greater, *l, *r;
+  split(root,other->value.first,less,found,greater);
+  if(parallel){
+    std::future<TN*> left=std::async(std::launch::async,[=](){return union_of(less,other->left,depth-1);});
+    r=union_of(greater,other->right,depth-1);
+    l=left.get();
+  }else{
+    l=union_of(less,other->left,depth);
+    r=union_of(greater,other->right,depth);
   }
-  root= nullptr;
+  if(found== nullptr)
+    found=new TN(other->value);
+  else
+    found->value.second=other->value.second;
+  return join(l,found,r);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::intersection_of (TN* root, TN* other, int depth) const {
+  if(root== nullptr || other== nullptr){
+    delete_BST(root);
+    return nullptr;
+  }
+  bool parallel=depth>0 && root->size+other->size>PARALLEL_CUTOFF;  //Before split relinks root
+  TN *less, *found, *greater, *l, *r;
+  split(root,other->value.first,less,found,greater);
+  if(parallel){
+    std::future<TN*> left=std::async(std::launch::async,[=](){return intersection_of(less,other->left,depth-1);});
+    r=intersection_of(greater,other->right,depth-1);
+    l=left.get();
+  }else{
+    l=intersection_of(less,other->left,depth);
+    r=intersection_of(greater,other->right,depth);
+  }
+  return found== nullptr ? join2(l,r) : join(l,found,r);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BSTMap<KEY,T,tlt>::TN* BSTMap<KEY,T,tlt>::difference_of (TN* root, TN* other, int depth) const {
+  if(root== nullptr || other== nullptr)
+    return root;
+  bool parallel=depth>0 && root->size+other->size>PARALLEL_CUTOFF;  //Before split relinks root
+  TN *less, *found, *greater, *l, *r;
+  split(root,other->value.first,less,found,greater);
+  if(parallel){
+    std::future<TN*> left=std::async(std::launch::async,[=](){return difference_of(less,other->left,depth-1);});
+    r=difference_of(greater,other->right,depth-1);
+    l=left.get();
+  }else{
+    l=difference_of(less,other->left,depth);
+    r=difference_of(greater,other->right,depth);
+  }
+  if(found!= nullptr)
+    delete_node(found);
+  return join2(l,r);
 }
 
 
@@ -563,13 +1559,8 @@ void BSTMap<KEY,T,tlt>::delete_BST (TN*& root) {
 //Iterator class definitions
 
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
-BSTMap<KEY,T,tlt>::Iterator::Iterator(BSTMap<KEY,T,tlt>* iterate_over, bool from_begin)
-: ref_map(iterate_over),expected_mod_count(ref_map->mod_count){
-  //copy the map into the queue
-  if(from_begin)
-    iterate_over->copy_to_queue(iterate_over->map,it);
-  else
-    it=ArrayQueue<Entry>();
+BSTMap<KEY,T,tlt>::Iterator::Iterator(BSTMap<KEY,T,tlt>* iterate_over, TN* initial)
+: current(initial), ref_map(iterate_over),expected_mod_count(ref_map->mod_count){
 }
 
 
@@ -584,11 +1575,15 @@ auto BSTMap<KEY,T,tlt>::Iterator::erase() -> Entry {
     throw ConcurrentModificationError("BSTMap::Iterator::erase");
   if (!can_erase)
     throw CannotEraseError("BSTMap::Iterator::erase Iterator cursor already erased");
-  if(it.empty())
+  if(current== nullptr)
     throw CannotEraseError("BSTMap::Iterator::erase Iterator cursor beyond data structure");
   can_erase=false;
-  auto to_erase=it.dequeue();
+  Entry to_erase=current->value;
+  //erase deletes only current's node (the others keep their associations, even if they are
+  //  moved): so current's successor is still the next node afterwards
+  TN* next=successor(current);
   ref_map->erase(to_erase.first);
+  current=next;
   expected_mod_count=ref_map->mod_count;
   return to_erase;
 }
@@ -597,7 +1592,12 @@ auto BSTMap<KEY,T,tlt>::Iterator::erase() -> Entry {
 template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 std::string BSTMap<KEY,T,tlt>::Iterator::str() const {
   std::ostringstream answer;
-  answer << ref_map->str() << "/it=" << it << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  answer << ref_map->str() << "/current=";
+  if(current== nullptr)
+    answer << "end";
+  else
+    answer << current->value.first << "->" << current->value.second;
+  answer << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
   return answer.str();
 }
 
@@ -606,10 +1606,10 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 auto  BSTMap<KEY,T,tlt>::Iterator::operator ++ () -> BSTMap<KEY,T,tlt>::Iterator& {
   if (expected_mod_count != ref_map->mod_count)
     throw ConcurrentModificationError("BSTMap::Iterator::operator ++");
-  if(it.empty())
+  if(current== nullptr)
     return *this;
   if(can_erase)
-    it.dequeue();
+    current=successor(current);
   else
     can_erase=true;
   return *this;
@@ -620,11 +1620,11 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 auto BSTMap<KEY,T,tlt>::Iterator::operator ++ (int) -> BSTMap<KEY,T,tlt>::Iterator {
   if (expected_mod_count != ref_map->mod_count)
     throw ConcurrentModificationError("BSTMap::Iterator::operator ++");
-  if(it.empty())
+  if(current== nullptr)
     return *this;
   Iterator to_return(*this);
   if(can_erase)
-    it.dequeue();
+    current=successor(current);
   else
     can_erase=true;
   return to_return;
@@ -640,7 +1640,7 @@ bool BSTMap<KEY,T,tlt>::Iterator::operator == (const BSTMap<KEY,T,tlt>::Iterator
     throw ConcurrentModificationError("BSTMap::Iterator::operator ==");
   if (ref_map != rhsASI->ref_map)
     throw ComparingDifferentIteratorsError("BSTMap::Iterator::operator ==");
-  return it.size()==rhs.it.size();
+  return current==rhsASI->current;
 }
 
 
@@ -653,7 +1653,7 @@ bool BSTMap<KEY,T,tlt>::Iterator::operator != (const BSTMap<KEY,T,tlt>::Iterator
     throw ConcurrentModificationError("BSTMap::Iterator::operator ==");
   if (ref_map != rhsASI->ref_map)
     throw ComparingDifferentIteratorsError("BSTMap::Iterator::operator ==");
-  return it.size()!=rhs.it.size();
+  return current!=rhsASI->current;
 }
 
 
@@ -661,12 +1661,12 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 pair<KEY,T>& BSTMap<KEY,T,tlt>::Iterator::operator *() const {
   if (expected_mod_count !=  ref_map->mod_count)
     throw ConcurrentModificationError("BSTMap::Iterator::operator ->");
-  if (!can_erase || it.empty()) {
+  if (!can_erase || current== nullptr) {
     std::ostringstream where;
-    where << it << " when size = " << ref_map->size();
+    where << (current== nullptr ? "end" : "erased") << " when size = " << ref_map->size();
     throw IteratorPositionIllegal("BSTMap::Iterator::operator -> Iterator illegal: "+where.str());
   }
-  return it.peek();
+  return current->value;
 }
 
 
@@ -674,12 +1674,12 @@ template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
 pair<KEY,T>* BSTMap<KEY,T,tlt>::Iterator::operator ->() const {
   if (expected_mod_count !=  ref_map->mod_count)
     throw ConcurrentModificationError("BSTMap::Iterator::operator ->");
-  if (!can_erase || it.empty()) {
+  if (!can_erase || current== nullptr) {
     std::ostringstream where;
-    where << it << " when size = " << ref_map->size();
+    where << (current== nullptr ? "end" : "erased") << " when size = " << ref_map->size();
     throw IteratorPositionIllegal("BSTMap::Iterator::operator -> Iterator illegal: "+where.str());
   }
-  return &it.peek();
+  return &current->value;
 }
 
 
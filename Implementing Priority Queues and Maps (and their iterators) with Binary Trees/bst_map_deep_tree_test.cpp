@@ -0,0 +1,84 @@
+#include <string>
+#include <iostream>
+#include <cstdlib>            //For std::atoi
+#include "bst_map.hpp"
+
+
+//Checks that a BSTMap whose tree is a path (here, N keys put in increasing order in SPLAY and
+//  SEMI_SPLAY modes, each put splaying the new largest key to the root) can be copied, compared,
+//  searched by value, split/joined, used in set operations, printed, and destroyed: each of these
+//  once recursed once per level, overflowing the stack for N in the hundreds of thousands.
+//Prints one line per mode and returns non-0 if any check fails.
+
+bool int_lt(const int& a, const int& b) {return a < b;}
+
+typedef ics::BSTMap<int,int,int_lt> Map;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what, const std::string& mode) {
+  if (!ok) {
+    std::cout << "FAILED: " << mode << " " << what << std::endl;
+    ++failures;
+  }
+}
+
+
+void run(Map::Adjust how, const std::string& mode, int n) {
+  {
+    Map m;
+    m.set_adjust(how);
+    for (int i=0; i<n; ++i)
+      m.put(i,i);
+  }                                                  //Destroy a deep tree
+
+  Map m;
+  m.set_adjust(how);
+  for (int i=0; i<n; ++i)
+    m.put(i,i);
+  Map copied(m);
+  check(copied.size() == n, "copy size", mode);
+  check(copied == m && !(copied != m), "copy ==", mode);
+  check(m.has_value(0) && !m.has_value(-1), "has_value", mode);
+  Map assigned;
+  assigned = m;
+  check(assigned == m, "operator =", mode);
+
+  Map upper;
+  copied.split(n/2,upper);
+  check(copied.size() == n/2 && upper.size() == n-n/2, "split", mode);
+  copied.join(upper);
+  check(copied == m && upper.empty(), "join", mode);
+
+  Map odds;
+  odds.set_adjust(how);
+  for (int i=1; i<n; i+=2)
+    odds.put(i,-i);
+  Map united(m);
+  united.union_with(odds);
+  check(united.size() == n && united[1] == -1 && united[0] == 0, "union_with", mode);
+  Map intersected(m);
+  intersected.intersect_with(odds);
+  check(intersected.size() == n/2 && !intersected.has_key(0), "intersect_with", mode);
+  Map differenced(m);
+  differenced.difference(odds);
+  check(differenced.size() == n-n/2 && !differenced.has_key(1), "difference", mode);
+
+  Map small;
+  small.set_adjust(how);
+  for (int i=0; i<1000; ++i)
+    small.put(i,i);
+  check(small.str().size() > 0, "str", mode);
+
+  std::cout << mode << ": " << n << " ascending puts copied, compared, split/joined, and destroyed" << std::endl;
+}
+
+
+//The optional argument is N (default 1,000,000)
+int main(int argc, char* argv[]) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  run(Map::SPLAY,     "SPLAY",      n);
+  run(Map::SEMI_SPLAY,"SEMI_SPLAY", n);
+  std::cout << (failures == 0 ? "All checks passed" : "Some checks FAILED") << std::endl;
+  return failures == 0 ? 0 : 1;
+}
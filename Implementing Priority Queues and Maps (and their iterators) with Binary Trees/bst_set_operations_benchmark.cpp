@@ -0,0 +1,69 @@
+#include <string>
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstdlib>            //For std::atoi
+#include "bst_map.hpp"
+
+
+//Times of BSTMap's split/join set operations on two maps of N random int keys each:
+//  union_with, the loop of put over the other map that union_with replaces, and intersect_with.
+//Each operation runs on a fresh copy of the first map. Above 64K associations the set operations
+//  fork their recursive halves onto std::async, so on a machine with several cores union_with and
+//  intersect_with gain a parallel speedup that the put loop cannot.
+
+bool int_lt(const int& a, const int& b) {return a < b;}
+
+typedef ics::BSTMap<int,int,int_lt> Map;
+
+
+double seconds_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+void run(int n) {
+  std::mt19937 random(1);
+  Map a, b;
+  for (int i=0; i<n; ++i) {
+    a.put(random(),i);
+    b.put(random(),i);
+  }
+
+  Map united(a);
+  auto start = std::chrono::steady_clock::now();
+  united.union_with(b);
+  double union_seconds = seconds_since(start);
+
+  Map put_into(a);
+  start = std::chrono::steady_clock::now();
+  for (auto& kv : b)
+    put_into.put(kv.first,kv.second);
+  double put_seconds = seconds_since(start);
+
+  Map intersected(a);
+  start = std::chrono::steady_clock::now();
+  intersected.intersect_with(b);
+  double intersect_seconds = seconds_since(start);
+
+  std::cout << "N=" << n << "  union_with " << union_seconds << "s  put loop " << put_seconds
+            << "s  intersect_with " << intersect_seconds << "s  (" << united.size() << " "
+            << intersected.size() << ")" << std::endl;
+}
+
+
+//The optional argument is N (default: 1,000,000 and then 10,000,000)
+int main(int argc, char* argv[]) {
+  if (argc > 1)
+    run(std::atoi(argv[1]));
+  else
+    for (int n : {1000000, 10000000})
+      run(n);
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2): with one core std::async only time-shares, so these are
+//  sequential times and show no parallel speedup.
+//N=1000000   union_with 0.31s  put loop 0.88s  intersect_with 0.30s
+//N=10000000  union_with 6.18s  put loop 8.32s  intersect_with 3.55s
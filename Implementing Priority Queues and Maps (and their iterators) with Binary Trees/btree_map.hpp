@@ -0,0 +1,917 @@
+#ifndef BTREE_MAP_HPP_
+#define BTREE_MAP_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include "ics_exceptions.hpp"
+#include "pair.hpp"
+
+
+namespace ics {
+
+
+#ifndef undefinedltdefined
+#define undefinedltdefined
+template<class T>
+bool undefinedlt (const T& a, const T& b) {return false;}
+#endif /* undefinedltdefined */
+
+//A B+tree: all associations are stored in leaves (linked in key order, for iteration); the inner
+//  nodes store only keys (contiguously, so each is searched by a linear scan) to route searches.
+//Nodes are sized to a few cache lines, so a search costs about log(N)/log(NODE_BYTES/sizeof(KEY))
+//  cache misses, instead of BSTMap's log2(N). It has the same interface as BSTMap (minus the order
+//  statistics), so a program can switch between them with a typedef.
+//
+//Instantiate the templated class supplying tlt(a,b): true, iff a is less than b.
+//If tlt is defaulted to undefinedlt in the template, then a constructor must supply clt.
+//If both tlt and clt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedlt value supplied by tlt/clt is stored in the instance variable lt.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedlt<KEY>> class BTreeMap {
+  public:
+    typedef pair<KEY,T> Entry;
+    typedef bool (*ltfunc) (const KEY& a, const KEY& b);
+
+    //Destructor/Constructors
+    ~BTreeMap();
+
+    BTreeMap          (bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    BTreeMap          (const BTreeMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    explicit BTreeMap (const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit BTreeMap (const Iterable& i, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    bool has_key    (const KEY& key) const;
+    bool has_value  (const T& value) const;
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    T    put   (const KEY& key, const T& value);
+    T    erase (const KEY& key);
+    void clear ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int put_all(const Iterable& i);
+
+
+    //Operators
+
+    T&       operator [] (const KEY&);
+    const T& operator [] (const KEY&) const;
+    BTreeMap<KEY,T,tlt>& operator = (const BTreeMap<KEY,T,tlt>& rhs);
+    bool operator == (const BTreeMap<KEY,T,tlt>& rhs) const;
+    bool operator != (const BTreeMap<KEY,T,tlt>& rhs) const;
+
+    template<class KEY2,class T2, bool (*lt2)(const KEY2& a, const KEY2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const BTreeMap<KEY2,T2,lt2>& m);
+
+
+
+  private:
+    class LN;
+
+  public:
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of BTreeMap<T>
+        ~Iterator();
+        Entry       erase();
+        std::string str  () const;
+        BTreeMap<KEY,T,tlt>::Iterator& operator ++ ();
+        BTreeMap<KEY,T,tlt>::Iterator  operator ++ (int);
+        bool operator == (const BTreeMap<KEY,T,tlt>::Iterator& rhs) const;
+        bool operator != (const BTreeMap<KEY,T,tlt>::Iterator& rhs) const;
+        Entry& operator *  () const;
+        Entry* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const BTreeMap<KEY,T,tlt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+        friend Iterator BTreeMap<KEY,T,tlt>::begin () const;
+        friend Iterator BTreeMap<KEY,T,tlt>::end   () const;
+
+      private:
+        //If can_erase is false, (leaf,index) is already the "next" association (++ does nothing)
+        LN*                  leaf;              //nullptr when beyond the last association
+        int                  index;
+        BTreeMap<KEY,T,tlt>* ref_map;
+        int                  expected_mod_count;
+        bool                 can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(BTreeMap<KEY,T,tlt>* iterate_over, LN* initial);
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    //Capacities sized so that a node's keys (or a leaf's associations) fill about NODE_BYTES
+    static const int NODE_BYTES = 256;
+    static const int INNER_CAP  = NODE_BYTES/(sizeof(KEY)+sizeof(void*)) < 4 ? 4 : NODE_BYTES/(sizeof(KEY)+sizeof(void*));
+    static const int LEAF_CAP   = NODE_BYTES/sizeof(Entry)               < 4 ? 4 : NODE_BYTES/sizeof(Entry);
+
+    class BN {                          //Base of inner nodes and leaves: count keys/associations
+      public:
+        BN (bool l) : count(0), is_leaf(l){}
+        int  count;
+        bool is_leaf;
+    };
+
+    class IN : public BN {              //children[i] stores keys < keys[i]; children[count] the rest
+      public:
+        IN () : BN(false){}
+        KEY keys[INNER_CAP];
+        BN* children[INNER_CAP+1];
+    };
+
+    class LN : public BN {
+      public:
+        LN () : BN(true), next(nullptr), prev(nullptr){}
+        Entry values[LEAF_CAP];
+        LN*   next;                     //Leaves are linked in key order
+        LN*   prev;
+    };
+
+  bool (*lt) (const KEY& a, const KEY& b); // The lt used for searching (from template or constructor)
+  BN* map       = nullptr;
+  LN* first     = nullptr;                 //Leftmost leaf: where iteration starts
+  int used      = 0;                       //Cache the number of key->value pairs in the tree
+  int mod_count = 0;                       //For sensing concurrent modification
+
+  //Helper methods (searches written iteratively, the rest recursively)
+  int   child_index  (IN* node, const KEY& key)            const; //Index of node's child whose keys bracket key
+  int   leaf_index   (LN* leaf, const KEY& key)            const; //Index of the first key not less than key
+  LN*   find_leaf    (const KEY& key)                      const; //Leaf where key is (or would be put)
+  T*    find_value   (const KEY& key)                      const; //nullptr if key absent
+  BN*   copy         (BN* root, LN*& last)                 const; //Copy root's tree, linking its leaves after last
+  void  delete_tree  (BN* root);
+  std::string string_rotated(BN* root, std::string indent) const;
+
+  //Puts key->value into root's tree if key is absent, returning whether it was added; either way,
+  //  value_in refers to key's value. If root was split, up_node is its new right sibling and up_key
+  //  the smallest key in up_node's tree (to put in root's parent).
+  bool  insert       (BN* root, const KEY& key, const T& value, T*& value_in, KEY& up_key, BN*& up_node);
+  T&    find_addempty(const KEY& key, const T& value, bool& added);             //Return reference to key's value (adding key->value first, if key absent)
+  T     remove       (BN* root, const KEY& key);
+  void  fix_child    (IN* node, int i);                            //Fix node->children[i] after it loses a key/association
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//BTreeMap class and related definitions
+
+//Destructor/Constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>::~BTreeMap() {
+  delete_tree(map);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>::BTreeMap(bool (*clt)(const KEY& a, const KEY& b))
+:lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("BTreeMap::default constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("BTreeMap::default constructor: both specified and different");
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>::BTreeMap(const BTreeMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt), mod_count(to_copy.mod_count){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    lt=to_copy.lt;
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("BTreeMap::copy constructor: both specified and different");
+  //copy the tree
+  if(lt==to_copy.lt) {
+    used=to_copy.used;
+    LN* last= nullptr;
+    map=copy(to_copy.map,last);
+  }
+  else
+    for(auto e : to_copy)
+      put(e.first,e.second);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>::BTreeMap(const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("BTreeMap::initializer_list constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("BTreeMap::initializer_list constructor: both specified and different");
+
+  for(const BTreeMap::Entry& i:il)
+    put(i.first,i.second);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template <class Iterable>
+BTreeMap<KEY,T,tlt>::BTreeMap(const Iterable& i, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("BTreeMap::Iterable constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("BTreeMap::Iterable constructor: both specified and different");
+  for(const BTreeMap::Entry& e:i)
+    put(e.first,e.second);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::empty() const {
+  return used==0;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BTreeMap<KEY,T,tlt>::size() const {
+  return used;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::has_key (const KEY& key) const {
+  return find_value(key)!= nullptr;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::has_value (const T& value) const {
+  for(LN* leaf=first; leaf!= nullptr; leaf=leaf->next)
+    for(int i=0; i<leaf->count; ++i)
+      if(leaf->values[i].second==value)
+        return true;
+  return false;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string BTreeMap<KEY,T,tlt>::str() const {
+  std::ostringstream answer;
+  answer<<"btree_map[\n"<<string_rotated(map,"")<<"](used="<<used<<",mod_count="<<mod_count<<")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T BTreeMap<KEY,T,tlt>::put(const KEY& key, const T& value) {
+  ++mod_count;
+  bool added;
+  T& value_in=find_addempty(key,value,added);
+  if(added)
+    return value;
+  T to_return=value_in;
+  value_in=value;
+  return to_return;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T BTreeMap<KEY,T,tlt>::erase(const KEY& key) {
+  if(map== nullptr) {
+    std::ostringstream answer;
+    answer << "BTreeMap::erase: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  T removed=remove(map,key);
+  //Shrink the tree when its root is empty
+  if(map->count==0 && map->is_leaf){
+    delete static_cast<LN*>(map);
+    map= nullptr;
+    first= nullptr;
+  }else if(map->count==0){
+    IN* old_root=static_cast<IN*>(map);
+    map=old_root->children[0];
+    delete old_root;
+  }
+  --used;
+  ++mod_count;
+  return removed;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BTreeMap<KEY,T,tlt>::clear() {
+  delete_tree(map);
+  map= nullptr;
+  first= nullptr;
+  mod_count++;
+  used=0;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int BTreeMap<KEY,T,tlt>::put_all(const Iterable& i) {
+  int count=0;
+  for(auto ele:i) {
+    put(ele.first, ele.second);
+    count++;
+  }
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T& BTreeMap<KEY,T,tlt>::operator [] (const KEY& key) {
+  bool added;
+  T& value=find_addempty(key,T(),added);
+  if(added)
+    ++mod_count;
+  return value;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+const T& BTreeMap<KEY,T,tlt>::operator [] (const KEY& key) const {
+  T* value=find_value(key);
+  if(value== nullptr) {
+    std::ostringstream answer;
+    answer << "BTreeMap::operator []: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  return *value;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>& BTreeMap<KEY,T,tlt>::operator = (const BTreeMap<KEY,T,tlt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  this->clear(); //deallocate the old one
+  if(lt==rhs.lt){
+    used=rhs.used;
+    LN* last= nullptr;
+    map=copy(rhs.map,last);
+  }else{
+    lt=rhs.lt;
+    for(auto e : rhs)
+      put(e.first,e.second);
+  }
+  ++mod_count;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::operator == (const BTreeMap<KEY,T,tlt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (used != rhs.size())
+    return false;
+  for(LN* leaf=first; leaf!= nullptr; leaf=leaf->next)
+    for(int i=0; i<leaf->count; ++i){
+      T* value=rhs.find_value(leaf->values[i].first);
+      if(value== nullptr || !(*value==leaf->values[i].second))
+        return false;
+    }
+  return true;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::operator != (const BTreeMap<KEY,T,tlt>& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::ostream& operator << (std::ostream& outs, const BTreeMap<KEY,T,tlt>& m) {
+  outs << "map[";
+  if(!m.empty()) {
+    auto i = m.begin();
+    outs << (*i).first << "->" << (*i).second;
+    for (++i; i != m.end(); ++i)
+      outs << "," << (*i).first << "->" << (*i).second;
+  }
+  outs << "]";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BTreeMap<KEY,T,tlt>::begin () const -> BTreeMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<BTreeMap<KEY,T,tlt>*>(this),first);
+}
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BTreeMap<KEY,T,tlt>::end () const -> BTreeMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<BTreeMap<KEY,T,tlt>*>(this),nullptr);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BTreeMap<KEY,T,tlt>::child_index (IN* node, const KEY& key) const {
+  int i=0;
+  while(i<node->count && !lt(key,node->keys[i]))
+    ++i;
+  return i;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int BTreeMap<KEY,T,tlt>::leaf_index (LN* leaf, const KEY& key) const {
+  int i=0;
+  while(i<leaf->count && lt(leaf->values[i].first,key))
+    ++i;
+  return i;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BTreeMap<KEY,T,tlt>::LN* BTreeMap<KEY,T,tlt>::find_leaf (const KEY& key) const {
+  if(map== nullptr)
+    return nullptr;
+  BN* temp=map;
+  while(!temp->is_leaf){
+    IN* node=static_cast<IN*>(temp);
+    temp=node->children[child_index(node,key)];
+  }
+  return static_cast<LN*>(temp);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T* BTreeMap<KEY,T,tlt>::find_value (const KEY& key) const {
+  LN* leaf=find_leaf(key);
+  if(leaf== nullptr)
+    return nullptr;
+  int i=leaf_index(leaf,key);
+  if(i<leaf->count && !lt(key,leaf->values[i].first))
+    return &leaf->values[i].second;
+  return nullptr;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename BTreeMap<KEY,T,tlt>::BN* BTreeMap<KEY,T,tlt>::copy (BN* root, LN*& last) const {
+  if(root== nullptr)
+    return nullptr;
+  if(root->is_leaf){
+    LN* leaf=new LN(*static_cast<LN*>(root));
+    leaf->prev=last;
+    leaf->next= nullptr;
+    if(last== nullptr)
+      const_cast<BTreeMap<KEY,T,tlt>*>(this)->first=leaf;
+    else
+      last->next=leaf;
+    last=leaf;
+    return leaf;
+  }else{
+    IN* from=static_cast<IN*>(root);
+    IN* node=new IN();
+    node->count=from->count;
+    for(int i=0; i<from->count; ++i)
+      node->keys[i]=from->keys[i];
+    for(int i=0; i<=from->count; ++i)
+      node->children[i]=copy(from->children[i],last);
+    return node;
+  }
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BTreeMap<KEY,T,tlt>::delete_tree (BN* root) {
+  if(root== nullptr)
+    return;
+  if(root->is_leaf)
+    delete static_cast<LN*>(root);
+  else{
+    IN* node=static_cast<IN*>(root);
+    for(int i=0; i<=node->count; ++i)
+      delete_tree(node->children[i]);
+    delete node;
+  }
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string BTreeMap<KEY,T,tlt>::string_rotated(BN* root, std::string indent) const {
+  if(root== nullptr)
+    return "";
+  std::ostringstream answer;
+  if(root->is_leaf){
+    LN* leaf=static_cast<LN*>(root);
+    for(int i=leaf->count-1; i>=0; --i)
+      answer<<indent<<leaf->values[i].first<<"->"<<leaf->values[i].second<<"\n";
+  }else{
+    IN* node=static_cast<IN*>(root);
+    for(int i=node->count; i>=0; --i){
+      answer<<string_rotated(node->children[i],indent+"..");
+      if(i>0)
+        answer<<indent<<"["<<node->keys[i-1]<<"]\n";
+    }
+  }
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T& BTreeMap<KEY,T,tlt>::find_addempty (const KEY& key, const T& value, bool& added) {
+  T* value_in= nullptr;
+  if(map== nullptr){
+    LN* leaf=new LN();
+    leaf->values[0]=Entry(key,value);
+    leaf->count=1;
+    map=first=leaf;
+    ++used;
+    added=true;
+    return leaf->values[0].second;
+  }
+  KEY up_key;
+  BN* up_node= nullptr;
+  added=insert(map,key,value,value_in,up_key,up_node);
+  if(up_node!= nullptr){                   //Root split: grow the tree by one level
+    IN* root=new IN();
+    root->count=1;
+    root->keys[0]=up_key;
+    root->children[0]=map;
+    root->children[1]=up_node;
+    map=root;
+  }
+  if(added)
+    ++used;
+  return *value_in;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::insert (BN* root, const KEY& key, const T& value, T*& value_in, KEY& up_key, BN*& up_node) {
+  up_node= nullptr;
+  if(root->is_leaf){
+    LN* leaf=static_cast<LN*>(root);
+    int i=leaf_index(leaf,key);
+    if(i<leaf->count && !lt(key,leaf->values[i].first)){
+      value_in=&leaf->values[i].second;
+      return false;
+    }
+    if(leaf->count==LEAF_CAP){
+      //Split: the upper half moves to a new leaf, linked after this one
+      LN* right=new LN();
+      int half=(LEAF_CAP+1)/2;
+      for(int j=half; j<LEAF_CAP; ++j)
+        right->values[j-half]=leaf->values[j];
+      right->count=LEAF_CAP-half;
+      leaf->count=half;
+      right->next=leaf->next;
+      right->prev=leaf;
+      if(leaf->next!= nullptr)
+        leaf->next->prev=right;
+      leaf->next=right;
+      if(i>=half){
+        leaf=right;
+        i-=half;
+      }
+      up_node=right;
+    }
+    for(int j=leaf->count; j>i; --j)
+      leaf->values[j]=leaf->values[j-1];
+    leaf->values[i]=Entry(key,value);
+    ++leaf->count;
+    value_in=&leaf->values[i].second;
+    if(up_node!= nullptr)
+      up_key=static_cast<LN*>(up_node)->values[0].first;
+    return true;
+  }
+
+  IN* node=static_cast<IN*>(root);
+  int c=child_index(node,key);
+  KEY child_key;
+  BN* child_node;
+  bool added=insert(node->children[c],key,value,value_in,child_key,child_node);
+  if(child_node== nullptr)
+    return added;
+
+  //Put child_key/child_node after children[c]; split this node first if it is full
+  if(node->count==INNER_CAP){
+    KEY keys[INNER_CAP+1];
+    BN* children[INNER_CAP+2];
+    for(int j=0, k=0; j<=INNER_CAP; ++j)
+      keys[j]=(j==c ? child_key : node->keys[k++]);
+    for(int j=0, k=0; j<=INNER_CAP+1; ++j)
+      children[j]=(j==c+1 ? child_node : node->children[k++]);
+    int half=(INNER_CAP+1)/2;                        //keys[half] moves up
+    IN* right=new IN();
+    node->count=half;
+    for(int j=0; j<half; ++j){
+      node->keys[j]=keys[j];
+      node->children[j]=children[j];
+    }
+    node->children[half]=children[half];
+    right->count=INNER_CAP-half;
+    for(int j=half+1; j<=INNER_CAP; ++j){
+      right->keys[j-half-1]=keys[j];
+      right->children[j-half-1]=children[j];
+    }
+    right->children[right->count]=children[INNER_CAP+1];
+    up_key=keys[half];
+    up_node=right;
+  }else{
+    for(int j=node->count; j>c; --j){
+      node->keys[j]=node->keys[j-1];
+      node->children[j+1]=node->children[j];
+    }
+    node->keys[c]=child_key;
+    node->children[c+1]=child_node;
+    ++node->count;
+  }
+  return added;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T BTreeMap<KEY,T,tlt>::remove (BN* root, const KEY& key) {
+  if(root->is_leaf){
+    LN* leaf=static_cast<LN*>(root);
+    int i=leaf_index(leaf,key);
+    if(i==leaf->count || lt(key,leaf->values[i].first)){
+      std::ostringstream answer;
+      answer << "BTreeMap::erase: key(" << key << ") not in Map";
+      throw KeyError(answer.str());
+    }
+    T to_return=leaf->values[i].second;
+    for(int j=i+1; j<leaf->count; ++j)
+      leaf->values[j-1]=leaf->values[j];
+    --leaf->count;
+    return to_return;
+  }
+  IN* node=static_cast<IN*>(root);
+  int c=child_index(node,key);
+  T to_return=remove(node->children[c],key);
+  fix_child(node,c);
+  return to_return;
+}
+
+
+//A child may hold no fewer than half its capacity: if it falls below that, borrow one from
+//  a sibling that can spare one, or else merge it with a sibling (node loses one key/child)
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void BTreeMap<KEY,T,tlt>::fix_child (IN* node, int i) {
+  BN* child=node->children[i];
+  if(child->count>=(child->is_leaf ? LEAF_CAP : INNER_CAP)/2)
+    return;
+  BN* left =(i>0           ? node->children[i-1] : nullptr);
+  BN* right=(i<node->count ? node->children[i+1] : nullptr);
+
+  if(child->is_leaf){
+    LN* c=static_cast<LN*>(child);
+    LN* l=static_cast<LN*>(left);
+    LN* r=static_cast<LN*>(right);
+    if(l!= nullptr && l->count>LEAF_CAP/2){
+      for(int j=c->count; j>0; --j)
+        c->values[j]=c->values[j-1];
+      c->values[0]=l->values[--l->count];
+      ++c->count;
+      node->keys[i-1]=c->values[0].first;
+      return;
+    }
+    if(r!= nullptr && r->count>LEAF_CAP/2){
+      c->values[c->count++]=r->values[0];
+      for(int j=1; j<r->count; ++j)
+        r->values[j-1]=r->values[j];
+      --r->count;
+      node->keys[i]=r->values[0].first;
+      return;
+    }
+    if(l!= nullptr){                       //Merge c into l; c is deleted below
+      r=c;
+      c=l;
+      --i;
+    }
+    //Merge r into c: r is children[i+1]
+    for(int j=0; j<r->count; ++j)
+      c->values[c->count++]=r->values[j];
+    c->next=r->next;
+    if(r->next!= nullptr)
+      r->next->prev=c;
+    delete r;
+  }else{
+    IN* c=static_cast<IN*>(child);
+    IN* l=static_cast<IN*>(left);
+    IN* r=static_cast<IN*>(right);
+    if(l!= nullptr && l->count>INNER_CAP/2){
+      c->children[c->count+1]=c->children[c->count];
+      for(int j=c->count; j>0; --j){
+        c->keys[j]=c->keys[j-1];
+        c->children[j]=c->children[j-1];
+      }
+      c->keys[0]=node->keys[i-1];
+      c->children[0]=l->children[l->count];
+      ++c->count;
+      node->keys[i-1]=l->keys[--l->count];
+      return;
+    }
+    if(r!= nullptr && r->count>INNER_CAP/2){
+      c->keys[c->count]=node->keys[i];
+      c->children[++c->count]=r->children[0];
+      node->keys[i]=r->keys[0];
+      for(int j=1; j<r->count; ++j){
+        r->keys[j-1]=r->keys[j];
+        r->children[j-1]=r->children[j];
+      }
+      r->children[r->count-1]=r->children[r->count];
+      --r->count;
+      return;
+    }
+    if(l!= nullptr){
+      r=c;
+      c=l;
+      --i;
+    }
+    //Merge r into c, with the key between them (node->keys[i]) moving down
+    c->keys[c->count++]=node->keys[i];
+    for(int j=0; j<r->count; ++j){
+      c->keys[c->count]=r->keys[j];
+      c->children[c->count]=r->children[j];
+      ++c->count;
+    }
+    c->children[c->count]=r->children[r->count];
+    delete r;
+  }
+
+  //Remove keys[i] and children[i+1] from node
+  for(int j=i+1; j<node->count; ++j){
+    node->keys[j-1]=node->keys[j];
+    node->children[j]=node->children[j+1];
+  }
+  --node->count;
+}
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>::Iterator::Iterator(BTreeMap<KEY,T,tlt>* iterate_over, LN* initial)
+: leaf(initial), index(0), ref_map(iterate_over),expected_mod_count(ref_map->mod_count){
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+BTreeMap<KEY,T,tlt>::Iterator::~Iterator()
+{}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BTreeMap<KEY,T,tlt>::Iterator::erase() -> Entry {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("BTreeMap::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("BTreeMap::Iterator::erase Iterator cursor already erased");
+  if(leaf== nullptr)
+    throw CannotEraseError("BTreeMap::Iterator::erase Iterator cursor beyond data structure");
+  can_erase=false;
+  Entry to_erase=leaf->values[index];
+  ref_map->erase(to_erase.first);
+  //Leaves may have been merged/rebalanced: find the first key after the erased one
+  leaf=ref_map->find_leaf(to_erase.first);
+  if(leaf!= nullptr){
+    index=ref_map->leaf_index(leaf,to_erase.first);
+    if(index==leaf->count){
+      leaf=leaf->next;
+      index=0;
+    }
+  }
+  expected_mod_count=ref_map->mod_count;
+  return to_erase;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string BTreeMap<KEY,T,tlt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_map->str() << "/current=";
+  if(leaf== nullptr)
+    answer << "end";
+  else
+    answer << leaf->values[index].first << "->" << leaf->values[index].second;
+  answer << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto  BTreeMap<KEY,T,tlt>::Iterator::operator ++ () -> BTreeMap<KEY,T,tlt>::Iterator& {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("BTreeMap::Iterator::operator ++");
+  if(leaf== nullptr)
+    return *this;
+  if(can_erase){
+    if(++index==leaf->count){
+      leaf=leaf->next;
+      index=0;
+    }
+  }else
+    can_erase=true;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto BTreeMap<KEY,T,tlt>::Iterator::operator ++ (int) -> BTreeMap<KEY,T,tlt>::Iterator {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("BTreeMap::Iterator::operator ++");
+  if(leaf== nullptr)
+    return *this;
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::Iterator::operator == (const BTreeMap<KEY,T,tlt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("BTreeMap::Iterator::operator ==");
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("BTreeMap::Iterator::operator ==");
+  if (ref_map != rhsASI->ref_map)
+    throw ComparingDifferentIteratorsError("BTreeMap::Iterator::operator ==");
+  return leaf==rhsASI->leaf && index==rhsASI->index;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool BTreeMap<KEY,T,tlt>::Iterator::operator != (const BTreeMap<KEY,T,tlt>::Iterator& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+pair<KEY,T>& BTreeMap<KEY,T,tlt>::Iterator::operator *() const {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("BTreeMap::Iterator::operator *");
+  if (!can_erase || leaf== nullptr) {
+    std::ostringstream where;
+    where << (leaf== nullptr ? "end" : "erased") << " when size = " << ref_map->size();
+    throw IteratorPositionIllegal("BTreeMap::Iterator::operator * Iterator illegal: "+where.str());
+  }
+  return leaf->values[index];
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+pair<KEY,T>* BTreeMap<KEY,T,tlt>::Iterator::operator ->() const {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("BTreeMap::Iterator::operator ->");
+  if (!can_erase || leaf== nullptr) {
+    std::ostringstream where;
+    where << (leaf== nullptr ? "end" : "erased") << " when size = " << ref_map->size();
+    throw IteratorPositionIllegal("BTreeMap::Iterator::operator -> Iterator illegal: "+where.str());
+  }
+  return &leaf->values[index];
+}
+
+
+}
+
+#endif /* BTREE_MAP_HPP_ */
@@ -0,0 +1,877 @@
+#ifndef COMPACT_BST_MAP_HPP_
+#define COMPACT_BST_MAP_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <cmath>
+#include "ics_exceptions.hpp"
+#include "pair.hpp"
+#include "array_stack.hpp"      //See Iterator
+
+
+namespace ics {
+
+
+#ifndef undefinedltdefined
+#define undefinedltdefined
+template<class T>
+bool undefinedlt (const T& a, const T& b) {return false;}
+#endif /* undefinedltdefined */
+
+//A BST whose nodes all live in one growable array, linking to their children by (32-bit) int
+//  indexes instead of pointers: a node is just its association and two ints (16 bytes for an
+//  int->int map, vs. BSTMap's 48 bytes plus the allocator's overhead for each TN).
+//So that nodes need no size or balance fields, the tree is a scapegoat tree (Galperin and Rivest):
+//  when a put makes a path too long, the subtree of a too-tall node on that path is rebuilt
+//  perfectly balanced; when erases shrink the map enough, the whole tree is rebuilt (see compact).
+//Erased nodes' slots are kept on a free list (linked through left), and reused by put.
+//compact (and put_all_sorted into an empty map) lays the nodes out in DFS (preorder) order, so a
+//  search from the root walks mostly forward through the array, with each subtree contiguous.
+//It has the same interface as BSTMap (minus the order statistics and join-based operations), so a
+//  program can switch between them with a typedef.
+//
+//Instantiate the templated class supplying tlt(a,b): true, iff a is less than b.
+//If tlt is defaulted to undefinedlt in the template, then a constructor must supply clt.
+//If both tlt and clt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedlt value supplied by tlt/clt is stored in the instance variable lt.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedlt<KEY>> class CompactBSTMap {
+  public:
+    typedef pair<KEY,T> Entry;
+    typedef bool (*ltfunc) (const KEY& a, const KEY& b);
+
+    //Destructor/Constructors
+    ~CompactBSTMap();
+
+    CompactBSTMap          (bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    CompactBSTMap          (const CompactBSTMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    explicit CompactBSTMap (const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    //If i iterates in increasing key order, the tree is built directly (see put_all_sorted)
+    template <class Iterable>
+    explicit CompactBSTMap (const Iterable& i, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    bool has_key    (const KEY& key) const;
+    bool has_value  (const T& value) const;
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    T    put   (const KEY& key, const T& value);
+    T    erase (const KEY& key);
+    void clear ();
+    void compact();           //Rebuild balanced, in DFS order, in an array of exactly size() nodes
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int put_all(const Iterable& i);
+
+    //i should iterate in increasing key order (for equal keys, the last value is kept): an empty
+    //  map is then built directly, as compact would leave it, in O(N). Otherwise (or if i is not
+    //  actually sorted) each association is put.
+    template <class Iterable>
+    int put_all_sorted(const Iterable& i);
+
+
+    //Operators
+
+    T&       operator [] (const KEY&);
+    const T& operator [] (const KEY&) const;
+    CompactBSTMap<KEY,T,tlt>& operator = (const CompactBSTMap<KEY,T,tlt>& rhs);
+    bool operator == (const CompactBSTMap<KEY,T,tlt>& rhs) const;
+    bool operator != (const CompactBSTMap<KEY,T,tlt>& rhs) const;
+
+    template<class KEY2,class T2, bool (*lt2)(const KEY2& a, const KEY2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const CompactBSTMap<KEY2,T2,lt2>& m);
+
+
+
+  public:
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of CompactBSTMap<T>
+        ~Iterator();
+        Entry       erase();
+        std::string str  () const;
+        CompactBSTMap<KEY,T,tlt>::Iterator& operator ++ ();
+        CompactBSTMap<KEY,T,tlt>::Iterator  operator ++ (int);
+        bool operator == (const CompactBSTMap<KEY,T,tlt>::Iterator& rhs) const;
+        bool operator != (const CompactBSTMap<KEY,T,tlt>::Iterator& rhs) const;
+        Entry& operator *  () const;
+        Entry* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const CompactBSTMap<KEY,T,tlt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+        friend Iterator CompactBSTMap<KEY,T,tlt>::begin () const;
+        friend Iterator CompactBSTMap<KEY,T,tlt>::end   () const;
+
+      private:
+        //Nodes have no parent links, so the Iterator keeps the path of nodes still to visit: its
+        //  top is the current node (the stack is empty when beyond the last association)
+        //If can_erase is false, the top is already the "next" node (++ does nothing)
+        ArrayStack<int>           path;
+        CompactBSTMap<KEY,T,tlt>* ref_map;
+        int                       expected_mod_count;
+        bool                      can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(CompactBSTMap<KEY,T,tlt>* iterate_over, bool from_begin);
+        int current () const;                           //NIL for end
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    class TN {
+      public:
+        TN () : left(NIL), right(NIL){}
+        Entry value;
+        int   left, right;              //Indexes in nodes (NIL for none); a free TN's left is the next free one
+    };
+
+  //The tree is alpha-height-balanced: its height is at most log(max_used) base 100/ALPHA_PERCENT
+  //  (about 1.94*log2(N)), which for fewer than 2^31 nodes is less than MAX_HEIGHT
+  static const int NIL           = -1;
+  static const int ALPHA_PERCENT = 70;
+  static const int MAX_HEIGHT    = 64;
+
+  bool (*lt) (const KEY& a, const KEY& b); // The lt used for searching BST (from template or constructor)
+  TN* nodes     = nullptr;                 //nodes[0,top) are in the tree or on the free list
+  int length    = 0;                       //Physical length of nodes
+  int top       = 0;
+  int root      = NIL;
+  int free_list = NIL;
+  int used      = 0;                       //Cache the number of key->value pairs in the BST
+  int max_used  = 0;                       //Largest used since the last rebuild of the whole tree
+  int mod_count = 0;                       //For sensing concurrent modification
+
+  //Helper methods (all iterative, except building and string_rotated)
+  int   find_key      (const KEY& key)                             const; //Returns key's node index or NIL
+  int   find_addempty (const KEY& key, const T& value, bool& added);        //Return key's node (adding key->value first, if key absent)
+  int   new_node      (const Entry& value);                                 //From the free list (or top), growing nodes if full
+  void  ensure_length (int new_length);
+  int   max_height    (int n)                                      const; //Height allowed for a tree of n nodes
+  int   subtree_size  (int node)                                   const;
+  int   in_order      (int node, int* order)                       const; //Store node's subtree in order; return its size
+  int   link          (int* order, int low, int high);                      //Balanced subtree of order[low,high); return its root
+  int   build         (Entry* run, int low, int high, TN* to, int& next);   //Same, copying run into to[next...] in preorder
+  void  rebuild       (int node, int parent);                               //Rebuild node's subtree in place, relinking it to parent
+  void  copy          (const CompactBSTMap<KEY,T,tlt>& other);              //Copy other's nodes (identical structure)
+  void  push_left     (ArrayStack<int>& path, int node)            const; //Push node and all its left descendants
+  void  seek          (ArrayStack<int>& path, const KEY& key)      const; //Make path start at the first key not less than key
+  std::string string_rotated(int node, std::string indent)         const; //Returns string representing node's tree
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//CompactBSTMap class and related definitions
+
+//Destructor/Constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>::~CompactBSTMap() {
+  delete [] nodes;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>::CompactBSTMap(bool (*clt)(const KEY& a, const KEY& b))
+:lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("CompactBSTMap::default constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("CompactBSTMap::default constructor: both specified and different");
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>::CompactBSTMap(const CompactBSTMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt), mod_count(to_copy.mod_count){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    lt=to_copy.lt;
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("CompactBSTMap::copy constructor: both specified and different");
+  //copy the tree
+  if(lt==to_copy.lt)
+    copy(to_copy);
+  else
+    for(auto e : to_copy)
+      put(e.first,e.second);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>::CompactBSTMap(const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("CompactBSTMap::initializer_list constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("CompactBSTMap::initializer_list constructor: both specified and different");
+
+  for(const CompactBSTMap::Entry& i:il)
+    put(i.first,i.second);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template <class Iterable>
+CompactBSTMap<KEY,T,tlt>::CompactBSTMap(const Iterable& i, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("CompactBSTMap::Iterable constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("CompactBSTMap::Iterable constructor: both specified and different");
+  put_all_sorted(i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::empty() const {
+  return used==0;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::size() const {
+  return used;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::has_key (const KEY& key) const {
+  return find_key(key)!=NIL;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::has_value (const T& value) const {
+  for(const Entry& e : *this)
+    if(e.second==value)
+      return true;
+  return false;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string CompactBSTMap<KEY,T,tlt>::str() const {
+  std::ostringstream answer;
+  answer<<"compact_bst_map[\n"<<string_rotated(root,"")<<"](used="<<used<<",length="<<length
+        <<",top="<<top<<",mod_count="<<mod_count<<")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T CompactBSTMap<KEY,T,tlt>::put(const KEY& key, const T& value) {
+  ++mod_count;
+  bool added;
+  int node=find_addempty(key,value,added);
+  if(added)
+    return value;
+  T to_return=nodes[node].value.second;
+  nodes[node].value.second=value;
+  return to_return;
+}
+
+
+//Deletes the node holding key (or, if it has two children, its predecessor's node, after moving
+//  the predecessor's association into it); rebuilds the whole tree once used falls below
+//  ALPHA_PERCENT of max_used
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T CompactBSTMap<KEY,T,tlt>::erase(const KEY& key) {
+  int parent=NIL, node=root;
+  while(node!=NIL && !(key == nodes[node].value.first)){
+    parent=node;
+    node=(lt(key,nodes[node].value.first) ? nodes[node].left : nodes[node].right);
+  }
+  if(node==NIL){
+    std::ostringstream answer;
+    answer << "CompactBSTMap::erase: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  T removed=nodes[node].value.second;
+
+  if(nodes[node].left!=NIL && nodes[node].right!=NIL){
+    int pred_parent=node, pred=nodes[node].left;
+    while(nodes[pred].right!=NIL){
+      pred_parent=pred;
+      pred=nodes[pred].right;
+    }
+    nodes[node].value=nodes[pred].value;
+    parent=pred_parent;
+    node=pred;
+  }
+  int child=(nodes[node].left!=NIL ? nodes[node].left : nodes[node].right);
+  if(parent==NIL)
+    root=child;
+  else if(nodes[parent].left==node)
+    nodes[parent].left=child;
+  else
+    nodes[parent].right=child;
+
+  nodes[node].value=Entry();               //Release the association's resources now
+  nodes[node].left=free_list;
+  free_list=node;
+
+  --used;
+  ++mod_count;
+  if(100LL*used < (long long)ALPHA_PERCENT*max_used)
+    compact();
+  return removed;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::clear() {
+  delete [] nodes;
+  nodes= nullptr;
+  length=top=used=max_used=0;
+  root=free_list=NIL;
+  mod_count++;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::compact() {
+  Entry* run=new Entry[used];
+  int n=0;
+  for(const Entry& e : *this)
+    run[n++]=e;
+  TN* to=(used==0 ? nullptr : new TN[used]);
+  int next=0;
+  root=build(run,0,used,to,next);
+  delete [] run;
+  delete [] nodes;
+  nodes=to;
+  length=top=max_used=used;
+  free_list=NIL;
+  ++mod_count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int CompactBSTMap<KEY,T,tlt>::put_all(const Iterable& i) {
+  int count=0;
+  for(const Entry& e : i) {
+    put(e.first, e.second);
+    count++;
+  }
+  return count;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int CompactBSTMap<KEY,T,tlt>::put_all_sorted(const Iterable& i) {
+  if(used!=0)
+    return put_all(i);
+  int length=16, n=0, count=0;                  //i need not have size(): run doubles as needed
+  Entry* run=new Entry[length];
+  bool sorted=true;
+  for(const Entry& e : i){
+    ++count;
+    if(n==0 || lt(run[n-1].first,e.first)){
+      if(n==length){
+        Entry* bigger=new Entry[2*length];
+        for(int j=0; j<n; ++j)
+          bigger[j]=run[j];
+        delete [] run;
+        run=bigger;
+        length*=2;
+      }
+      run[n++]=e;
+    }else if(e.first==run[n-1].first)
+      run[n-1].second=e.second;                 //Keep the last value for equal keys
+    else{
+      sorted=false;
+      break;
+    }
+  }
+  if(!sorted){
+    delete [] run;
+    return put_all(i);
+  }
+  delete [] nodes;
+  nodes=(n==0 ? nullptr : new TN[n]);
+  int next=0;
+  root=build(run,0,n,nodes,next);
+  length=top=used=max_used=n;
+  free_list=NIL;
+  ++mod_count;
+  delete [] run;
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T& CompactBSTMap<KEY,T,tlt>::operator [] (const KEY& key) {
+  bool added;
+  int node=find_addempty(key,T(),added);
+  if(added)
+    ++mod_count;
+  return nodes[node].value.second;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+const T& CompactBSTMap<KEY,T,tlt>::operator [] (const KEY& key) const {
+  int node=find_key(key);
+  if(node==NIL) {
+    std::ostringstream answer;
+    answer << "CompactBSTMap::operator []: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  return nodes[node].value.second;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>& CompactBSTMap<KEY,T,tlt>::operator = (const CompactBSTMap<KEY,T,tlt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  this->clear(); //deallocate the old one
+  if(lt==rhs.lt)
+    copy(rhs);
+  else{
+    lt=rhs.lt;
+    for(auto e : rhs)
+      put(e.first,e.second);
+  }
+  ++mod_count;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::operator == (const CompactBSTMap<KEY,T,tlt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (used != rhs.size())
+    return false;
+  for(const Entry& e : *this){
+    int node=rhs.find_key(e.first);
+    if(node==NIL || !(rhs.nodes[node].value.second==e.second))
+      return false;
+  }
+  return true;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::operator != (const CompactBSTMap<KEY,T,tlt>& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::ostream& operator << (std::ostream& outs, const CompactBSTMap<KEY,T,tlt>& m) {
+  outs << "map[";
+  if(!m.empty()) {
+    auto i = m.begin();
+    outs << (*i).first << "->" << (*i).second;
+    for (++i; i != m.end(); ++i)
+      outs << "," << (*i).first << "->" << (*i).second;
+  }
+  outs << "]";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto CompactBSTMap<KEY,T,tlt>::begin () const -> CompactBSTMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<CompactBSTMap<KEY,T,tlt>*>(this),true);
+}
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto CompactBSTMap<KEY,T,tlt>::end () const -> CompactBSTMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<CompactBSTMap<KEY,T,tlt>*>(this),false);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::find_key (const KEY& key) const {
+  int node=root;
+  while(node!=NIL){
+    const TN& n=nodes[node];
+    if(key == n.value.first)
+      return node;
+    node=(lt(key,n.value.first) ? n.left : n.right);
+  }
+  return NIL;
+}
+
+
+//Puts a new node at the bottom of its search path; if that path is now longer than max_height
+//  allows, rebuild the subtree of the lowest node on it whose subtree is too tall for its size
+//  (such a node has a child holding more than ALPHA_PERCENT of its subtree)
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::find_addempty (const KEY& key, const T& value, bool& added) {
+  int path[MAX_HEIGHT+1];
+  int depth=0;
+  for(int node=root; node!=NIL; ){
+    if(key == nodes[node].value.first){
+      added=false;
+      return node;
+    }
+    path[depth++]=node;
+    node=(lt(key,nodes[node].value.first) ? nodes[node].left : nodes[node].right);
+  }
+
+  int node=new_node(Entry(key,value));     //May reallocate nodes
+  if(depth==0)
+    root=node;
+  else if(lt(key,nodes[path[depth-1]].value.first))
+    nodes[path[depth-1]].left=node;
+  else
+    nodes[path[depth-1]].right=node;
+  added=true;
+  if(++used>max_used)
+    max_used=used;
+
+  if(depth>max_height(used)){
+    int child=node, size=1;
+    for(int i=depth-1; i>=0; --i){
+      int sibling=(nodes[path[i]].left==child ? nodes[path[i]].right : nodes[path[i]].left);
+      size+=subtree_size(sibling)+1;
+      if(depth-i>max_height(size)){
+        rebuild(path[i], i==0 ? NIL : path[i-1]);
+        break;
+      }
+      child=path[i];
+    }
+  }
+  return node;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::new_node (const Entry& value) {
+  int node;
+  if(free_list!=NIL){
+    node=free_list;
+    free_list=nodes[node].left;
+  }else{
+    if(top==length)
+      ensure_length(length==0 ? 16 : 2*length);
+    node=top++;
+  }
+  nodes[node].value=value;
+  nodes[node].left=nodes[node].right=NIL;
+  return node;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::ensure_length (int new_length) {
+  if(length>=new_length)
+    return;
+  TN* old_nodes=nodes;
+  nodes=new TN[new_length];
+  for(int i=0; i<top; ++i)
+    nodes[i]=old_nodes[i];
+  length=new_length;
+  delete [] old_nodes;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::max_height (int n) const {
+  return int(std::log(double(n))/std::log(100.0/ALPHA_PERCENT));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::subtree_size (int node) const {
+  int stack[MAX_HEIGHT+1];
+  int depth=0, size=0;
+  if(node!=NIL)
+    stack[depth++]=node;
+  while(depth>0){
+    const TN& n=nodes[stack[--depth]];
+    ++size;
+    if(n.left!=NIL)
+      stack[depth++]=n.left;
+    if(n.right!=NIL)
+      stack[depth++]=n.right;
+  }
+  return size;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::in_order (int node, int* order) const {
+  int stack[MAX_HEIGHT+1];
+  int depth=0, size=0;
+  while(node!=NIL || depth>0){
+    for(; node!=NIL; node=nodes[node].left)
+      stack[depth++]=node;
+    node=stack[--depth];
+    order[size++]=node;
+    node=nodes[node].right;
+  }
+  return size;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::link (int* order, int low, int high) {
+  if(low>=high)
+    return NIL;
+  int mid=low+(high-low)/2;
+  int node=order[mid];
+  nodes[node].left =link(order,low,mid);
+  nodes[node].right=link(order,mid+1,high);
+  return node;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::build (Entry* run, int low, int high, TN* to, int& next) {
+  if(low>=high)
+    return NIL;
+  int mid=low+(high-low)/2;
+  int node=next++;
+  to[node].value=run[mid];
+  to[node].left =build(run,low,mid,to,next);
+  to[node].right=build(run,mid+1,high,to,next);
+  return node;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::rebuild (int node, int parent) {
+  int* order=new int[subtree_size(node)];
+  int n=in_order(node,order);
+  int new_root=link(order,0,n);
+  if(parent==NIL)
+    root=new_root;
+  else if(nodes[parent].left==node)
+    nodes[parent].left=new_root;
+  else
+    nodes[parent].right=new_root;
+  delete [] order;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::copy (const CompactBSTMap<KEY,T,tlt>& other) {
+  nodes=(other.top==0 ? nullptr : new TN[other.top]);
+  for(int i=0; i<other.top; ++i)
+    nodes[i]=other.nodes[i];
+  length=top=other.top;
+  root=other.root;
+  free_list=other.free_list;
+  used=other.used;
+  max_used=other.max_used;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::push_left (ArrayStack<int>& path, int node) const {
+  for(; node!=NIL; node=nodes[node].left)
+    path.push(node);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void CompactBSTMap<KEY,T,tlt>::seek (ArrayStack<int>& path, const KEY& key) const {
+  path.clear();
+  for(int node=root; node!=NIL; )
+    if(lt(nodes[node].value.first,key))
+      node=nodes[node].right;
+    else{
+      path.push(node);
+      if(key == nodes[node].value.first)
+        break;
+      node=nodes[node].left;
+    }
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string CompactBSTMap<KEY,T,tlt>::string_rotated(int node, std::string indent) const {
+  if(node==NIL)
+    return "";
+  std::ostringstream answer;
+  answer<<string_rotated(nodes[node].right,indent+"..");
+  answer<<indent<<nodes[node].value.first<<"->"<<nodes[node].value.second<<"\n";
+  answer<<string_rotated(nodes[node].left,indent+"..");
+  return answer.str();
+}
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>::Iterator::Iterator(CompactBSTMap<KEY,T,tlt>* iterate_over, bool from_begin)
+: ref_map(iterate_over),expected_mod_count(ref_map->mod_count){
+  if(from_begin)
+    ref_map->push_left(path,ref_map->root);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+CompactBSTMap<KEY,T,tlt>::Iterator::~Iterator()
+{}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int CompactBSTMap<KEY,T,tlt>::Iterator::current() const {
+  return path.empty() ? NIL : path.peek();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto CompactBSTMap<KEY,T,tlt>::Iterator::erase() -> Entry {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("CompactBSTMap::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("CompactBSTMap::Iterator::erase Iterator cursor already erased");
+  if(path.empty())
+    throw CannotEraseError("CompactBSTMap::Iterator::erase Iterator cursor beyond data structure");
+  Entry to_erase=ref_map->nodes[path.peek()].value;
+  //erase may move associations between nodes (or rebuild the tree): find the next key's path
+  //  again afterwards
+  ref_map->push_left(path,ref_map->nodes[path.pop()].right);
+  can_erase=false;
+  bool at_end=path.empty();
+  KEY next_key=(at_end ? to_erase.first : ref_map->nodes[path.peek()].value.first);
+  ref_map->erase(to_erase.first);
+  if(at_end)
+    path.clear();
+  else
+    ref_map->seek(path,next_key);
+  expected_mod_count=ref_map->mod_count;
+  return to_erase;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string CompactBSTMap<KEY,T,tlt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_map->str() << "/current=";
+  if(path.empty())
+    answer << "end";
+  else
+    answer << ref_map->nodes[path.peek()].value.first << "->" << ref_map->nodes[path.peek()].value.second;
+  answer << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto  CompactBSTMap<KEY,T,tlt>::Iterator::operator ++ () -> CompactBSTMap<KEY,T,tlt>::Iterator& {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("CompactBSTMap::Iterator::operator ++");
+  if(path.empty())
+    return *this;
+  if(can_erase)
+    ref_map->push_left(path,ref_map->nodes[path.pop()].right);
+  else
+    can_erase=true;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto CompactBSTMap<KEY,T,tlt>::Iterator::operator ++ (int) -> CompactBSTMap<KEY,T,tlt>::Iterator {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("CompactBSTMap::Iterator::operator ++");
+  if(path.empty())
+    return *this;
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::Iterator::operator == (const CompactBSTMap<KEY,T,tlt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("CompactBSTMap::Iterator::operator ==");
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("CompactBSTMap::Iterator::operator ==");
+  if (ref_map != rhsASI->ref_map)
+    throw ComparingDifferentIteratorsError("CompactBSTMap::Iterator::operator ==");
+  return current()==rhsASI->current();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool CompactBSTMap<KEY,T,tlt>::Iterator::operator != (const CompactBSTMap<KEY,T,tlt>::Iterator& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+pair<KEY,T>& CompactBSTMap<KEY,T,tlt>::Iterator::operator *() const {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("CompactBSTMap::Iterator::operator *");
+  if (!can_erase || path.empty()) {
+    std::ostringstream where;
+    where << (path.empty() ? "end" : "erased") << " when size = " << ref_map->size();
+    throw IteratorPositionIllegal("CompactBSTMap::Iterator::operator * Iterator illegal: "+where.str());
+  }
+  return ref_map->nodes[path.peek()].value;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+pair<KEY,T>* CompactBSTMap<KEY,T,tlt>::Iterator::operator ->() const {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("CompactBSTMap::Iterator::operator ->");
+  if (!can_erase || path.empty()) {
+    std::ostringstream where;
+    where << (path.empty() ? "end" : "erased") << " when size = " << ref_map->size();
+    throw IteratorPositionIllegal("CompactBSTMap::Iterator::operator -> Iterator illegal: "+where.str());
+  }
+  return &ref_map->nodes[path.peek()].value;
+}
+
+
+}
+
+#endif /* COMPACT_BST_MAP_HPP_ */
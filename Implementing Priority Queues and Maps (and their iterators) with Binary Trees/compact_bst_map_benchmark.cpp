@@ -0,0 +1,100 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>            //For std::atoi
+#include <malloc.h>           //For mallinfo2 (glibc): bytes allocated on the heap
+#include "bst_map.hpp"
+#include "compact_bst_map.hpp"
+
+
+//Heap bytes per entry, build time, and random has_key time of a CompactBSTMap compared to a
+//  BSTMap, with int keys and values: each built by putting N keys in random order, and by its
+//  Iterable constructor from the keys in sorted order (a bulk build).
+//Heap bytes are the growth of the heap over the build, as reported by glibc's mallinfo2.
+
+const int LOOKUPS = 2000000;
+
+bool int_lt(const int& a, const int& b) {return a < b;}
+
+typedef ics::pair<int,int> Entry;
+typedef ics::BSTMap       <int,int,int_lt> BST;
+typedef ics::CompactBSTMap<int,int,int_lt> Compact;
+
+
+size_t heap_bytes() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+
+template<class MAP>
+void run(const std::string& name, const std::vector<int>& keys, const std::vector<int>& lookups, bool sorted) {
+  std::vector<Entry> entries;
+  if (sorted) {
+    for (int k : keys)
+      entries.push_back(Entry(k,k));
+    std::sort(entries.begin(),entries.end(),[](const Entry& a, const Entry& b){return a.first < b.first;});
+  }
+  size_t before = heap_bytes();
+  auto start = std::chrono::steady_clock::now();
+  MAP* m;
+  if (sorted)
+    m = new MAP(entries);
+  else {
+    m = new MAP();
+    for (int k : keys)
+      m->put(k,k);
+  }
+  double build = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  size_t after = heap_bytes();
+
+  start = std::chrono::steady_clock::now();
+  long long found = 0;
+  for (int k : lookups)
+    found += m->has_key(k);
+  double lookup = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+  std::cout << name << "  " << double(after-before)/keys.size() << " bytes/entry  build "
+            << build/keys.size()*1e9 << " ns  has_key " << lookup/lookups.size()*1e9 << " ns  ("
+            << found%2 << ")" << std::endl;
+  delete m;
+}
+
+
+//The optional argument is N (default 1,000,000)
+int main(int argc, char* argv[]) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 1000000;
+  std::mt19937 random(5);
+  std::vector<int> keys(n);
+  for (int i=0; i<n; ++i)
+    keys[i] = 2*i;
+  std::shuffle(keys.begin(),keys.end(),random);
+  std::vector<int> lookups(LOOKUPS);
+  for (int& k : lookups)
+    k = 2*(random()%n);
+
+  std::cout << "N=" << n << std::endl;
+  run<BST>    ("BSTMap put (random order) ",keys,lookups,false);
+  run<Compact>("CompactBSTMap put         ",keys,lookups,false);
+  run<BST>    ("BSTMap sorted build       ",keys,lookups,true);
+  run<Compact>("CompactBSTMap sorted build",keys,lookups,true);
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2), with no argument and with argument 10000000:
+//                            bytes/entry   build ns   has_key ns
+//N=1000000
+//BSTMap put (random order)       64          1836        1249
+//CompactBSTMap put               16.8         965         917
+//BSTMap sorted build             48            54         830
+//CompactBSTMap sorted build      16            20         544
+//N=10000000
+//BSTMap put (random order)       64          3371        2405
+//CompactBSTMap put               26.8        1992        1956
+//BSTMap sorted build             48            46        1356
+//CompactBSTMap sorted build      16            15         828
+//(CompactBSTMap's put grows its node array by doubling, so its bytes/entry depend on N)
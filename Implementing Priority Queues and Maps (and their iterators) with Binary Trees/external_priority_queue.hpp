@@ -0,0 +1,517 @@
+#ifndef EXTERNAL_PRIORITY_QUEUE_HPP_
+#define EXTERNAL_PRIORITY_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <cstdio>               //For std::FILE, std::tmpfile, std::fread/fwrite
+#include <cstdint>              //For std::uint32_t
+#include <type_traits>          //For std::is_trivially_copyable
+#include <utility>              //For std::move/std::swap functions
+#include <memory>               //For std::unique_ptr
+#include <algorithm>            //For std::max/std::min
+#include <climits>              //For INT_MAX
+#include "ics_exceptions.hpp"
+#include "heap_priority_queue.hpp"
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+
+//spill_write/spill_read store values in (and load them from) the temporary files of an
+//  ExternalPriorityQueue: spill_read returns false at the end of the file. These handle values
+//  that can be copied byte-for-byte and std::strings; overload them (in namespace ics, or in the
+//  namespace of T) for other types.
+template<class T>
+void spill_write (std::FILE* f, const T& value) {
+  static_assert(std::is_trivially_copyable<T>::value, "spill_write: overload it for this type");
+  std::fwrite(&value, sizeof(T), 1, f);
+}
+
+template<class T>
+bool spill_read (std::FILE* f, T& value) {
+  static_assert(std::is_trivially_copyable<T>::value, "spill_read: overload it for this type");
+  return std::fread(&value, sizeof(T), 1, f) == 1;
+}
+
+inline void spill_write (std::FILE* f, const std::string& value) {
+  std::uint32_t length = value.size();
+  std::fwrite(&length, sizeof(length), 1, f);
+  std::fwrite(value.data(), 1, length, f);
+}
+
+inline bool spill_read (std::FILE* f, std::string& value) {
+  std::uint32_t length;
+  if (std::fread(&length, sizeof(length), 1, f) != 1)
+    return false;
+  value.resize(length);
+  return length == 0 || std::fread(&value[0], 1, length, f) == length;
+}
+
+
+//A priority queue for more values than fit in memory. At most memory_values values are held in
+//  memory: half of them in an insertion heap (a HeapPriorityQueue); when it fills, it is emptied
+//  in priority order into a sorted "run" in a temporary file. The highest-priority value is the
+//  higher of the insertion heap's and the runs' first values: a small heap of runs (a k-way merge)
+//  finds the latter. Each run reads its file sequentially, buffer_values values at a time, into its
+//  own buffer, through a stdio buffer of buffer_values*sizeof(T) bytes. Both buffers share the
+//  other half of the memory budget, so each run costs about 2*buffer_values values of it. Files
+//  are written and read only sequentially.
+//Runs are merged level by level, as in an external merge sort: a spilled run has level 0, and a
+//  run of at least fan_in^L*memory_values/2 values has level L. When there is no room for another
+//  run, the runs of the lowest level that has at least fan_in of them are merged into one run (in
+//  a new file) of a higher level, so each value is written at most 1+log_fan_in(N/(memory_values/2))
+//  times for N values enqueued (spilled() counts them). Some level has fan_in runs whenever there
+//  are more than fan_in-1 runs per level, and an int size bounds the levels, so the constructor
+//  picks the largest fan_in for which that many runs fit in the budget, making buffer_values
+//  smaller if even fan_in 2 would not fit. (Only if memory_values is too small for that are all
+//  the runs merged into one.)
+//Temporary files come from std::tmpfile (in the system's temporary directory) and are removed
+//  when their runs are used up, or when the queue is destroyed. If writing a temporary file fails,
+//  IcsError is raised and the values being written to it are lost (size() no longer counts them).
+//
+//Values are stored in the files by spill_write/spill_read (above). The queue cannot be copied, and
+//  has no Iterator (iterating would have to read every run).
+//
+//Instantiate the templated class supplying tgt(a,b): true, iff a has higher priority than b.
+//If tgt is defaulted to undefinedgt in the template, then a constructor must supply cgt.
+//If both tgt and cgt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class ExternalPriorityQueue {
+  public:
+    typedef bool (*gtfunc) (const T& a, const T& b);
+
+    //Destructor/Constructors
+    ~ExternalPriorityQueue();
+
+    explicit ExternalPriorityQueue(int memory_values, int buffer_values = 4096, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    ExternalPriorityQueue(const ExternalPriorityQueue<T,tgt>& to_copy) = delete;
+
+
+    //Queries
+    bool empty       () const;
+    int  size        () const;
+    int  runs        () const;        //Number of runs in temporary files
+    int  fan_in      () const;        //Number of runs of one level merged into one run
+    long long spilled() const;        //Number of values ever written to temporary files
+    const T& peek    () const;
+    std::string str  () const; //supplies useful debugging information
+
+
+    //Commands
+    int  enqueue (const T& element);
+    T    dequeue ();
+    void clear   ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    ExternalPriorityQueue<T,tgt>& operator = (const ExternalPriorityQueue<T,tgt>& rhs) = delete;
+
+
+  private:
+    //A sorted run: its first values are buffer[next..filled-1]; on_disk more follow in file
+    struct Run {
+      std::FILE* file;
+      char*      io_buffer;
+      T*         buffer;
+      int        next   = 0;
+      int        filled = 0;
+      int        on_disk;
+      int        level  = 0;          //See level_of
+
+      Run(int buffer_values);
+      ~Run();
+      const T& first() const {return buffer[next];}
+      bool     advance();             //Past first(); false if the run is used up
+      void     refill();
+    };
+
+    bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
+    HeapPriorityQueue<T,tgt,4> insertion;
+    int   insertion_capacity;         //Spill when insertion reaches this size
+    int   buffer_values;              //Size of each Run's buffer
+    int   max_runs;                   //Most runs whose buffers fit in the budget
+    int   merge_fan_in;               //Merge this many runs of one level into one run
+    Run** merge;                      //Heap of runs: highest-priority first value at merge[0]
+    int   merge_used = 0;
+    Run** group;                      //Heap of the runs being merged into a new run (see merge_level)
+    int   group_used = 0;
+    int   on_runs    = 0;             //Values in all runs (buffered or on disk)
+    long long spilled_count = 0;
+
+
+    //Helper methods
+    static gtfunc checked_gt (gtfunc cgt);  //Checked before insertion is constructed with it
+    static int runs_needed   (int fan_in, int insertion_capacity);
+    bool run_gt         (const Run* r1, const Run* r2) const;
+    void heap_add       (Run** heap, int& used, Run* r);
+    void heap_down      (Run** heap, int used, int h);
+    void heap_pop       (Run** heap, int& used);   //Advance heap[0]'s run past its first value
+    int  level_of       (int values) const;
+    int  full_level     () const;     //Lowest level with at least merge_fan_in runs, or -1
+    void write_run      (Run* r, bool from_insertion);
+    void spill          ();
+    void merge_level    (int level);  //Merge the runs of level (all runs if level < 0) into one
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//ExternalPriorityQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+ExternalPriorityQueue<T,tgt>::~ExternalPriorityQueue() {
+  for (int m=0; m<merge_used; ++m)
+    delete merge[m];
+  delete [] merge;
+  delete [] group;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+ExternalPriorityQueue<T,tgt>::ExternalPriorityQueue(int memory_values, int buffer_values, bool (*cgt)(const T& a, const T& b))
+: gt(checked_gt(cgt)), insertion(gt) {
+  if (memory_values < 4 || buffer_values < 1) {
+    std::ostringstream answer;
+    answer << "ExternalPriorityQueue::memory constructor: memory_values(" << memory_values
+           << ") < 4 or buffer_values(" << buffer_values << ") < 1";
+    throw IcsError(answer.str());
+  }
+
+  insertion_capacity  = memory_values/2;
+  int run_memory      = memory_values-insertion_capacity;
+  this->buffer_values = std::min(buffer_values, memory_values/4);
+  this->buffer_values = std::max(1, std::min(this->buffer_values, run_memory/(2*runs_needed(2,insertion_capacity))));
+  max_runs            = std::max(2, run_memory/(2*this->buffer_values));
+  for (merge_fan_in = 2; runs_needed(merge_fan_in+1,insertion_capacity) <= max_runs; ++merge_fan_in)
+    ;
+  merge               = new Run*[max_runs];
+  group               = new Run*[max_runs];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool ExternalPriorityQueue<T,tgt>::empty() const {
+  return size() == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::size() const {
+  return insertion.size() + on_runs;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::runs() const {
+  return merge_used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::fan_in() const {
+  return merge_fan_in;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+long long ExternalPriorityQueue<T,tgt>::spilled() const {
+  return spilled_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& ExternalPriorityQueue<T,tgt>::peek () const {
+  if (empty())
+    throw EmptyError("ExternalPriorityQueue::peek");
+
+  if (merge_used == 0 || (!insertion.empty() && !gt(merge[0]->first(),insertion.peek())))
+    return insertion.peek();
+  return merge[0]->first();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string ExternalPriorityQueue<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "ExternalPriorityQueue[insertion=" << insertion.size() << "/" << insertion_capacity << ",runs=";
+  for (int m=0; m<merge_used; ++m)
+    answer << (m == 0 ? "" : ",") << "L" << merge[m]->level << ":" << (merge[m]->filled-merge[m]->next) << "+" << merge[m]->on_disk;
+  answer << "](buffer_values=" << buffer_values << ",max_runs=" << max_runs << ",fan_in=" << merge_fan_in
+         << ",spilled=" << spilled_count << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::enqueue(const T& element) {
+  if (insertion.size() == insertion_capacity)
+    spill();
+  insertion.enqueue(element);
+  return 1;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T ExternalPriorityQueue<T,tgt>::dequeue() {
+  if (this->empty())
+    throw EmptyError("ExternalPriorityQueue::dequeue");
+
+  if (merge_used == 0 || (!insertion.empty() && !gt(merge[0]->first(),insertion.peek())))
+    return insertion.dequeue();
+  T to_return = merge[0]->first();
+  heap_pop(merge,merge_used);
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::clear() {
+  insertion.clear();
+  for (int m=0; m<merge_used; ++m)
+    delete merge[m];
+  merge_used = 0;
+  on_runs    = 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+int ExternalPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Run definitions
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+ExternalPriorityQueue<T,tgt>::Run::Run(int buffer_values)
+: file(std::tmpfile()), io_buffer(nullptr), buffer(nullptr), on_disk(0) {
+  if (file == nullptr)
+    throw IcsError("ExternalPriorityQueue::Run: cannot create temporary file");
+  try {
+    io_buffer = new char[buffer_values*sizeof(T)];
+    std::setvbuf(file, io_buffer, _IOFBF, buffer_values*sizeof(T));
+    buffer = new T[buffer_values];
+  } catch (...) {
+    std::fclose(file);
+    delete [] io_buffer;
+    throw;
+  }
+}
+
+
+//Closing a std::tmpfile removes it
+template<class T, bool (*tgt)(const T& a, const T& b)>
+ExternalPriorityQueue<T,tgt>::Run::~Run() {
+  std::fclose(file);
+  delete [] io_buffer;
+  delete [] buffer;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool ExternalPriorityQueue<T,tgt>::Run::advance() {
+  if (++next < filled)
+    return true;
+  if (on_disk == 0)
+    return false;
+  refill();
+  return true;
+}
+
+
+//buffer's length is at least filled's initial value: see write_run
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::Run::refill() {
+  int buffer_length = filled;
+  for (next = filled = 0; filled < buffer_length && on_disk > 0; ++filled, --on_disk)
+    if (!spill_read(file, buffer[filled]))
+      throw IcsError("ExternalPriorityQueue::Run::refill: temporary file read failed");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto ExternalPriorityQueue<T,tgt>::checked_gt(gtfunc cgt) -> gtfunc {
+  if (tgt == (gtfunc)undefinedgt<T> && cgt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("ExternalPriorityQueue::memory constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("ExternalPriorityQueue::memory constructor: both specified and different");
+  return tgt != (gtfunc)undefinedgt<T> ? tgt : cgt;
+}
+
+
+//The fewest runs for which some level has fan_in runs when there is no room for another: fan_in-1
+//  of each level, plus one, plus the run being written. An int size bounds the levels (see level_of).
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::runs_needed(int fan_in, int insertion_capacity) {
+  int levels = 1;
+  for (long long values = (long long)insertion_capacity*fan_in; values <= INT_MAX; values *= fan_in)
+    ++levels;
+  return (fan_in-1)*levels + 2;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool ExternalPriorityQueue<T,tgt>::run_gt(const Run* r1, const Run* r2) const {
+  return gt(r1->first(),r2->first());
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::heap_add(Run** heap, int& used, Run* r) {
+  int h = used;
+  heap[used++] = r;
+  for (/*h*/; h > 0 && run_gt(heap[h],heap[(h-1)/2]); h = (h-1)/2)
+    std::swap(heap[h],heap[(h-1)/2]);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::heap_down(Run** heap, int used, int h) {
+  for (int c = 2*h+1; c < used; c = 2*h+1) {
+    if (c+1 < used && run_gt(heap[c+1],heap[c]))
+      ++c;
+    if (!run_gt(heap[c],heap[h]))
+      return;
+    std::swap(heap[h],heap[c]);
+    h = c;
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::heap_pop(Run** heap, int& used) {
+  --on_runs;
+  if (!heap[0]->advance()) {
+    delete heap[0];
+    heap[0] = heap[--used];
+  }
+  heap_down(heap,used,0);
+}
+
+
+//A run of values values has level L if values >= merge_fan_in^L*insertion_capacity (and not
+//  merge_fan_in times that): merging merge_fan_in runs of level L makes a run of level L+1
+//  (or lower, if values were dequeued from them)
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::level_of(int values) const {
+  int level = 0;
+  for (long long at_least = (long long)insertion_capacity*merge_fan_in; values >= at_least; at_least *= merge_fan_in)
+    ++level;
+  return level;
+}
+
+
+//Levels are < 32: insertion_capacity >= 2 and merge_fan_in >= 2, and values <= INT_MAX
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int ExternalPriorityQueue<T,tgt>::full_level() const {
+  int count[32] = {};
+  for (int m=0; m<merge_used; ++m)
+    ++count[merge[m]->level];
+  for (int level=0; level<32; ++level)
+    if (count[level] >= merge_fan_in)
+      return level;
+  return -1;
+}
+
+
+//Write a run, highest priority first, from the insertion heap or from merging the runs in group;
+//  then read back its first values, so its buffer needs no more than buffer_values.
+//  on_runs counts r's values only once it is written (the caller then adds r to merge).
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::write_run(Run* r, bool from_insertion) {
+  if (from_insertion)
+    for (/*r->on_disk*/; !insertion.empty(); ++r->on_disk)
+      spill_write(r->file, insertion.dequeue());
+  else
+    for (/*r->on_disk*/; group_used > 0; ++r->on_disk) {
+      spill_write(r->file, group[0]->first());
+      heap_pop(group,group_used);
+    }
+  if (std::fflush(r->file) != 0 || std::ferror(r->file))
+    throw IcsError("ExternalPriorityQueue::write_run: temporary file write failed");
+  spilled_count += r->on_disk;
+  on_runs       += r->on_disk;
+  r->level       = level_of(r->on_disk);
+  std::rewind(r->file);
+  r->filled = buffer_values;
+  r->refill();
+}
+
+
+//Make room for the new run (and later the run merged into) first; the constructor makes room for
+//  enough runs that some level is full (so merging all runs happens only when memory_values is too
+//  small for fan_in 2)
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::spill() {
+  if (merge_used+2 > max_runs)
+    merge_level(full_level());
+  std::unique_ptr<Run> r(new Run(buffer_values));  //Deletes r if write_run throws
+  write_run(r.get(),true);
+  heap_add(merge,merge_used,r.release());
+}
+
+
+//If writing the new run fails, the runs not yet used up go back into merge
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void ExternalPriorityQueue<T,tgt>::merge_level(int level) {
+  std::unique_ptr<Run> r(new Run(buffer_values));
+  int kept = 0;
+  for (int m=0; m<merge_used; ++m)
+    if (level < 0 || merge[m]->level == level)
+      heap_add(group,group_used,merge[m]);
+    else
+      merge[kept++] = merge[m];
+  merge_used = kept;
+  for (int m = merge_used/2-1; m >= 0; --m)
+    heap_down(merge,merge_used,m);
+
+  try {
+    write_run(r.get(),false);
+  } catch (...) {
+    while (group_used > 0)
+      heap_add(merge,merge_used,group[--group_used]);
+    throw;
+  }
+  heap_add(merge,merge_used,r.release());
+}
+
+}
+
+#endif /* EXTERNAL_PRIORITY_QUEUE_HPP_ */
@@ -0,0 +1,89 @@
+#include <string>
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstdlib>              //For std::atoi
+#include <sys/resource.h>       //For getrusage (peak resident memory)
+#include "heap_priority_queue.hpp"
+#include "external_priority_queue.hpp"
+
+
+//Time and peak resident memory to enqueue N random values and then dequeue them all, in an
+//  ExternalPriorityQueue with a memory budget of MEMORY_VALUES values (and the default
+//  buffer_values), and in a 4-ary HeapPriorityQueue holding them all; for ints and for
+//  corpus-entry-like strings. Peak memory is for the whole process, so each run is its own process.
+
+const int N             = 10000000;
+const int MEMORY_VALUES = 1000000;
+
+bool int_gt   (const int& a, const int& b)                 {return a < b;}
+bool string_gt(const std::string& a, const std::string& b) {return a < b;}
+
+int         make_value(int r, int)         {return r;}
+std::string make_value(int r, std::string) {return std::to_string(r)+"-corpus-entry-word";}
+
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+long peak_rss_mb() {
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss/1024;
+}
+
+
+template<class T, bool (*gt)(const T& a, const T& b)>
+void external(const char* type) {
+  std::mt19937 random(1);
+  long long check = 0;
+  auto start = std::chrono::steady_clock::now();
+  ics::ExternalPriorityQueue<T,gt> pq(MEMORY_VALUES);
+  for (int i=0; i<N; ++i)
+    pq.enqueue(make_value(random(),T()));
+  double enqueue = ms_since(start);
+  int runs = pq.runs();
+  for (T last = pq.peek(); !pq.empty(); last = pq.dequeue())
+    check += gt(pq.peek(),last);
+  std::cout << "ExternalPriorityQueue " << type << ": enqueue " << enqueue << " ms (" << runs
+            << " runs), total " << ms_since(start) << " ms, peak RSS " << peak_rss_mb() << " MB"
+            << (check == 0 ? "" : "  (OUT OF ORDER)") << std::endl;
+}
+
+
+template<class T, bool (*gt)(const T& a, const T& b)>
+void in_memory(const char* type) {
+  std::mt19937 random(1);
+  long long check = 0;
+  auto start = std::chrono::steady_clock::now();
+  ics::HeapPriorityQueue<T,gt,4> pq;
+  for (int i=0; i<N; ++i)
+    pq.enqueue(make_value(random(),T()));
+  double enqueue = ms_since(start);
+  for (T last = pq.peek(); !pq.empty(); last = pq.dequeue())
+    check += gt(pq.peek(),last);
+  std::cout << "HeapPriorityQueue " << type << ": enqueue " << enqueue << " ms, total " << ms_since(start)
+            << " ms, peak RSS " << peak_rss_mb() << " MB" << (check == 0 ? "" : "  (OUT OF ORDER)") << std::endl;
+}
+
+
+//The argument selects the run: 0 (default) external ints, 1 in-memory ints, 2 external strings,
+//  3 in-memory strings
+int main(int argc, char* argv[]) {
+  switch (argc > 1 ? std::atoi(argv[1]) : 0) {
+    case 0 : external <int,int_gt>("int");             break;
+    case 1 : in_memory<int,int_gt>("int");             break;
+    case 2 : external <std::string,string_gt>("string"); break;
+    case 3 : in_memory<std::string,string_gt>("string"); break;
+  }
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2), one process per run (arguments 0-3):
+//ExternalPriorityQueue int:    enqueue  2398 ms (19 runs), total  3524 ms, peak RSS   5 MB
+//HeapPriorityQueue int:        enqueue   382 ms,           total  5299 ms, peak RSS  67 MB
+//ExternalPriorityQueue string: enqueue 21000 ms (19 runs), total 27637 ms, peak RSS  49 MB
+//HeapPriorityQueue string:     enqueue  2621 ms,           total 40959 ms, peak RSS 899 MB
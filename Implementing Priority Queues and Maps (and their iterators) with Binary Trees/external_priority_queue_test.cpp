@@ -0,0 +1,101 @@
+#include <string>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <algorithm>            //For std::sort/std::push_heap/std::pop_heap
+#include <functional>           //For std::greater
+#include "external_priority_queue.hpp"
+
+
+//Checks that an ExternalPriorityQueue merges its runs level by level: enqueueing N random values
+//  writes each at most once per level, so spilled() <= N*(1+L), where L is the highest level, the
+//  largest with fan_in()^L*memory_values/2 <= N. (Merging all runs whenever there were too many
+//  rewrote each value about once per N/memory_values runs spilled.) Also checks that the values
+//  dequeue in priority order, including when values are dequeued between spills.
+//Prints one line per case and returns non-0 if any check fails.
+
+bool int_gt(const int& a, const int& b) {return a < b;}
+
+typedef ics::ExternalPriorityQueue<int,int_gt> Queue;
+
+int failures = 0;
+
+void check(bool ok, const std::string& what, const std::string& mode) {
+  if (!ok) {
+    std::cout << "FAILED: " << mode << " " << what << std::endl;
+    ++failures;
+  }
+}
+
+
+void run(int n, int memory_values, int buffer_values) {
+  std::string mode = "N=" + std::to_string(n) + " memory_values=" + std::to_string(memory_values)
+                     + " buffer_values=" + std::to_string(buffer_values);
+  std::mt19937 random(n);
+  std::vector<int> values;
+  values.reserve(n);
+  Queue q(memory_values,buffer_values);
+  for (int i=0; i<n; ++i) {
+    values.push_back(int(random()%1000000000));
+    q.enqueue(values.back());
+  }
+
+  int levels = 0;
+  for (long long at_least = (long long)(memory_values/2)*q.fan_in(); at_least <= n; at_least *= q.fan_in())
+    ++levels;
+  long long bound = (long long)n*(1+levels);
+  check(q.size() == n, "size", mode);
+  check(q.spilled() <= bound, "spilled() = " + std::to_string(q.spilled()) + " > " + std::to_string(bound), mode);
+  std::cout << mode << ": fan_in=" << q.fan_in() << " runs=" << q.runs() << " spilled/N="
+            << double(q.spilled())/n << " (bound " << 1+levels << ")" << std::endl;
+
+  std::sort(values.begin(),values.end());
+  bool in_order = true;
+  for (int v : values)
+    in_order = in_order && q.dequeue() == v;
+  check(in_order && q.empty() && q.runs() == 0, "dequeue order", mode);
+}
+
+
+//Dequeue between spills, so merged runs are smaller than their levels' sizes
+void run_interleaved(int n, int memory_values) {
+  std::string mode = "interleaved N=" + std::to_string(n) + " memory_values=" + std::to_string(memory_values);
+  std::mt19937 random(n);
+  Queue q(memory_values,16);
+  std::vector<int> in;                               //A binary heap mirroring q
+  bool in_order = true;
+  for (int i=0; i<n; ++i) {
+    int value = int(random()%1000);
+    in.push_back(value);
+    std::push_heap(in.begin(),in.end(),std::greater<int>());
+    q.enqueue(value);
+    if (random()%3 == 0) {
+      std::pop_heap(in.begin(),in.end(),std::greater<int>());
+      in_order = in_order && q.dequeue() == in.back();
+      in.pop_back();
+    }
+  }
+  check(q.size() == int(in.size()), "size", mode);
+  while (!in.empty()) {
+    std::pop_heap(in.begin(),in.end(),std::greater<int>());
+    in_order = in_order && q.dequeue() == in.back();
+    in.pop_back();
+  }
+  check(in_order && q.empty(), "dequeue order", mode);
+  std::cout << mode << ": spilled/N=" << double(q.spilled())/n << std::endl;
+}
+
+
+int main() {
+  for (int n : {10000, 20000, 40000, 80000})
+    run(n,1000,100);
+  run(1000000,100000,4096);
+  run(4000000,100000,4096);
+  run(2000000,1000000,4096);
+  run_interleaved(200000,1000);
+  run_interleaved(20000,64);                         //Too small for fan_in 2: merges all runs
+
+  if (failures == 0)
+    std::cout << "All checks passed" << std::endl;
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,530 @@
+#ifndef FROZEN_MAP_HPP_
+#define FROZEN_MAP_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <algorithm>            //For std::stable_sort, if an Iterable is not in key order
+#include "ics_exceptions.hpp"
+#include "pair.hpp"
+
+
+namespace ics {
+
+
+#ifndef undefinedltdefined
+#define undefinedltdefined
+template<class T>
+bool undefinedlt (const T& a, const T& b) {return false;}
+#endif /* undefinedltdefined */
+
+//An ordered map that cannot change after it is built (e.g., by BSTMap::freeze), laid out for fast
+//  searching: the keys are stored in an array in Eytzinger (BFS) order, like a heap: the root is
+//  at index 1 and the children of index k are at 2k and 2k+1; values are in a parallel array.
+//  So a search needs no pointers, and the first levels of the tree share a few cache lines.
+//The search loop has no data-dependent branch (k=2k+(keys[k]<key)), and it prefetches the keys
+//  4 levels (for 4 byte keys: 64/sizeof(KEY) indexes) below the current one, which are adjacent.
+//Iterators visit the associations in key order, by moving in the implicit tree.
+//
+//Instantiate the templated class supplying tlt(a,b): true, iff a is less than b.
+//If tlt is defaulted to undefinedlt in the template, then a constructor must supply clt.
+//If both tlt and clt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedlt value supplied by tlt/clt is stored in the instance variable lt.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedlt<KEY>> class FrozenMap {
+  public:
+    typedef pair<KEY,T> Entry;
+    typedef bool (*ltfunc) (const KEY& a, const KEY& b);
+
+    //Destructor/Constructors
+    ~FrozenMap();
+
+    FrozenMap          (bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    FrozenMap          (const FrozenMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    explicit FrozenMap (const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result,
+    //  and .size(). Building is O(N) if i iterates in increasing key order, else O(N log N).
+    //For equal keys, the last value is kept.
+    template <class Iterable>
+    explicit FrozenMap (const Iterable& i, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    bool has_key    (const KEY& key) const;
+    bool has_value  (const T& value) const;
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Operators
+
+    const T& operator [] (const KEY&) const;
+    FrozenMap<KEY,T,tlt>& operator = (const FrozenMap<KEY,T,tlt>& rhs);
+    bool operator == (const FrozenMap<KEY,T,tlt>& rhs) const;
+    bool operator != (const FrozenMap<KEY,T,tlt>& rhs) const;
+
+    template<class KEY2,class T2, bool (*lt2)(const KEY2& a, const KEY2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const FrozenMap<KEY2,T2,lt2>& m);
+
+
+
+  public:
+    class Iterator {
+      public:
+        //Private constructor called in begin/end/lower_bound, which are friends of FrozenMap<T>
+        ~Iterator();
+        std::string str  () const;
+        FrozenMap<KEY,T,tlt>::Iterator& operator ++ ();
+        FrozenMap<KEY,T,tlt>::Iterator  operator ++ (int);
+        bool operator == (const FrozenMap<KEY,T,tlt>::Iterator& rhs) const;
+        bool operator != (const FrozenMap<KEY,T,tlt>::Iterator& rhs) const;
+        const Entry& operator *  () const;
+        const Entry* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const FrozenMap<KEY,T,tlt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+        friend class FrozenMap<KEY,T,tlt>;
+
+      private:
+        //Keys and values are in separate arrays, so * and -> return a copy of the current association
+        int                   current;           //Index in keys/values: 0 when beyond the last association
+        FrozenMap<KEY,T,tlt>* ref_map;
+        int                   expected_mod_count;
+        mutable Entry         entry;             //Filled in by * and ->
+
+        //Called in friends begin/end/lower_bound
+        Iterator(FrozenMap<KEY,T,tlt>* iterate_over, int initial);
+    };
+
+
+    Iterator begin       () const;
+    Iterator end         () const;
+    Iterator lower_bound (const KEY& key) const;  //At the first key >= key (end if there is none)
+
+
+  private:
+  bool (*lt) (const KEY& a, const KEY& b); // The lt used for searching (from template or constructor)
+  KEY* keys      = nullptr;                //keys[1..used] in Eytzinger order (keys[0] is unused)
+  T*   values    = nullptr;                //values[k] is associated with keys[k]
+  int  used      = 0;                      //Number of associations (and last index) in the arrays
+  int  mod_count = 0;                      //Changed only by operator =
+
+  //Prefetching this multiple of index k fetches the keys 4 levels below k (for 4 byte keys)
+  static const int PREFETCH_STRIDE = sizeof(KEY) >= 64 ? 1 : 64/sizeof(KEY);
+
+  //Helper methods
+  bool less           (const KEY& a, const KEY& b) const;            //lt, inlined when tlt is supplied
+  int  lower_index    (const KEY& key)             const;            //Index of the first key >= key, or 0
+  int  first_index    ()                           const;            //Index of the smallest key, or 0
+  int  next_index     (int k)                      const;            //Index of the key after keys[k], or 0
+  void build          (Entry* run, int n);                           //run must be in increasing key order
+  int  fill           (Entry* run, int next, int k);                 //Store run[next...] in k's subtree; return next unused
+  void copy           (const FrozenMap<KEY,T,tlt>& to_copy);
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//FrozenMap class and related definitions
+
+//Destructor/Constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>::~FrozenMap() {
+  delete [] keys;
+  delete [] values;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>::FrozenMap(bool (*clt)(const KEY& a, const KEY& b))
+:lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("FrozenMap::default constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("FrozenMap::default constructor: both specified and different");
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>::FrozenMap(const FrozenMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    lt=to_copy.lt;
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("FrozenMap::copy constructor: both specified and different");
+  if(lt==to_copy.lt)
+    copy(to_copy);
+  else{
+    Entry* run=new Entry[to_copy.used];
+    int n=0;
+    for(const Entry& e : to_copy)
+      run[n++]=e;
+    std::stable_sort(run,run+n,[this](const Entry& a, const Entry& b){return lt(a.first,b.first);});
+    build(run,n);
+    delete [] run;
+  }
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>::FrozenMap(const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("FrozenMap::initializer_list constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("FrozenMap::initializer_list constructor: both specified and different");
+  Entry* run=new Entry[il.size()];
+  int n=0;
+  for(const Entry& e : il)
+    run[n++]=e;
+  std::stable_sort(run,run+n,[this](const Entry& a, const Entry& b){return lt(a.first,b.first);});
+  build(run,n);
+  delete [] run;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template <class Iterable>
+FrozenMap<KEY,T,tlt>::FrozenMap(const Iterable& i, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("FrozenMap::Iterable constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("FrozenMap::Iterable constructor: both specified and different");
+  Entry* run=new Entry[i.size()];
+  int n=0;
+  bool sorted=true;
+  for(const Entry& e : i) {
+    if(n!=0 && !lt(run[n-1].first,e.first))
+      sorted=false;
+    run[n++]=e;
+  }
+  if(!sorted)
+    std::stable_sort(run,run+n,[this](const Entry& a, const Entry& b){return lt(a.first,b.first);});
+  build(run,n);
+  delete [] run;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::empty() const {
+  return used==0;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int FrozenMap<KEY,T,tlt>::size() const {
+  return used;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::has_key (const KEY& key) const {
+  int k=lower_index(key);
+  return k!=0 && keys[k]==key;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::has_value (const T& value) const {
+  for(int k=1; k<=used; ++k)
+    if(values[k]==value)
+      return true;
+  return false;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string FrozenMap<KEY,T,tlt>::str() const {
+  std::ostringstream answer;
+  answer<<"frozen_map[";
+  for(int k=1; k<=used; ++k)
+    answer<<(k==1 ? "" : ",")<<k<<":"<<keys[k]<<"->"<<values[k];
+  answer<<"](used="<<used<<",mod_count="<<mod_count<<")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+const T& FrozenMap<KEY,T,tlt>::operator [] (const KEY& key) const {
+  int k=lower_index(key);
+  if(k==0 || !(keys[k]==key)) {
+    std::ostringstream answer;
+    answer << "FrozenMap::operator []: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  return values[k];
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>& FrozenMap<KEY,T,tlt>::operator = (const FrozenMap<KEY,T,tlt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  delete [] keys;
+  delete [] values;
+  lt=rhs.lt;
+  copy(rhs);
+  ++mod_count;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::operator == (const FrozenMap<KEY,T,tlt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (used != rhs.used)
+    return false;
+  for(int k=1; k<=used; ++k){
+    int rk=rhs.lower_index(keys[k]);
+    if(rk==0 || !(rhs.keys[rk]==keys[k]) || !(rhs.values[rk]==values[k]))
+      return false;
+  }
+  return true;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::operator != (const FrozenMap<KEY,T,tlt>& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::ostream& operator << (std::ostream& outs, const FrozenMap<KEY,T,tlt>& m) {
+  outs << "map[";
+  if(!m.empty()) {
+    int k=m.first_index();
+    outs << m.keys[k] << "->" << m.values[k];
+    for (k=m.next_index(k); k!=0; k=m.next_index(k))
+      outs << "," << m.keys[k] << "->" << m.values[k];
+  }
+  outs << "]";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto FrozenMap<KEY,T,tlt>::begin () const -> FrozenMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<FrozenMap<KEY,T,tlt>*>(this),first_index());
+}
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto FrozenMap<KEY,T,tlt>::end () const -> FrozenMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<FrozenMap<KEY,T,tlt>*>(this),0);
+}
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto FrozenMap<KEY,T,tlt>::lower_bound (const KEY& key) const -> FrozenMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<FrozenMap<KEY,T,tlt>*>(this),lower_index(key));
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//When tlt is supplied (a constant), the test folds away and the compiler can inline the call
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+inline bool FrozenMap<KEY,T,tlt>::less (const KEY& a, const KEY& b) const {
+  return tlt != (ltfunc)undefinedlt<KEY> ? tlt(a,b) : lt(a,b);
+}
+
+
+//Go left at k if keys[k] >= key, else right; past a leaf, k's bits record the turns: the last left
+//  turn (the last 0 bit, after dropping the trailing 1s for the right turns below it) was at the
+//  answer. If every turn was right, that drops all of k's bits, leaving 0 (no key is >= key).
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int FrozenMap<KEY,T,tlt>::lower_index (const KEY& key) const {
+  int k=1;
+  while(k<=used){
+#if defined(__GNUC__)
+    if((long long)k*PREFETCH_STRIDE<=used)
+      __builtin_prefetch(keys+k*PREFETCH_STRIDE);
+#endif
+    k=2*k+less(keys[k],key);
+  }
+  while(k&1)
+    k>>=1;
+  return k>>1;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int FrozenMap<KEY,T,tlt>::first_index () const {
+  if(used==0)
+    return 0;
+  int k=1;
+  while(2*k<=used)
+    k=2*k;
+  return k;
+}
+
+
+//The next key is the leftmost in k's right subtree; if there is none, it is the parent of the
+//  lowest ancestor (or k itself) that is a left child: drop the 1 bits (right children), then one
+//  more bit. For the last key that reaches 0.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int FrozenMap<KEY,T,tlt>::next_index (int k) const {
+  if(2*k+1<=used){
+    k=2*k+1;
+    while(2*k<=used)
+      k=2*k;
+    return k;
+  }
+  while(k&1)
+    k>>=1;
+  return k>>1;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void FrozenMap<KEY,T,tlt>::build (Entry* run, int n) {
+  //Keep the last value for equal keys (run is in nondecreasing order)
+  int distinct=0;
+  for(int i=0; i<n; ++i)
+    if(distinct!=0 && run[distinct-1].first==run[i].first)
+      run[distinct-1].second=run[i].second;
+    else
+      run[distinct++]=run[i];
+  used=distinct;
+  keys  =new KEY[used+1];
+  values=new T  [used+1];
+  fill(run,0,1);
+}
+
+
+//An in-order walk of the implicit tree visits its indexes in key order
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int FrozenMap<KEY,T,tlt>::fill (Entry* run, int next, int k) {
+  if(k>used)
+    return next;
+  next=fill(run,next,2*k);
+  keys  [k]=run[next].first;
+  values[k]=run[next].second;
+  return fill(run,next+1,2*k+1);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void FrozenMap<KEY,T,tlt>::copy (const FrozenMap<KEY,T,tlt>& to_copy) {
+  used  =to_copy.used;
+  keys  =new KEY[used+1];
+  values=new T  [used+1];
+  for(int k=1; k<=used; ++k){
+    keys  [k]=to_copy.keys[k];
+    values[k]=to_copy.values[k];
+  }
+}
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>::Iterator::Iterator(FrozenMap<KEY,T,tlt>* iterate_over, int initial)
+: current(initial), ref_map(iterate_over), expected_mod_count(ref_map->mod_count)
+{}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+FrozenMap<KEY,T,tlt>::Iterator::~Iterator()
+{}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string FrozenMap<KEY,T,tlt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_map->str() << "/current=" << current << "/expected_mod_count=" << expected_mod_count;
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto  FrozenMap<KEY,T,tlt>::Iterator::operator ++ () -> FrozenMap<KEY,T,tlt>::Iterator& {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("FrozenMap::Iterator::operator ++");
+  if(current!=0)
+    current=ref_map->next_index(current);
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto FrozenMap<KEY,T,tlt>::Iterator::operator ++ (int) -> FrozenMap<KEY,T,tlt>::Iterator {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("FrozenMap::Iterator::operator ++");
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::Iterator::operator == (const FrozenMap<KEY,T,tlt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("FrozenMap::Iterator::operator ==");
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("FrozenMap::Iterator::operator ==");
+  if (ref_map != rhsASI->ref_map)
+    throw ComparingDifferentIteratorsError("FrozenMap::Iterator::operator ==");
+  return current==rhsASI->current;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool FrozenMap<KEY,T,tlt>::Iterator::operator != (const FrozenMap<KEY,T,tlt>::Iterator& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto FrozenMap<KEY,T,tlt>::Iterator::operator *() const -> const Entry& {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("FrozenMap::Iterator::operator *");
+  if (current==0) {
+    std::ostringstream where;
+    where << "end when size = " << ref_map->size();
+    throw IteratorPositionIllegal("FrozenMap::Iterator::operator * Iterator illegal: "+where.str());
+  }
+  entry=Entry(ref_map->keys[current],ref_map->values[current]);
+  return entry;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto FrozenMap<KEY,T,tlt>::Iterator::operator ->() const -> const Entry* {
+  return &(**this);
+}
+
+
+}
+
+#endif /* FROZEN_MAP_HPP_ */
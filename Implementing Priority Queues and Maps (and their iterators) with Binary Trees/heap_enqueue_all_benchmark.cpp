@@ -0,0 +1,74 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include "heap_priority_queue.hpp"
+
+
+//Time to load N values into a 4-ary HeapPriorityQueue one enqueue at a time, compared to one
+//  enqueue_all (which heapifies only the subtrees holding the new values), for random and
+//  ascending ints and strings; ascending values are the worst case for enqueue (larger values
+//  have higher priority, so each percolates to the root). Also appending 9N/10 ascending ints to
+//  a heap already holding N/10.
+
+const int N = 10000000;
+
+bool int_gt   (const int& a, const int& b)                 {return a > b;}
+bool string_gt(const std::string& a, const std::string& b) {return a > b;}
+
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+template<class T, bool (*gt)(const T& a, const T& b)>
+void run(const std::string& name, const std::vector<T>& initial, const std::vector<T>& values) {
+  double one_at_a_time, all;
+  {
+    ics::HeapPriorityQueue<T,gt,4> pq(initial);
+    auto start = std::chrono::steady_clock::now();
+    for (const T& v : values)
+      pq.enqueue(v);
+    one_at_a_time = ms_since(start);
+  }
+  {
+    ics::HeapPriorityQueue<T,gt,4> pq(initial);
+    auto start = std::chrono::steady_clock::now();
+    pq.enqueue_all(values);
+    all = ms_since(start);
+  }
+  std::cout << name << "  enqueue " << one_at_a_time << " ms  enqueue_all " << all << " ms" << std::endl;
+}
+
+
+int main() {
+  std::mt19937 random(2);
+  std::vector<int> ints(N);
+  for (int& i : ints)
+    i = random();
+  run<int,int_gt>("random ints      ",std::vector<int>(),ints);
+  std::sort(ints.begin(),ints.end());
+  run<int,int_gt>("ascending ints   ",std::vector<int>(),ints);
+  run<int,int_gt>("9M ascending ints appended to 1M",std::vector<int>(ints.begin(),ints.begin()+N/10),
+                                                     std::vector<int>(ints.begin()+N/10,ints.end()));
+  std::vector<int>().swap(ints);
+
+  std::vector<std::string> strings(N);
+  for (std::string& s : strings)
+    s = std::to_string(random());
+  run<std::string,string_gt>("random strings   ",std::vector<std::string>(),strings);
+  std::sort(strings.begin(),strings.end());
+  run<std::string,string_gt>("ascending strings",std::vector<std::string>(),strings);
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2):
+//random ints                        enqueue  182 ms  enqueue_all 149 ms
+//ascending ints                     enqueue  301 ms  enqueue_all 132 ms
+//9M ascending ints appended to 1M   enqueue  266 ms  enqueue_all 112 ms
+//random strings                     enqueue  858 ms  enqueue_all 754 ms
+//ascending strings                  enqueue 2159 ms  enqueue_all 932 ms
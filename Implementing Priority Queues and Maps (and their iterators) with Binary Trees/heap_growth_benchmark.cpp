@@ -0,0 +1,118 @@
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <new>                //For std::bad_alloc
+#include <cstdlib>            //For std::malloc/std::free/std::atoi
+#include "pair.hpp"
+#include "heap_priority_queue.hpp"
+
+
+//Time and heap allocations to grow a 4-ary HeapPriorityQueue to N values, one enqueue at a time,
+//  for two payloads: a CorpusEntry-like pair of two array queues that (like courselib's
+//  ArrayQueue/ArraySet) declare their copy operations and so have no move constructor, making
+//  each relocation a copy; and an Info like dijkstra.hpp's, with two strings too long to be stored
+//  inside std::string (so each copy allocates), which can be moved.
+//Allocations are counted by replacing the global operator new, and include the copy of each
+//  value that enqueue stores.
+
+long long allocations = 0;
+
+void* operator new (std::size_t n) {
+  ++allocations;
+  void* p = std::malloc(n == 0 ? 1 : n);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+void* operator new[] (std::size_t n)    {return operator new(n);}
+void  operator delete (void* p) noexcept   {std::free(p);}
+void  operator delete[] (void* p) noexcept {std::free(p);}
+
+
+//An array queue with user-declared copy operations (so no move), like courselib's
+template<class T>
+class CopyOnlyQueue {
+  public:
+    CopyOnlyQueue() : values(new T[0]) {}
+    CopyOnlyQueue(const CopyOnlyQueue& q) : values(new T[q.length]), length(q.length), used(q.used) {
+      for (int i=0; i<used; ++i)
+        values[i] = q.values[i];
+    }
+    CopyOnlyQueue& operator = (const CopyOnlyQueue& rhs) {
+      if (this == &rhs)
+        return *this;
+      if (length < rhs.used) {
+        delete [] values;
+        length = rhs.used;
+        values = new T[length];
+      }
+      used = rhs.used;
+      for (int i=0; i<used; ++i)
+        values[i] = rhs.values[i];
+      return *this;
+    }
+    ~CopyOnlyQueue() {delete [] values;}
+    void enqueue(const T& v) {
+      if (used == length) {
+        T* old = values;
+        length = 2*length+1;
+        values = new T[length];
+        for (int i=0; i<used; ++i)
+          values[i] = old[i];
+        delete [] old;
+      }
+      values[used++] = v;
+    }
+    T*  values;
+    int length = 0;
+    int used   = 0;
+};
+
+typedef ics::pair<CopyOnlyQueue<std::string>,CopyOnlyQueue<std::string>> CorpusEntry;
+bool corpus_gt(const CorpusEntry& a, const CorpusEntry& b) {return a.first.values[0] < b.first.values[0];}
+
+struct Info {
+  std::string node, from;
+  int cost;
+};
+bool info_gt(const Info& a, const Info& b) {return a.cost < b.cost;}
+
+
+template<class T, bool (*gt)(const T& a, const T& b)>
+void grow(const std::string& name, int n, T value, void (*vary)(T& value, int i)) {
+  ics::HeapPriorityQueue<T,gt,4> pq;
+  long long before = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<n; ++i) {
+    vary(value,i);
+    pq.enqueue(value);
+  }
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+  long long count = allocations-before;
+  std::cout << name << "  " << seconds << " s  " << count << " allocations (" << double(count)/n
+            << " per value)" << std::endl;
+}
+
+
+void vary_corpus(CorpusEntry& e, int i) {e.first.values[0][1] = 'a'+i%26;}
+void vary_info  (Info& info, int i)     {info.cost = int((i*7919LL)%1000003);}
+
+
+//The optional argument is N (default 10,000,000)
+int main(int argc, char* argv[]) {
+  int n = argc > 1 ? std::atoi(argv[1]) : 10000000;
+  CorpusEntry e;
+  e.first.enqueue("w12345");
+  e.first.enqueue("w67890");
+  e.second.enqueue("follow");
+  grow<CorpusEntry,corpus_gt>("CorpusEntry-like",n,e,vary_corpus);
+  grow<Info,info_gt>("Info            ",n,Info{"a-node-name-longer-than-the-buffer","another-node-name-longer-than-it",0},vary_info);
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2); in parentheses, the same program built with the header from
+//  before values were constructed in place (when growing default-constructed a new array and
+//  copy-assigned into it):
+//CorpusEntry-like  4.2 s  73.6M allocations (7.4 per value)  (10.3 s  140.7M  (14.1 per value))
+//Info              2.3 s  20.0M allocations (2.0 per value)  ( 5.4 s   53.6M  ( 5.4 per value))
@@ -0,0 +1,54 @@
+#include <string>
+#include <iostream>
+#include <random>
+#include <chrono>
+#include "heap_priority_queue.hpp"
+
+
+//Time to iterate over the first k values (in priority order) of a HeapPriorityQueue of N strings
+//  (long enough not to fit in std::string's own buffer), for k from 10 up to N; and the time to
+//  compare two copies of it with ==. The Iterator visits values lazily, so the first k cost
+//  O(k log k) and copy no string.
+
+const int N = 1000000;
+
+bool string_gt(const std::string& a, const std::string& b) {return a > b;}
+
+typedef ics::HeapPriorityQueue<std::string,string_gt> PQ;
+
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+int main() {
+  std::mt19937 random(1);
+  PQ pq;
+  for (int i=0; i<N; ++i)
+    pq.enqueue("word" + std::to_string(random()) + "-padded-past-the-small-string-buffer");
+
+  for (int k : {10, 1000, 100000, N}) {
+    auto start = std::chrono::steady_clock::now();
+    size_t length = 0;
+    int visited = 0;
+    for (auto i = pq.begin(); i != pq.end() && visited < k; ++i, ++visited)
+      length += i->size();
+    std::cout << "first " << k << ": " << ms_since(start) << " ms  (" << length%2 << ")" << std::endl;
+  }
+
+  PQ a(pq), b(pq);
+  auto start = std::chrono::steady_clock::now();
+  bool equal = a == b;
+  std::cout << "==: " << ms_since(start) << " ms  (" << equal << ")" << std::endl;
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2); in parentheses, the same program built with the header from
+//  before the lazy Iterator (whose begin() copied and dequeued the whole queue):
+//first 10:       0.06 ms  (214 ms)
+//first 1000:     0.81 ms  (147 ms)
+//first 100000:    139 ms  (432 ms)
+//first 1000000:  2072 ms  (2305 ms)
+//==:             4827 ms  (3891 ms: for whole queues, dequeueing two copies was faster)
@@ -10,7 +10,9 @@
 #include <sstream>
 #include <initializer_list>
 #include "ics_exceptions.hpp"
-#include <utility>              //For std::swap function
+#include <utility>              //For std::move function
+#include <new>                  //For placement new
+#include <algorithm>            //For std::max/std::min
 #include "array_stack.hpp"      //See operator <<
 
 namespace ics {
@@ -27,7 +29,13 @@ bool undefinedgt (const T& a, const T& b) {return false;}
 //If both tgt and cgt are supplied, then they must be the same (by ==) function.
 //If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
 //The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
-template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class HeapPriorityQueue {
+//
+//ARITY is the number of children of each node (a d-ary heap): the children of node i are
+//  pq[ARITY*i+1..ARITY*i+ARITY], adjacent in the array. A bigger ARITY makes the heap shallower
+//  (fewer levels for percolate_up, so cheaper enqueues) but percolate_down compares all ARITY
+//  children at each level; 4 is usually fastest (4 ints, or 8 with ARITY=8, share a cache line).
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>, int ARITY = 2> class HeapPriorityQueue {
+  static_assert(ARITY >= 2, "HeapPriorityQueue: ARITY must be at least 2");
   public:
     typedef bool (*gtfunc) (const T& a, const T& b);
         
@@ -36,7 +44,7 @@ template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class He
 
     HeapPriorityQueue(bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
     explicit HeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
-    HeapPriorityQueue(const HeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    HeapPriorityQueue(const HeapPriorityQueue<T,tgt,ARITY>& to_copy, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
     explicit HeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
 
     //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
@@ -48,6 +56,8 @@ template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class He
     bool empty      () const;
     int  size       () const;
     T&   peek       () const;
+    class PartialSorted;
+    PartialSorted partial_sorted (int k) const; //View of the k highest-priority values (see below)
     std::string str () const; //supplies useful debugging information; contrast to operator <<
 
 
@@ -62,46 +72,65 @@ template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class He
 
 
     //Operators
-    HeapPriorityQueue<T,tgt>& operator = (const HeapPriorityQueue<T,tgt>& rhs);
-    bool operator == (const HeapPriorityQueue<T,tgt>& rhs) const;
-    bool operator != (const HeapPriorityQueue<T,tgt>& rhs) const;
+    HeapPriorityQueue<T,tgt,ARITY>& operator = (const HeapPriorityQueue<T,tgt,ARITY>& rhs);
+    bool operator == (const HeapPriorityQueue<T,tgt,ARITY>& rhs) const;
+    bool operator != (const HeapPriorityQueue<T,tgt,ARITY>& rhs) const;
 
-    template<class T2, bool (*gt2)(const T2& a, const T2& b)>
-    friend std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T2,gt2>& pq);
+    template<class T2, bool (*gt2)(const T2& a, const T2& b), int ARITY2>
+    friend std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T2,gt2,ARITY2>& pq);
 
 
 
     class Iterator {
       public:
-        //Private constructor called in begin/end, which are friends of HeapPriorityQueue<T,tgt>
+        //Private constructor called in begin/end, which are friends of HeapPriorityQueue<T,tgt,ARITY>
         ~Iterator();
+        Iterator(const Iterator& to_copy);
+        Iterator& operator = (const Iterator& rhs);
         T           erase();
         std::string str  () const;
-        HeapPriorityQueue<T,tgt>::Iterator& operator ++ ();
-        HeapPriorityQueue<T,tgt>::Iterator  operator ++ (int);
-        bool operator == (const HeapPriorityQueue<T,tgt>::Iterator& rhs) const;
-        bool operator != (const HeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        HeapPriorityQueue<T,tgt,ARITY>::Iterator& operator ++ ();
+        HeapPriorityQueue<T,tgt,ARITY>::Iterator  operator ++ (int);
+        bool operator == (const HeapPriorityQueue<T,tgt,ARITY>::Iterator& rhs) const;
+        bool operator != (const HeapPriorityQueue<T,tgt,ARITY>::Iterator& rhs) const;
         T& operator *  () const;
         T* operator -> () const;
-        friend std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T,tgt>::Iterator& i) {
+        friend std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T,tgt,ARITY>::Iterator& i) {
           outs << i.str(); //Use the same meaning as the debugging .str() method
           return outs;
         }
 
-        friend Iterator HeapPriorityQueue<T,tgt>::begin () const;
-        friend Iterator HeapPriorityQueue<T,tgt>::end   () const;
+        friend Iterator HeapPriorityQueue<T,tgt,ARITY>::begin () const;
+        friend Iterator HeapPriorityQueue<T,tgt,ARITY>::end   () const;
+        friend class PartialSorted;
 
       private:
-        //If can_erase is false, the value has been removed from "it" (++ does nothing)
-        HeapPriorityQueue<T,tgt>  it;                 //copy of HPQ (from begin), to use as iterator via dequeue
-        HeapPriorityQueue<T,tgt>* ref_pq;
-        int                       expected_mod_count;
-        bool                      can_erase = true;
-
-        //Called in friends begin/end
-        //These constructors have different initializers (see it(...) in first one)
-        Iterator(HeapPriorityQueue<T,tgt>* iterate_over, bool from_begin);    // Called by begin
-        Iterator(HeapPriorityQueue<T,tgt>* iterate_over);                     // Called by end
+        //Iterates over ref_pq's own array, without copying or changing it. The indexes already
+        //  visited form a subtree at the root; frontier is a (binary) heap of the indexes of their
+        //  unvisited children, ordered by the values there: so its top indexes the highest unvisited
+        //  value, which is the current one. ++ replaces it by its children, so visiting k values costs
+        //  O(k log k) and frontier holds at most k*(ARITY-1)+1 ints.
+        //If can_erase is false, the value has been erased and frontier's top is already the next (++
+        //  does nothing).
+        HeapPriorityQueue<T,tgt,ARITY>* ref_pq;
+        int*                            frontier;
+        int                             frontier_length;
+        int                             frontier_used = 0;
+        int                             remaining;          //Number of values not yet iterated over
+        int                             expected_mod_count;
+        bool                            can_erase = true;
+
+        //Called in friends begin/end/PartialSorted: remaining is ref_pq's size for begin, 0 for end,
+        //  and size-k for the end of a PartialSorted view of k values
+        Iterator(HeapPriorityQueue<T,tgt,ARITY>* iterate_over, int remaining);
+
+        //Helpers for frontier (a heap of indexes of ref_pq->pq)
+        void frontier_add   (int i);
+        int  frontier_remove(int f);               //Remove frontier[f]; return the index that was there
+        bool frontier_gt    (int f1, int f2) const;
+        void frontier_up    (int f);
+        void frontier_down  (int f);
+        bool visited        (int i, int current) const;
     };
 
 
@@ -109,24 +138,58 @@ template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class He
     Iterator end   () const;
 
 
+    //Iterates over the k highest-priority values (or all, if there are fewer than k), in priority
+    //  order, without copying or changing the queue: so
+    //    for (const T& v : pq.partial_sorted(k)) ...
+    //  costs O(k log k), not the O(N log N) to dequeue a copy of the queue.
+    class PartialSorted {
+      public:
+        Iterator begin () const;
+        Iterator end   () const;
+
+        friend PartialSorted HeapPriorityQueue<T,tgt,ARITY>::partial_sorted (int k) const;
+
+      private:
+        HeapPriorityQueue<T,tgt,ARITY>* ref_pq;
+        int                             k;
+
+        PartialSorted(HeapPriorityQueue<T,tgt,ARITY>* ref_pq, int k);
+    };
+
+
   private:
     bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
     T*  pq;                              //Array stores a heap, so it uses the heap ordering property
+                                         //Only pq[0..used-1] are constructed: the rest is raw storage,
+                                         //  constructed (placement new) when used, destroyed when not
     int length    = 0;                   //Physical length of array: must be >= .size()
     int used      = 0;                   //Amount of array used: invariant: 0 <= used <= length
     int mod_count = 0;                   //For sensing concurrent modification
 
+    //restore_heap percolates up each new value when there are at most 1/RESTORE_BY_PERCOLATING_UP
+    //  as many of them as old values; otherwise it heapifies the subtrees containing them
+    static const int RESTORE_BY_PERCOLATING_UP = 8;
+
 
     //Helper methods
-    void ensure_length  (int new_length);
-    int  left_child     (int i) const;         //Useful abstractions for heaps as arrays
-    int  right_child    (int i) const;
+    static T* allocate  (int length);        //Raw storage for length Ts: none constructed
+    static void deallocate (T* storage);
+    void destroy_all    ();                   //Destroy pq[0..used-1]; used becomes 0
+    void ensure_length  (int new_length);     //Grows by moving (not copying) values to new storage
+    int  first_child    (int i) const;         //Useful abstractions for heaps as arrays
     int  parent         (int i) const;
     bool is_root        (int i) const;
     bool in_heap        (int i) const;
+    //Both move a "hole" (not swapping values): one move per level, and the percolated value is
+    //  stored only once, at the end
     void percolate_up   (int i);
     void percolate_down (int i);
-    void heapify        ();                   // Percolate down all value is array (from indexes used-1 to 0): O(N)
+    void heapify        ();                   //restore_heap(0): O(N)
+    void restore_heap   (int first_new);      //Restore heap order after appending values at pq[first_new..used-1]
+
+    //Appends the values to pq (growing it as needed), without restoring the heap ordering property
+    template <class Iterable>
+    int append_all (const Iterable& i);
   };
 
 
@@ -139,25 +202,26 @@ template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class He
 
 //Destructor/Constructors
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::~HeapPriorityQueue() {
-  delete [] pq;
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::~HeapPriorityQueue() {
+  destroy_all();
+  deallocate(pq);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::HeapPriorityQueue(bool (*cgt)(const T& a, const T& b))
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::HeapPriorityQueue(bool (*cgt)(const T& a, const T& b))
 :gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt){
   if(gt==(gtfunc)undefinedgt<T>)
     throw TemplateFunctionError("HeapPriorityQueue::default constructor: neither specified");
   if(tgt!=(gtfunc)undefinedgt<T> && cgt!=(gtfunc)undefinedgt<T> && tgt!=cgt)
     throw TemplateFunctionError("HeapPriorityQueue::default constructor: both specified and different");
-  pq=new T[length];
+  pq=allocate(length);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::HeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b))
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::HeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b))
 :gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt), length(initial_length){
   if(gt==(gtfunc)undefinedgt<T>)
     throw TemplateFunctionError("HeapPriorityQueue::length constructor: neither specified");
@@ -165,54 +229,48 @@ HeapPriorityQueue<T,tgt>::HeapPriorityQueue(int initial_length, bool (*cgt)(cons
     throw TemplateFunctionError("HeapPriorityQueue::length constructor: both specified and different");
   if(length<0)
     length=0;
-  pq=new T[length];
+  pq=allocate(length);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::HeapPriorityQueue(const HeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b))
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::HeapPriorityQueue(const HeapPriorityQueue<T,tgt,ARITY>& to_copy, bool (*cgt)(const T& a, const T& b))
 :gt(tgt!= (gtfunc)undefinedgt<T> ? tgt : cgt), length(to_copy.length), used(to_copy.used){
   if(gt==(gtfunc)undefinedgt<T>)
     gt=to_copy.gt;
   if(tgt!=(gtfunc)undefinedgt<T> && cgt!=(gtfunc)undefinedgt<T> && tgt!=cgt)
     throw TemplateFunctionError("HeapPriorityQueue::copy constructor: both specified and different");
-  pq=new T[length];
+  pq=allocate(length);
   for(int i=0;i<used;++i)
-    pq[i]=to_copy.pq[i];//copy the array
+    new (pq+i) T(to_copy.pq[i]);//copy the array
   if(gt!=to_copy.gt)
     heapify();
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::HeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::HeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
 :gt(tgt!= (gtfunc)undefinedgt<T> ? tgt : cgt), length(il.size()){
   if(gt==(gtfunc)undefinedgt<T>)
     throw TemplateFunctionError("HeapPriorityQueue::initializer_list constructor: neither specified");
   if(tgt!=(gtfunc)undefinedgt<T> && cgt!=(gtfunc)undefinedgt<T> && tgt!=cgt)
     throw TemplateFunctionError("HeapPriorityQueue::initializer_list constructor: both specified and different");
-  pq=new T[length];
-  for(const T& ele : il) {
-    pq[used] = ele;
-    ++used;
-  }
+  pq=allocate(length);
+  append_all(il);
   heapify();
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
 template<class Iterable>
-HeapPriorityQueue<T,tgt>::HeapPriorityQueue(const Iterable& i, bool (*cgt)(const T& a, const T& b))
+HeapPriorityQueue<T,tgt,ARITY>::HeapPriorityQueue(const Iterable& i, bool (*cgt)(const T& a, const T& b))
     :gt(tgt!= (gtfunc)undefinedgt<T> ? tgt : cgt), length(i.size()){
   if(gt==(gtfunc)undefinedgt<T>)
     throw TemplateFunctionError("HeapPriorityQueue::Iterable constructor: neither specified");
   if(tgt!=(gtfunc)undefinedgt<T> && cgt!=(gtfunc)undefinedgt<T> && tgt!=cgt)
     throw TemplateFunctionError("HeapPriorityQueue::Iterable constructor: both specified and different");
-  pq=new T[length];
-  for(const T& ele : i){
-    pq[used]=ele;
-    ++used;
-  }
+  pq=allocate(length);
+  append_all(i);
   heapify();
 }
 
@@ -221,37 +279,40 @@ HeapPriorityQueue<T,tgt>::HeapPriorityQueue(const Iterable& i, bool (*cgt)(const
 //
 //Queries
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::empty() const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::empty() const {
   return used==0;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-int HeapPriorityQueue<T,tgt>::size() const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+int HeapPriorityQueue<T,tgt,ARITY>::size() const {
   return used;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-T& HeapPriorityQueue<T,tgt>::peek () const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+T& HeapPriorityQueue<T,tgt,ARITY>::peek () const {
   if(empty())
     throw EmptyError("HeapPriorityQueue::peek");
   return pq[0];
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-std::string HeapPriorityQueue<T,tgt>::str() const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::partial_sorted (int k) const -> PartialSorted {
+  return PartialSorted(const_cast<HeapPriorityQueue<T,tgt,ARITY>*>(this), k);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+std::string HeapPriorityQueue<T,tgt,ARITY>::str() const {
   std::ostringstream answer;
   answer<<"heap_priority_queue[";
-  if(length!=0){
-    answer<<"0:"<<pq[0];
-    for(int i=1;i<length;++i) {
-      if(this->in_heap(i))
-        answer << "," << i << ":" << pq[i];
-      else answer << "," << i << ":" << "";
-    }
+  for(int i=0;i<length;++i) {
+    answer << (i==0 ? "" : ",") << i << ":";
+    if(this->in_heap(i))
+      answer << pq[i];
   }
   answer<<"](length="<<length<<",used="<<used<<",mod_count="<<mod_count<<")";
   return answer.str();
@@ -262,41 +323,52 @@ std::string HeapPriorityQueue<T,tgt>::str() const {
 //
 //Commands
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-int HeapPriorityQueue<T,tgt>::enqueue(const T& element) {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+int HeapPriorityQueue<T,tgt,ARITY>::enqueue(const T& element) {
   this->ensure_length(used+1);
-  pq[used++]=element;
+  new (pq+used++) T(element);
   percolate_up(used-1);
   ++mod_count;
   return 1;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-T HeapPriorityQueue<T,tgt>::dequeue() {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+T HeapPriorityQueue<T,tgt,ARITY>::dequeue() {
   if(this->empty())
     throw EmptyError("HeapPriorityQueue::dequeue");
-  T to_return=pq[0];
-  pq[0]=pq[--used];
+  T to_return=std::move(pq[0]);
+  if(--used>0)
+    pq[0]=std::move(pq[used]);
+  pq[used].~T();
   this->percolate_down(0);
   ++mod_count;
   return to_return;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-void HeapPriorityQueue<T,tgt>::clear() {
-  used=0;
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::clear() {
+  destroy_all();
   ++mod_count;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
+//Appends all the values first, then restores the heap ordering property in one pass (see
+//  restore_heap), rather than percolating up each value as it is enqueued
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
 template <class Iterable>
-int HeapPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
-  int count=0;
-  for(const T& ele : i)
-    count+=enqueue(ele);
+int HeapPriorityQueue<T,tgt,ARITY>::enqueue_all (const Iterable& i) {
+  if((const void*)&i == (const void*)this){   //Appending to pq while iterating over it
+    HeapPriorityQueue<T,tgt,ARITY> copy(*this);
+    return enqueue_all(copy);
+  }
+  int old_used=used;
+  int count=append_all(i);
+  if(count==0)
+    return 0;
+  restore_heap(old_used);
+  ++mod_count;
   return count;
 }
 
@@ -305,57 +377,51 @@ int HeapPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
 //
 //Operators
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>& HeapPriorityQueue<T,tgt>::operator = (const HeapPriorityQueue<T,tgt>& rhs) {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>& HeapPriorityQueue<T,tgt,ARITY>::operator = (const HeapPriorityQueue<T,tgt,ARITY>& rhs) {
   if(this==&rhs)
     return *this;
   gt=rhs.gt;
-  this->ensure_length(rhs.length);
-  used=rhs.used;
-  for(int i=0;i<used;++i)
-    pq[i]=rhs.pq[i];
+  destroy_all();
+  this->ensure_length(rhs.used);
+  for(/*used==0*/; used<rhs.used; ++used)
+    new (pq+used) T(rhs.pq[used]);
   ++mod_count;
   return *this;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::operator == (const HeapPriorityQueue<T,tgt>& rhs) const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::operator == (const HeapPriorityQueue<T,tgt,ARITY>& rhs) const {
   if(this==&rhs)
     return true;
   if(gt!=rhs.gt)
     return false;
   if(used!=rhs.size())
     return false;
-  HeapPriorityQueue<T,tgt> lhs_copy=*this;
-  HeapPriorityQueue<T,tgt> rhs_copy=rhs;
-  for(int i=0;i<used;++i) {
-    T lhs_return=lhs_copy.dequeue();
-    T rhs_return=rhs_copy.dequeue();
-    if (lhs_return != rhs_return)
+  for(Iterator l=begin(), r=rhs.begin(); l!=end(); ++l, ++r)
+    if(*l != *r)
       return false;
-  }
   return true;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::operator != (const HeapPriorityQueue<T,tgt>& rhs) const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::operator != (const HeapPriorityQueue<T,tgt,ARITY>& rhs) const {
   return !(*this==rhs);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T,tgt>& p) {
-  HeapPriorityQueue<T,tgt> p_copy=p;
-  ArrayStack<T> temp;
-  for(int i=0; i<p.used; ++i)
-    temp.push(p_copy.dequeue());
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T,tgt,ARITY>& p) {
+  ArrayStack<const T*> temp;                    //Pointers into p: print highest last, copying no values
+  for(const T& v : p)
+    temp.push(&v);
   outs<<"priority_queue[";
   if(!temp.empty()){
-    outs<<temp.pop();
+    outs<<*temp.pop();
     while(!temp.empty())
-      outs<<","<<temp.pop();
+      outs<<","<<*temp.pop();
   }
   outs<<"]:highest";
   return outs;
@@ -366,15 +432,37 @@ std::ostream& operator << (std::ostream& outs, const HeapPriorityQueue<T,tgt>& p
 //
 //Iterator constructors
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-auto HeapPriorityQueue<T,tgt>::begin () const -> HeapPriorityQueue<T,tgt>::Iterator {
-  return Iterator(const_cast<HeapPriorityQueue<T,tgt>*>(this), false);
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::begin () const -> HeapPriorityQueue<T,tgt,ARITY>::Iterator {
+  return Iterator(const_cast<HeapPriorityQueue<T,tgt,ARITY>*>(this), used);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-auto HeapPriorityQueue<T,tgt>::end () const -> HeapPriorityQueue<T,tgt>::Iterator {
-  return Iterator(const_cast<HeapPriorityQueue<T,tgt>*>(this));
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::end () const -> HeapPriorityQueue<T,tgt,ARITY>::Iterator {
+  return Iterator(const_cast<HeapPriorityQueue<T,tgt,ARITY>*>(this), 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//PartialSorted definitions
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::PartialSorted::PartialSorted(HeapPriorityQueue<T,tgt,ARITY>* ref_pq, int k)
+: ref_pq(ref_pq), k(k)
+{}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::PartialSorted::begin () const -> Iterator {
+  return ref_pq->begin();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::PartialSorted::end () const -> Iterator {
+  return Iterator(ref_pq, ref_pq->used - std::max(0, std::min(k, ref_pq->used)));
 }
 
 
@@ -382,85 +470,128 @@ auto HeapPriorityQueue<T,tgt>::end () const -> HeapPriorityQueue<T,tgt>::Iterato
 //
 //Private helper methods
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-void HeapPriorityQueue<T,tgt>::ensure_length(int new_length) {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+T* HeapPriorityQueue<T,tgt,ARITY>::allocate(int length) {
+  return length==0 ? nullptr : static_cast<T*>(::operator new(length*sizeof(T)));
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::deallocate(T* storage) {
+  ::operator delete(storage);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::destroy_all() {
+  for(int i=0; i<used; ++i)
+    pq[i].~T();
+  used=0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::ensure_length(int new_length) {
   if(length>=new_length)
     return;
   T* pq_old=pq;
   length=std::max(new_length, 2*length);
-  pq=new T[length];
-  for(int i=0; i<used;++i)
-    pq[i]=pq_old[i];
-  delete [] pq_old;
+  pq=allocate(length);
+  for(int i=0; i<used;++i){
+    new (pq+i) T(std::move(pq_old[i]));
+    pq_old[i].~T();
+  }
+  deallocate(pq_old);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-int HeapPriorityQueue<T,tgt>::left_child(int i) const
-{return 2*i+1;}
-
-template<class T, bool (*tgt)(const T& a, const T& b)>
-int HeapPriorityQueue<T,tgt>::right_child(int i) const
-{return 2*i+2;}
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+int HeapPriorityQueue<T,tgt,ARITY>::first_child(int i) const
+{return ARITY*i+1;}
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-int HeapPriorityQueue<T,tgt>::parent(int i) const
-{return (i-1)/2;}
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+int HeapPriorityQueue<T,tgt,ARITY>::parent(int i) const
+{return (i-1)/ARITY;}
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::is_root(int i) const
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::is_root(int i) const
 {return i==0;}
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::in_heap(int i) const
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::in_heap(int i) const
 {return i>=0 and i<=used-1;}
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-void HeapPriorityQueue<T,tgt>::percolate_up(int i) {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::percolate_up(int i) {
   if(!in_heap(i))
     return;
-  for(int j=i;j>=0;j=parent(j)){
-    if(is_root(j))
-      return;
-    if(gt(pq[j],pq[parent(j)]))//if(pq[j] > pq[parent(j)])
-      std::swap(pq[j],pq[parent(j)]);
-    else
-      return;
-  }
+  T moving=std::move(pq[i]);
+  for(/*parameter*/; !is_root(i) && gt(moving,pq[parent(i)]); i=parent(i))
+    pq[i]=std::move(pq[parent(i)]);
+  pq[i]=std::move(moving);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-void HeapPriorityQueue<T,tgt>::percolate_down(int i) {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::percolate_down(int i) {
   if(!in_heap(i))
     return;
-  for(int j=i;j<used;++j){
-    if(!in_heap(left_child(j)))
-      return;
-    else if(!in_heap(right_child(j))) {
-      if (!gt(pq[j],pq[left_child(j)])) {
-        std::swap(pq[j], pq[left_child(j)]);
-        j = left_child(j) - 1;
-      }
-    }
-    else if(! gt(pq[j],pq[left_child(j)]) || ! gt(pq[j], pq[right_child(j)])){
-      if(gt(pq[left_child(j)],pq[right_child(j)])){
-        std::swap(pq[j], pq[left_child(j)]);
-        j = left_child(j) - 1;
-      }else{
-        std::swap(pq[j], pq[right_child(j)]);
-        j = right_child(j) - 1;
-      }
-    }else return;
+  T moving=std::move(pq[i]);
+  for(int c=first_child(i); in_heap(c); c=first_child(i)){
+    int max_child=c;
+    for(int last=std::min(c+ARITY,used), j=c+1; j<last; ++j)
+      if(gt(pq[j],pq[max_child]))
+        max_child=j;
+    if(!gt(pq[max_child],moving))
+      break;
+    pq[i]=std::move(pq[max_child]);
+    i=max_child;
   }
+  pq[i]=std::move(moving);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-void HeapPriorityQueue<T,tgt>::heapify() {
-for (int i = used-1; i >= 0; --i)
-  percolate_down(i);
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::heapify() {
+  restore_heap(0);
+}
+
+
+//A few values (relative to the heap's size) are each percolated up: for random values this
+//  is O(1) per value, since most values belong near the bottom of the heap.
+//Otherwise heapify (Floyd's method) just the subtrees that contain new values, bottom up: the
+//  parents of pq[first_new..used-1] are a range of indexes, whose parents are a range, ... up to
+//  the root; every other subtree is unchanged, so it is still a heap. Appending N values to an
+//  empty heap is O(N), not the O(N log N) of enqueueing them one at a time.
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::restore_heap(int first_new) {
+  if(first_new>=used)
+    return;
+  if(used-first_new <= first_new/RESTORE_BY_PERCOLATING_UP){
+    for(int i=first_new; i<used; ++i)
+      percolate_up(i);
+    return;
+  }
+  for(int low=first_new, high=used-1; !is_root(high); /*see body*/){
+    low =parent(low);
+    high=parent(high);
+    for(int i=high; i>=low; --i)
+      percolate_down(i);
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+template <class Iterable>
+int HeapPriorityQueue<T,tgt,ARITY>::append_all (const Iterable& i) {
+  int count=0;
+  for(const T& ele : i){
+    this->ensure_length(used+1);
+    new (pq+used++) T(ele);
+    ++count;
+  }
+  return count;
 }
 
 
@@ -468,85 +599,136 @@ for (int i = used-1; i >= 0; --i)
 //
 //Iterator class definitions
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::Iterator::Iterator(HeapPriorityQueue<T,tgt>* iterate_over, bool tgt_nullptr)
-:it(*iterate_over),ref_pq(iterate_over),expected_mod_count(ref_pq->mod_count){
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::Iterator::Iterator(HeapPriorityQueue<T,tgt,ARITY>* iterate_over, int remaining)
+: ref_pq(iterate_over), remaining(remaining), expected_mod_count(iterate_over->mod_count) {
+  frontier_length = std::max(1,std::min(remaining, 1+ARITY));
+  frontier = new int[frontier_length];
+  if (remaining > 0 && remaining == ref_pq->used)      //Nothing visited yet
+    frontier_add(0);
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::Iterator::Iterator(HeapPriorityQueue<T,tgt>* iterate_over)
-  :ref_pq(iterate_over),expected_mod_count(ref_pq->mod_count){}
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::Iterator::Iterator(const Iterator& to_copy)
+: ref_pq(to_copy.ref_pq), frontier_length(to_copy.frontier_length), frontier_used(to_copy.frontier_used),
+  remaining(to_copy.remaining), expected_mod_count(to_copy.expected_mod_count), can_erase(to_copy.can_erase) {
+  frontier = new int[frontier_length];
+  for (int f=0; f<frontier_used; ++f)
+    frontier[f] = to_copy.frontier[f];
+}
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-HeapPriorityQueue<T,tgt>::Iterator::~Iterator()
-{}
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator = (const Iterator& rhs) -> Iterator& {
+  if (this == &rhs)
+    return *this;
+  if (frontier_length < rhs.frontier_used) {
+    delete [] frontier;
+    frontier_length = rhs.frontier_length;
+    frontier = new int[frontier_length];
+  }
+  for (int f=0; f<rhs.frontier_used; ++f)
+    frontier[f] = rhs.frontier[f];
+  ref_pq             = rhs.ref_pq;
+  frontier_used      = rhs.frontier_used;
+  remaining          = rhs.remaining;
+  expected_mod_count = rhs.expected_mod_count;
+  can_erase          = rhs.can_erase;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+HeapPriorityQueue<T,tgt,ARITY>::Iterator::~Iterator()
+{delete [] frontier;}
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-T HeapPriorityQueue<T,tgt>::Iterator::erase() {
+//The erased value is replaced by ref_pq's last value (as in dequeue), which is restored to heap
+//  order by percolating it one way, in ref_pq's array: down (into the unvisited subtree now rooted
+//  where the erased value was) if it was not yet visited; up (among visited ancestors) if it was,
+//  in which case the erased value's place is visited and its children join the frontier.
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+T HeapPriorityQueue<T,tgt,ARITY>::Iterator::erase() {
   if (expected_mod_count != ref_pq->mod_count)
     throw ConcurrentModificationError("HeapPriorityQueue::Iterator::erase");
   if (!can_erase)
     throw CannotEraseError("HeapPriorityQueue::Iterator::erase Iterator cursor already erased");
-  if(it.empty())
+  if (remaining == 0)
     throw CannotEraseError("HeapPriorityQueue::Iterator::erase Iterator cursor beyond data structure");
 
-  can_erase=false;
-  T to_erase=it.dequeue();
-  int index=0;
-  for(int i=0;i<ref_pq->used;++i)
-    if(to_erase==ref_pq->pq[i])
-      index=i;
-  ref_pq->pq[index]=ref_pq->pq[ref_pq->used-1];
-  for(int i=ref_pq->used-2;i>index;--i)
-    ref_pq->percolate_up(i);
-  ref_pq->used--;
+  can_erase = false;
+  --remaining;
+  int index = frontier_remove(0);
+  T to_erase = std::move(ref_pq->pq[index]);
+  int last = --ref_pq->used;
+
+  if (index != last) {
+    bool last_visited = visited(last, index);
+    for (int f=0; f<frontier_used; ++f)
+      if (frontier[f] == last) {
+        frontier_remove(f);
+        break;
+      }
+    ref_pq->pq[index] = std::move(ref_pq->pq[last]);
+    ref_pq->pq[last].~T();
+    if (last_visited) {
+      ref_pq->percolate_up(index);
+      for (int c=ref_pq->first_child(index), j=0; j<ARITY && ref_pq->in_heap(c+j); ++j)
+        frontier_add(c+j);
+    }else{
+      ref_pq->percolate_down(index);
+      frontier_add(index);
+    }
+  }else
+    ref_pq->pq[last].~T();
   expected_mod_count = ++ref_pq->mod_count;
   return to_erase;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-std::string HeapPriorityQueue<T,tgt>::Iterator::str() const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+std::string HeapPriorityQueue<T,tgt,ARITY>::Iterator::str() const {
   std::ostringstream answer;
-  answer << ref_pq->str() << "/it=" << it << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  answer << ref_pq->str() << "/frontier=[";
+  for (int f=0; f<frontier_used; ++f)
+    answer << (f == 0 ? "" : ",") << frontier[f];
+  answer << "]/remaining=" << remaining << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
   return answer.str();
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-auto HeapPriorityQueue<T,tgt>::Iterator::operator ++ () -> HeapPriorityQueue<T,tgt>::Iterator& {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator ++ () -> HeapPriorityQueue<T,tgt,ARITY>::Iterator& {
   if (expected_mod_count != ref_pq->mod_count)
     throw ConcurrentModificationError("HeapPriorityQueue::Iterator::operator ++");
-  if (it.used==0)
+  if (remaining == 0)
     return *this;
-  if (can_erase)
-    it.dequeue();
-  else
+  if (can_erase) {
+    int index = frontier_remove(0);
+    for (int c=ref_pq->first_child(index), j=0; j<ARITY && ref_pq->in_heap(c+j); ++j)
+      frontier_add(c+j);
+    --remaining;
+  }else
     can_erase = true;
   return *this;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-auto HeapPriorityQueue<T,tgt>::Iterator::operator ++ (int) -> HeapPriorityQueue<T,tgt>::Iterator {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+auto HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator ++ (int) -> HeapPriorityQueue<T,tgt,ARITY>::Iterator {
   if (expected_mod_count != ref_pq->mod_count)
     throw ConcurrentModificationError("HeapPriorityQueue::Iterator::operator ++");
-  if (it.empty())
+  if (remaining == 0)
     return *this;
   Iterator to_return(*this);
-  if (can_erase)
-    it.dequeue();
-  else
-    can_erase = true;
+  ++(*this);
   return to_return;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::Iterator::operator == (const HeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator == (const HeapPriorityQueue<T,tgt,ARITY>::Iterator& rhs) const {
   const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
   if (rhsASI == 0)
     throw IteratorTypeError("HeapPriorityQueue::Iterator::operator ==");
@@ -555,12 +737,12 @@ bool HeapPriorityQueue<T,tgt>::Iterator::operator == (const HeapPriorityQueue<T,
   if (ref_pq != rhsASI->ref_pq)
     throw ComparingDifferentIteratorsError("HeapPriorityQueue::Iterator::operator ==");
 
-  return it==rhs.it;
+  return remaining == rhsASI->remaining;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-bool HeapPriorityQueue<T,tgt>::Iterator::operator != (const HeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator != (const HeapPriorityQueue<T,tgt,ARITY>::Iterator& rhs) const {
   const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
   if (rhsASI == 0)
     throw IteratorTypeError("HeapPriorityQueue::Iterator::operator !=");
@@ -569,36 +751,114 @@ bool HeapPriorityQueue<T,tgt>::Iterator::operator != (const HeapPriorityQueue<T,
   if (ref_pq != rhsASI->ref_pq)
     throw ComparingDifferentIteratorsError("HeapPriorityQueue::Iterator::operator !=");
 
-  return it!=rhs.it;
+  return remaining != rhsASI->remaining;
 }
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-T& HeapPriorityQueue<T,tgt>::Iterator::operator *() const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+T& HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator *() const {
   if (expected_mod_count !=  ref_pq->mod_count)
     throw ConcurrentModificationError("HeapPriorityQueue::Iterator::operator ->");
-  if (!can_erase || it.empty()) {
+  if (!can_erase || remaining == 0) {
     std::ostringstream where;
-    where << it << " when size = " << ref_pq->size();
+    where << remaining << " remaining when size = " << ref_pq->size();
     throw IteratorPositionIllegal("HeapPriorityQueue::Iterator::operator -> Iterator illegal: "+where.str());
   }
 
-  return it.peek();
+  return ref_pq->pq[frontier[0]];
 }
 
 
 
-template<class T, bool (*tgt)(const T& a, const T& b)>
-T* HeapPriorityQueue<T,tgt>::Iterator::operator ->() const {
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+T* HeapPriorityQueue<T,tgt,ARITY>::Iterator::operator ->() const {
   if (expected_mod_count !=  ref_pq->mod_count)
     throw ConcurrentModificationError("HeapPriorityQueue::Iterator::operator ->");
-  if (!can_erase || it.empty()) {
+  if (!can_erase || remaining == 0) {
     std::ostringstream where;
-    where << it << " when size = " << ref_pq->size();
+    where << remaining << " remaining when size = " << ref_pq->size();
     throw IteratorPositionIllegal("HeapPriorityQueue::Iterator::operator -> Iterator illegal: "+where.str());
   }
 
-  return &it.peek();
+  return &ref_pq->pq[frontier[0]];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator private helper methods
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::Iterator::frontier_gt(int f1, int f2) const
+{return ref_pq->gt(ref_pq->pq[frontier[f1]], ref_pq->pq[frontier[f2]]);}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::Iterator::frontier_up(int f) {
+  for (/*parameter*/; f > 0 && frontier_gt(f,(f-1)/2); f=(f-1)/2)
+    std::swap(frontier[f],frontier[(f-1)/2]);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::Iterator::frontier_down(int f) {
+  for (int c=2*f+1; c < frontier_used; c=2*f+1) {
+    if (c+1 < frontier_used && frontier_gt(c+1,c))
+      ++c;
+    if (!frontier_gt(c,f))
+      break;
+    std::swap(frontier[f],frontier[c]);
+    f = c;
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+void HeapPriorityQueue<T,tgt,ARITY>::Iterator::frontier_add(int i) {
+  if (frontier_used == frontier_length) {
+    int* frontier_old = frontier;
+    frontier_length *= 2;
+    frontier = new int[frontier_length];
+    for (int f=0; f<frontier_used; ++f)
+      frontier[f] = frontier_old[f];
+    delete [] frontier_old;
+  }
+  frontier[frontier_used] = i;
+  frontier_up(frontier_used++);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+int HeapPriorityQueue<T,tgt,ARITY>::Iterator::frontier_remove(int f) {
+  int answer = frontier[f];
+  frontier[f] = frontier[--frontier_used];
+  if (f < frontier_used) {
+    frontier_up(f);
+    frontier_down(f);
+  }
+  return answer;
+}
+
+
+//Index i has been visited unless it, or one of its ancestors, is current or in the frontier (the
+//  frontier's indexes are the roots of the unvisited subtrees). The ancestors are found first, so
+//  the frontier is scanned once.
+template<class T, bool (*tgt)(const T& a, const T& b), int ARITY>
+bool HeapPriorityQueue<T,tgt,ARITY>::Iterator::visited(int i, int current) const {
+  int ancestors[8*sizeof(int)];         //Depth of a heap with ARITY >= 2 is less than #bits in an int
+  int depth = 0;
+  for (/*parameter*/; ; i=ref_pq->parent(i)) {
+    if (i == current)
+      return false;
+    ancestors[depth++] = i;
+    if (ref_pq->is_root(i))
+      break;
+  }
+  for (int f=0; f<frontier_used; ++f)
+    for (int a=0; a<depth && ancestors[a] >= frontier[f]; ++a)
+      if (ancestors[a] == frontier[f])
+        return false;
+  return true;
 }
 
 }
@@ -0,0 +1,800 @@
+#ifndef MIN_MAX_HEAP_PRIORITY_QUEUE_HPP_
+#define MIN_MAX_HEAP_PRIORITY_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include "ics_exceptions.hpp"
+#include <utility>              //For std::swap function
+#include <algorithm>            //For std::max
+#include "array_stack.hpp"      //See operator <<
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+//A double-ended priority queue: a min-max heap, whose levels alternate between max levels (the root's
+//  level, and every other level below it) and min levels. A value on a max level has priority >= all
+//  values below it; one on a min level has priority <= all values below it. So the highest-priority
+//  value is at the root and the lowest-priority value is one of its (at most 2) children: peek_max/
+//  peek_min are O(1), and enqueue/dequeue_max/dequeue_min are O(log N) (they percolate through
+//  grandparents/grandchildren: only levels of the same kind).
+//peek/dequeue are the same as peek_max/dequeue_max, as in HeapPriorityQueue.
+//
+//bounded(capacity) makes it keep at most capacity values: enqueueing into a full queue evicts the
+//  lowest-priority value if the new value has higher priority, and otherwise rejects the new value
+//  (enqueue returns 0). So it keeps the capacity highest-priority values of a stream.
+//
+//As in IndexedHeapPriorityQueue, each value stays where it is stored (in values[slot]) and the heap
+//  stores ints (slots): percolating moves ints, not Ts, and the Iterator copies only the heap of ints.
+//
+//Instantiate the templated class supplying tgt(a,b): true, iff a has higher priority than b.
+//If tgt is defaulted to undefinedgt in the template, then a constructor must supply cgt.
+//If both tgt and cgt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class MinMaxHeapPriorityQueue {
+  public:
+    typedef bool (*gtfunc) (const T& a, const T& b);
+
+    //Destructor/Constructors
+    ~MinMaxHeapPriorityQueue();
+
+    MinMaxHeapPriorityQueue(bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit MinMaxHeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    MinMaxHeapPriorityQueue(const MinMaxHeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit MinMaxHeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit MinMaxHeapPriorityQueue (const Iterable& i, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+
+    //Queries
+    bool     empty    () const;
+    int      size     () const;
+    int      capacity () const;              //-1 if not bounded
+    const T& peek     () const;              //Same as peek_max
+    const T& peek_max () const;              //Highest-priority value
+    const T& peek_min () const;              //Lowest-priority value
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    int  enqueue     (const T& element);     //Returns 0 if bounded and element is rejected, else 1
+    T    dequeue     ();                     //Same as dequeue_max
+    T    dequeue_max ();
+    T    dequeue_min ();
+    void clear       ();
+    void bounded     (int capacity);         //Evicts lowest-priority values if size() > capacity
+    void unbounded   ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    MinMaxHeapPriorityQueue<T,tgt>& operator = (const MinMaxHeapPriorityQueue<T,tgt>& rhs);
+    bool operator == (const MinMaxHeapPriorityQueue<T,tgt>& rhs) const;
+    bool operator != (const MinMaxHeapPriorityQueue<T,tgt>& rhs) const;
+
+    template<class T2, bool (*gt2)(const T2& a, const T2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const MinMaxHeapPriorityQueue<T2,gt2>& pq);
+
+
+
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of MinMaxHeapPriorityQueue<T,tgt>
+        ~Iterator();
+        Iterator(const Iterator& to_copy);
+        Iterator& operator = (const Iterator& rhs);
+        T           erase();
+        std::string str  () const;
+        MinMaxHeapPriorityQueue<T,tgt>::Iterator& operator ++ ();
+        MinMaxHeapPriorityQueue<T,tgt>::Iterator  operator ++ (int);
+        bool operator == (const MinMaxHeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        bool operator != (const MinMaxHeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        const T& operator *  () const;
+        const T* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const MinMaxHeapPriorityQueue<T,tgt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+
+        friend Iterator MinMaxHeapPriorityQueue<T,tgt>::begin () const;
+        friend Iterator MinMaxHeapPriorityQueue<T,tgt>::end   () const;
+
+      private:
+        //A min-max heap of (a copy of) the slots not yet iterated over; ++ removes its max
+        //If can_erase is false, the value has been removed from "it" (++ does nothing)
+        int*                            it;
+        int                             it_used;
+        MinMaxHeapPriorityQueue<T,tgt>* ref_pq;
+        int                             expected_mod_count;
+        bool                            can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(MinMaxHeapPriorityQueue<T,tgt>* iterate_over, bool from_begin);
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
+    T*   values;                         //values[s] is the value stored in slot s
+    int* heap;                           //Slots, with the min-max heap ordering property (by their values) in heap[0..used-1]
+    int* position;                       //heap[position[s]] == s for every slot s
+    int length    = 0;                   //Physical length of the arrays: must be >= .size()
+    int used      = 0;                   //Amount of heap used: invariant: 0 <= used <= length
+    int bound     = -1;                  //Most values kept (-1 if not bounded)
+    int mod_count = 0;                   //For sensing concurrent modification
+
+
+    //Helper methods
+    void ensure_length  (int new_length);
+    void copy           (const MinMaxHeapPriorityQueue<T,tgt>& to_copy);
+    bool higher         (int s1, int s2) const;               //values[s1] has higher priority than values[s2]
+    int  min_index      () const;                             //Index in heap of the lowest-priority value
+    T    erase_at       (int i);                              //Erase heap[i]'s value; its slot is then unused
+    void heapify        ();
+
+    //Each works in min-max heap a[0..n-1] of slots, updating position pos (if not nullptr): so they
+    //  also serve the Iterator's copy.
+    static bool on_max_level (int i);
+    void swap_at        (int* a, int* pos, int i, int j) const;
+    void percolate_up   (int* a, int* pos, int i) const;          //Through grandparents (same kind of level)
+    void percolate_down (int* a, int n, int* pos, int i) const;   //Through grandchildren (same kind of level)
+    void restore        (int* a, int n, int* pos, int i) const;   //Restore order after a[i] is changed
+  };
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//MinMaxHeapPriorityQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::~MinMaxHeapPriorityQueue() {
+  delete [] values;
+  delete [] heap;
+  delete [] position;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::MinMaxHeapPriorityQueue(bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::default constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::default constructor: both specified and different");
+
+  values   = new T[length];
+  heap     = new int[length];
+  position = new int[length];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::MinMaxHeapPriorityQueue(int initial_length, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::length constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::length constructor: both specified and different");
+
+  values   = new T[0];
+  heap     = new int[0];
+  position = new int[0];
+  ensure_length(initial_length);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::MinMaxHeapPriorityQueue(const MinMaxHeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    gt = to_copy.gt;
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::copy constructor: both specified and different");
+
+  copy(to_copy);
+  if (gt != to_copy.gt)
+    heapify();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::MinMaxHeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::initializer_list constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::initializer_list constructor: both specified and different");
+
+  values   = new T[0];
+  heap     = new int[0];
+  position = new int[0];
+  ensure_length(il.size());
+  for (const T& pq_elem : il)
+    values[used++] = pq_elem;  //slot s (at heap[s]) stores values[s]
+  heapify();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+MinMaxHeapPriorityQueue<T,tgt>::MinMaxHeapPriorityQueue(const Iterable& i, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::Iterable constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("MinMaxHeapPriorityQueue::Iterable constructor: both specified and different");
+
+  values   = new T[0];
+  heap     = new int[0];
+  position = new int[0];
+  ensure_length(i.size());
+  for (const T& pq_elem : i)
+    values[used++] = pq_elem;
+  heapify();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MinMaxHeapPriorityQueue<T,tgt>::size() const {
+  return used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MinMaxHeapPriorityQueue<T,tgt>::capacity() const {
+  return bound;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& MinMaxHeapPriorityQueue<T,tgt>::peek () const {
+  if (empty())
+    throw EmptyError("MinMaxHeapPriorityQueue::peek");
+
+  return values[heap[0]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& MinMaxHeapPriorityQueue<T,tgt>::peek_max () const {
+  if (empty())
+    throw EmptyError("MinMaxHeapPriorityQueue::peek_max");
+
+  return values[heap[0]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& MinMaxHeapPriorityQueue<T,tgt>::peek_min () const {
+  if (empty())
+    throw EmptyError("MinMaxHeapPriorityQueue::peek_min");
+
+  return values[heap[min_index()]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string MinMaxHeapPriorityQueue<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "MinMaxHeapPriorityQueue[";
+
+  for (int i = 0; i < used; ++i)
+    answer << (i == 0 ? "" : ",") << i << ":" << heap[i] << "->" << values[heap[i]];
+
+  answer << "](length=" << length << ",used=" << used << ",bound=" << bound << ",mod_count=" << mod_count << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MinMaxHeapPriorityQueue<T,tgt>::enqueue(const T& element) {
+  if (used == bound) {
+    if (used == 0 || !gt(element,values[heap[min_index()]]))
+      return 0;
+    erase_at(min_index());
+  }
+
+  this->ensure_length(used+1);
+  values[heap[used]] = element;
+  restore(heap,used+1,position,used);
+  ++used;
+  ++mod_count;
+  return 1;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T MinMaxHeapPriorityQueue<T,tgt>::dequeue() {
+  if (this->empty())
+    throw EmptyError("MinMaxHeapPriorityQueue::dequeue");
+
+  return erase_at(0);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T MinMaxHeapPriorityQueue<T,tgt>::dequeue_max() {
+  if (this->empty())
+    throw EmptyError("MinMaxHeapPriorityQueue::dequeue_max");
+
+  return erase_at(0);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T MinMaxHeapPriorityQueue<T,tgt>::dequeue_min() {
+  if (this->empty())
+    throw EmptyError("MinMaxHeapPriorityQueue::dequeue_min");
+
+  return erase_at(min_index());
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::clear() {
+  used = 0;
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::bounded(int capacity) {
+  if (capacity < 0) {
+    std::ostringstream answer;
+    answer << "MinMaxHeapPriorityQueue::bounded: capacity(" << capacity << ") < 0";
+    throw IcsError(answer.str());
+  }
+  bound = capacity;
+  while (used > bound)
+    erase_at(min_index());
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::unbounded() {
+  bound = -1;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template <class Iterable>
+int MinMaxHeapPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>& MinMaxHeapPriorityQueue<T,tgt>::operator = (const MinMaxHeapPriorityQueue<T,tgt>& rhs) {
+  if (this == &rhs)
+    return *this;
+
+  gt = rhs.gt;   // if tgt != nullptr, gts are already equal (or compiler error)
+  delete [] values;
+  delete [] heap;
+  delete [] position;
+  copy(rhs);
+
+  ++mod_count;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::operator == (const MinMaxHeapPriorityQueue<T,tgt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (gt != rhs.gt) //For PriorityQueues to be equal, they need the same gt function, and values
+    return false;
+  if (used != rhs.size())
+    return false;
+  MinMaxHeapPriorityQueue<T,tgt>::Iterator l = this->begin(), r = rhs.begin();
+  for (int i=0; i<used; ++i, ++l, ++r)
+    if (*l != *r)
+      return false;
+
+  return true;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::operator != (const MinMaxHeapPriorityQueue<T,tgt>& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::ostream& operator << (std::ostream& outs, const MinMaxHeapPriorityQueue<T,tgt>& p) {
+  ArrayStack<const T*> temp;                    //Pointers into p: print highest last, copying no values
+  for (const T& v : p)
+    temp.push(&v);
+  outs << "priority_queue[";
+  if (!temp.empty()) {
+    outs << *temp.pop();
+    while (!temp.empty())
+      outs << "," << *temp.pop();
+  }
+  outs << "]:highest";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto MinMaxHeapPriorityQueue<T,tgt>::begin () const -> MinMaxHeapPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<MinMaxHeapPriorityQueue<T,tgt>*>(this),true);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto MinMaxHeapPriorityQueue<T,tgt>::end () const -> MinMaxHeapPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<MinMaxHeapPriorityQueue<T,tgt>*>(this),false);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//New slots (length..new_length-1) are put beyond the heap, as unused
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::ensure_length(int new_length) {
+  if (length >= new_length)
+    return;
+  T*   old_values   = values;
+  int* old_heap     = heap;
+  int* old_position = position;
+  int  old_length   = length;
+  length = std::max(new_length,2*length);
+  values   = new T[length];
+  heap     = new int[length];
+  position = new int[length];
+  for (int i=0; i<old_length; ++i) {
+    values[i]   = old_values[i];
+    heap[i]     = old_heap[i];
+    position[i] = old_position[i];
+  }
+  for (int s=old_length; s<length; ++s)
+    heap[s] = position[s] = s;
+
+  delete [] old_values;
+  delete [] old_heap;
+  delete [] old_position;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::copy(const MinMaxHeapPriorityQueue<T,tgt>& to_copy) {
+  length   = to_copy.length;
+  used     = to_copy.used;
+  bound    = to_copy.bound;
+  values   = new T[length];
+  heap     = new int[length];
+  position = new int[length];
+  for (int i=0; i<length; ++i) {
+    heap[i]     = to_copy.heap[i];
+    position[i] = to_copy.position[i];
+  }
+  for (int i=0; i<used; ++i)
+    values[heap[i]] = to_copy.values[heap[i]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::higher(int s1, int s2) const {
+  return gt(values[s1],values[s2]);
+}
+
+
+//The lowest-priority value is on the first min level (or is the root, if it is alone)
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MinMaxHeapPriorityQueue<T,tgt>::min_index() const {
+  if (used <= 2)
+    return used-1;
+  return higher(heap[2],heap[1]) ? 1 : 2;
+}
+
+
+//Move the last slot into the erased one's place in the heap and restore it; the erased slot goes
+//  just beyond the heap, becoming the next one enqueue uses
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T MinMaxHeapPriorityQueue<T,tgt>::erase_at(int i) {
+  int slot = heap[i];
+  T to_return = values[slot];
+  int last = heap[--used];
+  heap[used] = slot;
+  position[slot] = used;
+  if (i != used) {
+    heap[i] = last;
+    position[last] = i;
+    restore(heap,used,position,i);
+  }
+
+  ++mod_count;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::heapify() {
+  for (int i = used/2-1; i >= 0; --i)
+    percolate_down(heap,used,position,i);
+}
+
+
+//Levels 0, 2, 4, ... (the root's level first) are max levels
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::on_max_level(int i) {
+  int level = 0;
+  for (++i; i > 1; i >>= 1)
+    ++level;
+  return level%2 == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::swap_at(int* a, int* pos, int i, int j) const {
+  std::swap(a[i],a[j]);
+  if (pos != nullptr) {
+    pos[a[i]] = i;
+    pos[a[j]] = j;
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::percolate_up(int* a, int* pos, int i) const {
+  bool max_level = on_max_level(i);
+  for (int g = (i-3)/4; i >= 3 && (max_level ? higher(a[i],a[g]) : higher(a[g],a[i])); i = g, g = (i-3)/4)
+    swap_at(a,pos,i,g);
+}
+
+
+//On a max level, swap with the highest-priority child/grandchild if it has higher priority; a value
+//  swapped down to a grandchild may then belong on the min level above it (swap with its parent).
+//  On a min level, the same with "lowest" and "lower".
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::percolate_down(int* a, int n, int* pos, int i) const {
+  bool max_level = on_max_level(i);
+  for (int c = 2*i+1; c < n; c = 2*i+1) {
+    int m = c;
+    if (c+1 < n && (max_level ? higher(a[c+1],a[m]) : higher(a[m],a[c+1])))
+      m = c+1;
+    for (int g = 2*c+1; g <= 2*c+4 && g < n; ++g)
+      if (max_level ? higher(a[g],a[m]) : higher(a[m],a[g]))
+        m = g;
+    if (!(max_level ? higher(a[m],a[i]) : higher(a[i],a[m])))
+      return;
+    swap_at(a,pos,i,m);
+    if (m <= c+1)                          //A child: nothing below it can be out of order
+      return;
+    int p = (m-1)/2;
+    if (max_level ? higher(a[p],a[m]) : higher(a[m],a[p]))
+      swap_at(a,pos,m,p);
+    i = m;
+  }
+}
+
+
+//a[i] may be out of order with its parent (a level of the other kind), with its grandparent, or
+//  with the values below it, but not with both its ancestors and descendants: e.g., on a max level,
+//  if a[i] has lower priority than its parent, it belongs on a min level above; the parent's value
+//  (lower than everything below i) must then percolate down from i.
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MinMaxHeapPriorityQueue<T,tgt>::restore(int* a, int n, int* pos, int i) const {
+  int p = (i-1)/2;
+  bool max_level = on_max_level(i);
+  if (i > 0 && (max_level ? higher(a[p],a[i]) : higher(a[i],a[p]))) {
+    swap_at(a,pos,i,p);
+    percolate_up(a,pos,p);
+    percolate_down(a,n,pos,i);
+  }else if (i >= 3 && (max_level ? higher(a[i],a[(i-3)/4]) : higher(a[(i-3)/4],a[i])))
+    percolate_up(a,pos,i);
+  else
+    percolate_down(a,n,pos,i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::Iterator::Iterator(MinMaxHeapPriorityQueue<T,tgt>* iterate_over, bool from_begin)
+: it_used(from_begin ? iterate_over->used : 0), ref_pq(iterate_over), expected_mod_count(iterate_over->mod_count) {
+  it = new int[it_used];
+  for (int i=0; i<it_used; ++i)
+    it[i] = ref_pq->heap[i];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::Iterator::Iterator(const Iterator& to_copy)
+: it_used(to_copy.it_used), ref_pq(to_copy.ref_pq), expected_mod_count(to_copy.expected_mod_count), can_erase(to_copy.can_erase) {
+  it = new int[it_used];
+  for (int i=0; i<it_used; ++i)
+    it[i] = to_copy.it[i];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator = (const Iterator& rhs) -> Iterator& {
+  if (this == &rhs)
+    return *this;
+  delete [] it;
+  it_used            = rhs.it_used;
+  ref_pq             = rhs.ref_pq;
+  expected_mod_count = rhs.expected_mod_count;
+  can_erase          = rhs.can_erase;
+  it = new int[it_used];
+  for (int i=0; i<it_used; ++i)
+    it[i] = rhs.it[i];
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MinMaxHeapPriorityQueue<T,tgt>::Iterator::~Iterator() {
+  delete [] it;
+}
+
+
+//Erasing by slot leaves the other values (and so the order of "it") unchanged
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T MinMaxHeapPriorityQueue<T,tgt>::Iterator::erase() {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("MinMaxHeapPriorityQueue::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("MinMaxHeapPriorityQueue::Iterator::erase Iterator cursor already erased");
+  if (it_used == 0)
+    throw CannotEraseError("MinMaxHeapPriorityQueue::Iterator::erase Iterator cursor beyond data structure");
+
+  can_erase = false;
+  int slot = it[0];
+  it[0] = it[--it_used];
+  if (it_used != 0)
+    ref_pq->percolate_down(it,it_used,nullptr,0);
+  T to_return = ref_pq->erase_at(ref_pq->position[slot]);
+
+  expected_mod_count = ref_pq->mod_count;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string MinMaxHeapPriorityQueue<T,tgt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_pq->str() << "/it=";
+  for (int i=0; i<it_used; ++i)
+    answer << (i == 0 ? "" : ",") << it[i];
+  answer << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  return answer.str();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator ++ () -> MinMaxHeapPriorityQueue<T,tgt>::Iterator& {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("MinMaxHeapPriorityQueue::Iterator::operator ++");
+
+  if (it_used == 0)
+    return *this;
+
+  if (can_erase) {
+    it[0] = it[--it_used];
+    if (it_used != 0)
+      ref_pq->percolate_down(it,it_used,nullptr,0);
+  }
+  else
+    can_erase = true;
+
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator ++ (int) -> MinMaxHeapPriorityQueue<T,tgt>::Iterator {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("MinMaxHeapPriorityQueue::Iterator::operator ++(int)");
+
+  if (it_used == 0)
+    return *this;
+
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator == (const MinMaxHeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("MinMaxHeapPriorityQueue::Iterator::operator ==");
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("MinMaxHeapPriorityQueue::Iterator::operator ==");
+  if (ref_pq != rhsASI->ref_pq)
+    throw ComparingDifferentIteratorsError("MinMaxHeapPriorityQueue::Iterator::operator ==");
+
+  //Two iterators on the same heap are equal if their sizes are equal
+  return this->it_used == rhsASI->it_used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator != (const MinMaxHeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator *() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("MinMaxHeapPriorityQueue::Iterator::operator *");
+  if (!can_erase || it_used == 0)
+    throw IteratorPositionIllegal("MinMaxHeapPriorityQueue::Iterator::operator * Iterator illegal");
+
+  return ref_pq->values[it[0]];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T* MinMaxHeapPriorityQueue<T,tgt>::Iterator::operator ->() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("MinMaxHeapPriorityQueue::Iterator::operator ->");
+  if (!can_erase || it_used == 0)
+    throw IteratorPositionIllegal("MinMaxHeapPriorityQueue::Iterator::operator -> Iterator illegal");
+
+  return &ref_pq->values[it[0]];
+}
+
+}
+
+#endif /* MIN_MAX_HEAP_PRIORITY_QUEUE_HPP_ */
@@ -0,0 +1,318 @@
+#ifndef MULTI_QUEUE_HPP_
+#define MULTI_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <random>
+#include <functional>           //For std::hash
+#include <algorithm>            //For std::max
+#include "ics_exceptions.hpp"
+#include "heap_priority_queue.hpp"
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+
+//A relaxed priority queue that many threads can enqueue into and dequeue from at once. Wrapping a
+//  HeapPriorityQueue in one mutex makes every thread wait for the same lock (and for pq[0]'s cache
+//  line); instead a MultiQueue has c*P shards (for P threads), each a HeapPriorityQueue with its own
+//  mutex. enqueue puts a value into a random shard; dequeue looks at two random shards and
+//  dequeues the higher-priority of their two tops. A thread that finds a shard locked (try_lock)
+//  just picks other shards, so threads rarely wait for each other.
+//
+//The price is that dequeue is relaxed: it need not return the highest-priority value. Its rank
+//  error (the number of values in the queue with higher priority than the one dequeued) is small,
+//  and depends only on the number of shards S = c*P, not on the queue's size: choosing the better
+//  of two random shards keeps the shards' tops balanced, so (for the sequential process analyzed by
+//  Alistarh et al., "The Power of Choice in Priority Scheduling", 2017) the expected rank error is
+//  O(S) and the largest is O(S log S) with high probability. Concurrent threads can add far more:
+//  a thread preempted between choosing a value and using it returns a value whose rank has grown
+//  meanwhile. When threads time-share cores this dominates, inflating the rank error by orders of
+//  magnitude (multiqueue_benchmark.cpp, 1 core: a mean of 255 with 2 threads vs 1.36 for the
+//  sequential process with the same shards, and 6955 vs 24 with 16 threads); run at most one
+//  thread per core. A MultiQueue with 1 shard is an exact (locked) priority queue. See
+//  multiqueue_benchmark.cpp for measured throughput and rank errors.
+//
+//size/empty are exact only when no thread is enqueueing or dequeueing. dequeue raises EmptyError
+//  only when the queue is empty; try_dequeue returns false instead. There is no Iterator (the
+//  shards' values can change while iterating), and a MultiQueue cannot be copied.
+//
+//Instantiate the templated class supplying tgt(a,b): true, iff a has higher priority than b.
+//If tgt is defaulted to undefinedgt in the template, then a constructor must supply cgt.
+//If both tgt and cgt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class MultiQueue {
+  public:
+    typedef bool (*gtfunc) (const T& a, const T& b);
+
+    //Destructor/Constructors
+    ~MultiQueue();
+
+    //threads defaults to std::thread::hardware_concurrency(); shards = c*threads
+    explicit MultiQueue(bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit MultiQueue(int threads, int c = 2, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    MultiQueue(const MultiQueue<T,tgt>& to_copy) = delete;
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    int  shards     () const;
+    std::string str () const; //supplies useful debugging information (locks every shard)
+
+
+    //Commands
+    int  enqueue     (const T& element);
+    T    dequeue     ();                   //A high-priority (not necessarily the highest) value
+    bool try_dequeue (T& element);         //false (and element unchanged) if empty
+    void clear       ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    MultiQueue<T,tgt>& operator = (const MultiQueue<T,tgt>& rhs) = delete;
+
+
+  private:
+    //pad keeps the locks and heap fields of different shards off the same cache line
+    struct Shard {
+      std::mutex                 lock;
+      HeapPriorityQueue<T,tgt,4> pq;
+      char                       pad[64];
+
+      Shard(gtfunc gt) : pq(gt) {}
+    };
+
+    bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
+    Shard**          shard;
+    int              shard_count;
+    std::atomic<int> values;             //Values in all shards
+
+    //Helper methods
+    static gtfunc checked_gt (gtfunc cgt, const char* where);
+    void make_shards (int threads, int c);
+    int  random_shard() const;
+    bool dequeue_any (T& element);       //Dequeue from the first non-empty shard (waiting for locks)
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//MultiQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MultiQueue<T,tgt>::~MultiQueue() {
+  for (int s=0; s<shard_count; ++s)
+    delete shard[s];
+  delete [] shard;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MultiQueue<T,tgt>::MultiQueue(bool (*cgt)(const T& a, const T& b))
+: gt(checked_gt(cgt,"MultiQueue::default constructor")), values(0) {
+  make_shards(std::thread::hardware_concurrency(),2);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+MultiQueue<T,tgt>::MultiQueue(int threads, int c, bool (*cgt)(const T& a, const T& b))
+: gt(checked_gt(cgt,"MultiQueue::threads constructor")), values(0) {
+  if (threads < 1 || c < 1) {
+    std::ostringstream answer;
+    answer << "MultiQueue::threads constructor: threads(" << threads << ") < 1 or c(" << c << ") < 1";
+    throw IcsError(answer.str());
+  }
+  make_shards(threads,c);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MultiQueue<T,tgt>::empty() const {
+  return values.load() == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MultiQueue<T,tgt>::size() const {
+  return values.load();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MultiQueue<T,tgt>::shards() const {
+  return shard_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string MultiQueue<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "MultiQueue[";
+  for (int s=0; s<shard_count; ++s) {
+    std::lock_guard<std::mutex> guard(shard[s]->lock);
+    answer << (s == 0 ? "" : ",") << s << ":" << shard[s]->pq.size();
+    if (!shard[s]->pq.empty())
+      answer << "/" << shard[s]->pq.peek();
+  }
+  answer << "](shards=" << shard_count << ",values=" << values.load() << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MultiQueue<T,tgt>::enqueue(const T& element) {
+  for (;;) {
+    Shard* s = shard[random_shard()];
+    if (shard_count == 1)
+      s->lock.lock();
+    else if (!s->lock.try_lock())
+      continue;
+    std::lock_guard<std::mutex> guard(s->lock, std::adopt_lock);
+    s->pq.enqueue(element);
+    ++values;
+    return 1;
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T MultiQueue<T,tgt>::dequeue() {
+  T to_return;
+  if (!try_dequeue(to_return))
+    throw EmptyError("MultiQueue::dequeue");
+  return to_return;
+}
+
+
+//Both shards are locked (by try_lock, so this thread never waits holding a lock) to compare their
+//  tops. Finding both empty is common only when the queue is nearly empty: then dequeue_any looks
+//  at every shard, so a value anywhere is found.
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MultiQueue<T,tgt>::try_dequeue(T& element) {
+  if (shard_count == 1)
+    return dequeue_any(element);
+
+  while (values.load() > 0) {
+    int i = random_shard(), j = random_shard();
+    if (i == j)
+      continue;
+    Shard* a = shard[i];
+    Shard* b = shard[j];
+    if (!a->lock.try_lock())
+      continue;
+    std::unique_lock<std::mutex> guard_a(a->lock, std::adopt_lock);
+    std::unique_lock<std::mutex> guard_b(b->lock, std::try_to_lock);
+    if (!guard_b.owns_lock())
+      continue;
+    if (a->pq.empty() && b->pq.empty()) {
+      guard_a.unlock();
+      guard_b.unlock();
+      return dequeue_any(element);
+    }
+    if (a->pq.empty() || (!b->pq.empty() && gt(b->pq.peek(),a->pq.peek())))
+      std::swap(a,b);
+    element = a->pq.dequeue();
+    --values;
+    return true;
+  }
+  return false;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MultiQueue<T,tgt>::clear() {
+  for (int s=0; s<shard_count; ++s) {
+    std::lock_guard<std::mutex> guard(shard[s]->lock);
+    values -= shard[s]->pq.size();
+    shard[s]->pq.clear();
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+int MultiQueue<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto MultiQueue<T,tgt>::checked_gt(gtfunc cgt, const char* where) -> gtfunc {
+  if (tgt == (gtfunc)undefinedgt<T> && cgt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError(std::string(where) + ": neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError(std::string(where) + ": both specified and different");
+  return tgt != (gtfunc)undefinedgt<T> ? tgt : cgt;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void MultiQueue<T,tgt>::make_shards(int threads, int c) {
+  shard_count = std::max(1,threads)*c;
+  shard = new Shard*[shard_count];
+  for (int s=0; s<shard_count; ++s)
+    shard[s] = new Shard(gt);
+}
+
+
+//Each thread has its own generator, so choosing shards needs no synchronization
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int MultiQueue<T,tgt>::random_shard() const {
+  static thread_local std::minstd_rand random(std::hash<std::thread::id>()(std::this_thread::get_id()));
+  return random() % shard_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool MultiQueue<T,tgt>::dequeue_any(T& element) {
+  for (int s=0; s<shard_count; ++s) {
+    std::lock_guard<std::mutex> guard(shard[s]->lock);
+    if (!shard[s]->pq.empty()) {
+      element = shard[s]->pq.dequeue();
+      --values;
+      return true;
+    }
+  }
+  return false;
+}
+
+}
+
+#endif /* MULTI_QUEUE_HPP_ */
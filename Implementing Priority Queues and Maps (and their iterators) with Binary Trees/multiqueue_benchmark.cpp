@@ -0,0 +1,158 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>            //For std::atoi
+#include "heap_priority_queue.hpp"
+#include "multi_queue.hpp"
+
+
+//Throughput and rank error of a MultiQueue (c = 2 shards per thread), compared to a
+//  HeapPriorityQueue guarded by one mutex, for 1 thread up to the number of cores.
+//Each thread repeatedly dequeues a value and enqueues a new random one (keeping the size steady
+//  at PREFILL), as a parallel Dijkstra or branch-and-bound search would.
+//The rank error of a dequeued value is the number of values in the queue with higher priority.
+//  To measure it, a second run tags each operation with a global sequence number (which slows the
+//  run, so it is not timed) and then replays the operations in that order, counting the values
+//  with higher priority in a Fenwick tree (indexed by key). The last column drives the same number
+//  of shards from 1 thread: the sequential process whose rank error multi_queue.hpp describes.
+//  When threads outnumber cores, a thread preempted between its dequeue and its tag is replayed
+//  late, which inflates the concurrent rank error.
+
+const int KEYS       = 1 << 22;     //Keys are in [0,KEYS): lower keys have higher priority
+const int PREFILL    = 1000000;
+const int OPERATIONS = 2000000;     //Dequeue+enqueue pairs, shared among the threads
+
+bool key_gt(const int& a, const int& b) {return a < b;}
+
+typedef ics::HeapPriorityQueue<int,key_gt,4> LockedPQ;
+typedef ics::MultiQueue<int,key_gt>          MQ;
+
+
+struct Operation {
+  long long sequence;
+  int       key;
+  bool      is_enqueue;
+};
+
+
+//A PQ (LockedPQ behind one mutex, or MQ) with the same enqueue/try_dequeue interface
+struct Locked {
+  std::mutex lock;
+  LockedPQ   pq;
+  int  enqueue    (int key)  {std::lock_guard<std::mutex> guard(lock); return pq.enqueue(key);}
+  bool try_dequeue(int& key) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (pq.empty())
+      return false;
+    key = pq.dequeue();
+    return true;
+  }
+};
+
+
+template<class PQ>
+void work(PQ& pq, int operations, unsigned seed, std::atomic<long long>* sequence, std::vector<Operation>* log) {
+  std::minstd_rand random(seed);
+  for (int i=0; i<operations; ++i) {
+    int key;
+    if (pq.try_dequeue(key) && log != nullptr)
+      log->push_back(Operation{sequence->fetch_add(1),key,false});
+    key = random() % KEYS;
+    if (log != nullptr)  //Tag before enqueue, so a dequeue of key is always replayed after it
+      log->push_back(Operation{sequence->fetch_add(1),key,true});
+    pq.enqueue(key);
+  }
+}
+
+
+template<class PQ>
+double run(PQ& pq, int threads, bool measure_rank, double& mean_rank, long long& max_rank) {
+  std::minstd_rand random(1);
+  std::vector<Operation> prefill;
+  for (int i=0; i<PREFILL; ++i) {
+    int key = random() % KEYS;
+    pq.enqueue(key);
+    prefill.push_back(Operation{-1,key,true});
+  }
+
+  std::atomic<long long> sequence(0);
+  std::vector<std::vector<Operation>> logs(threads);
+  std::vector<std::thread> workers;
+  auto start = std::chrono::steady_clock::now();
+  for (int t=0; t<threads; ++t)
+    workers.push_back(std::thread(work<PQ>, std::ref(pq), OPERATIONS/threads, 17+t, &sequence,
+                                  measure_rank ? &logs[t] : nullptr));
+  for (std::thread& w : workers)
+    w.join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+
+  if (measure_rank) {
+    std::vector<Operation> all(prefill);
+    for (const std::vector<Operation>& l : logs)
+      all.insert(all.end(),l.begin(),l.end());
+    std::stable_sort(all.begin(),all.end(),[](const Operation& a, const Operation& b){return a.sequence < b.sequence;});
+    std::vector<int> fenwick(KEYS+1,0);   //Counts of keys in the queue
+    long long sum = 0, dequeues = 0;
+    max_rank = 0;
+    for (const Operation& o : all) {
+      int delta = o.is_enqueue ? 1 : -1;
+      if (!o.is_enqueue) {
+        long long higher = 0;             //Keys < o.key
+        for (int i=o.key; i > 0; i -= i & -i)
+          higher += fenwick[i];
+        sum += higher;
+        max_rank = std::max(max_rank,higher);
+        ++dequeues;
+      }
+      for (int i=o.key+1; i <= KEYS; i += i & -i)
+        fenwick[i] += delta;
+    }
+    mean_rank = dequeues == 0 ? 0 : double(sum)/dequeues;
+  }
+  return 2.0*OPERATIONS/seconds;
+}
+
+
+//The optional argument is the most threads to run (default: the number of cores)
+int main(int argc, char* argv[]) {
+  int cores = argc > 1 ? std::max(1,std::atoi(argv[1])) : std::max(1u,std::thread::hardware_concurrency());
+  std::cout << "threads  locked HeapPriorityQueue ops/s  MultiQueue ops/s  (shards)  rank error mean/max  (1 thread)" << std::endl;
+  for (int doubling=1; ; doubling *= 2) {
+    int threads = std::min(doubling,cores);   //1, 2, 4, ..., cores
+    double mean_rank;
+    long long max_rank;
+    Locked locked;
+    double locked_ops = run(locked,threads,false,mean_rank,max_rank);
+    MQ mq(threads);
+    double mq_ops = run(mq,threads,false,mean_rank,max_rank);
+    MQ mq_rank(threads);
+    run(mq_rank,threads,true,mean_rank,max_rank);
+    double sequential_mean_rank;
+    long long sequential_max_rank;
+    MQ mq_sequential(threads);                  //Same shards, 1 thread
+    run(mq_sequential,1,true,sequential_mean_rank,sequential_max_rank);
+    std::cout << threads << "  " << locked_ops << "  " << mq_ops << "  (" << mq.shards() << ")  "
+              << mean_rank << "/" << max_rank << "  "
+              << sequential_mean_rank << "/" << sequential_max_rank << std::endl;
+    if (threads == cores)
+      break;
+  }
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2, run with argument 16): with one core the threads only
+//  time-share, so the MultiQueue cannot gain throughput here; it shows the cost of sampling two
+//  shards, and the rank errors.
+//threads  locked HeapPriorityQueue ops/s  MultiQueue ops/s  (shards)  rank error mean/max  (1 thread)
+//1   6.76e+06  5.05e+06  (2)   0/0           0/0
+//2   6.39e+06  3.38e+06  (4)   255/4537      1.36/34
+//4   6.41e+06  3.36e+06  (8)   1047/11055    4.49/70
+//8   6.59e+06  3.45e+06  (16)  3176/22656    10.96/137
+//16  6.24e+06  3.16e+06  (32)  6955/37823    24.12/329
@@ -0,0 +1,892 @@
+#ifndef PAIRING_HEAP_PRIORITY_QUEUE_HPP_
+#define PAIRING_HEAP_PRIORITY_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include "ics_exceptions.hpp"
+#include <utility>              //For std::swap function
+#include <algorithm>            //For std::max
+#include "array_stack.hpp"      //See operator <<, clear, and copying
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+//A pairing heap: a tree whose every node's value has priority >= its children's, where each node
+//  points to its first (leftmost) child and its next sibling. Two trees are linked in O(1) by
+//  making the root with lower priority the first child of the other, so
+//    enqueue is O(1): link a new 1-node tree with the root
+//    meld is O(1): link the other queue's root with this one's (emptying the other queue)
+//    dequeue is amortized O(log N): link the root's children in pairs left to right, then link
+//      those right to left (the "two-pass" method)
+//  Unlike HeapPriorityQueue, combining two queues (e.g., partial results computed separately)
+//  does not enqueue each value of one into the other.
+//enqueue returns a Handle to its value, which stays valid (even if the value is melded into another
+//  queue) until that value is dequeued, erased or cleared; decrease_key (raise its priority) is
+//  amortized o(log N), and erase(Handle) amortized O(log N). operator []/decrease_key/erase raise
+//  KeyError for a Handle that names no value in the queue (a default Handle, a Handle whose value
+//  is gone, or a Handle to a value in another queue). So that a Handle can tell, a node outlives
+//  its value's removal (keeping a moved-from value) until no Handle names it, and each node knows
+//  the queue it is in through a Family: meld points the other queue's Family at this one's (union
+//  by rank, so a node reaches its queue's Family in O(log melds) steps) instead of visiting nodes.
+//
+//Instantiate the templated class supplying tgt(a,b): true, iff a has higher priority than b.
+//If tgt is defaulted to undefinedgt in the template, then a constructor must supply cgt.
+//If both tgt and cgt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class PairingHeapPriorityQueue {
+  private:
+    class PN;
+
+  public:
+    typedef bool (*gtfunc) (const T& a, const T& b);
+
+    //Names a value in the queue: returned by enqueue, used by operator []/decrease_key/erase
+    class Handle {
+      public:
+        Handle() {}
+        Handle(const Handle& h) : node(h.node) {hold();}
+        ~Handle() {PairingHeapPriorityQueue<T,tgt>::drop_handle(node);}
+        Handle& operator = (const Handle& rhs) {
+          if (node != rhs.node) {
+            PN* old = node;
+            node = rhs.node;
+            hold();
+            PairingHeapPriorityQueue<T,tgt>::drop_handle(old);
+          }
+          return *this;
+        }
+        bool operator == (const Handle& rhs) const {return node == rhs.node;}
+        bool operator != (const Handle& rhs) const {return node != rhs.node;}
+
+      private:
+        PN* node = nullptr;
+        Handle(PN* node) : node(node) {hold();}
+        void hold() {if (node != nullptr) ++node->handles;}
+        friend class PairingHeapPriorityQueue<T,tgt>;
+    };
+
+    //Destructor/Constructors
+    ~PairingHeapPriorityQueue();
+
+    PairingHeapPriorityQueue(bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    PairingHeapPriorityQueue(const PairingHeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit PairingHeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit PairingHeapPriorityQueue (const Iterable& i, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+
+    //Queries
+    bool     empty () const;
+    int      size  () const;
+    const T& peek  () const;
+    const T& operator [] (const Handle& h) const;   //The value named by h
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    Handle enqueue (const T& element);
+    T      dequeue ();
+    void   clear   ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+    //Moves all of other's values into this queue in O(1), leaving other empty (its Handles now name
+    //  values in this queue); raises IcsError if the queues use different gt functions
+    void meld (PairingHeapPriorityQueue<T,tgt>& other);
+
+    //value must not have lower priority than h's current value (else IcsError is raised)
+    void decrease_key (const Handle& h, const T& value);
+    T    erase        (const Handle& h);
+
+
+    //Operators
+    PairingHeapPriorityQueue<T,tgt>& operator = (const PairingHeapPriorityQueue<T,tgt>& rhs);
+    bool operator == (const PairingHeapPriorityQueue<T,tgt>& rhs) const;
+    bool operator != (const PairingHeapPriorityQueue<T,tgt>& rhs) const;
+
+    template<class T2, bool (*gt2)(const T2& a, const T2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const PairingHeapPriorityQueue<T2,gt2>& pq);
+
+
+
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of PairingHeapPriorityQueue<T,tgt>
+        ~Iterator();
+        Iterator(const Iterator& to_copy);
+        Iterator& operator = (const Iterator& rhs);
+        T           erase();
+        std::string str  () const;
+        PairingHeapPriorityQueue<T,tgt>::Iterator& operator ++ ();
+        PairingHeapPriorityQueue<T,tgt>::Iterator  operator ++ (int);
+        bool operator == (const PairingHeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        bool operator != (const PairingHeapPriorityQueue<T,tgt>::Iterator& rhs) const;
+        const T& operator *  () const;
+        const T* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const PairingHeapPriorityQueue<T,tgt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+
+        friend Iterator PairingHeapPriorityQueue<T,tgt>::begin () const;
+        friend Iterator PairingHeapPriorityQueue<T,tgt>::end   () const;
+
+      private:
+        //As in HeapPriorityQueue: the nodes visited form a subtree at the root, and frontier is a
+        //  (binary) heap of their unvisited children, ordered by value, whose top is the current
+        //  node; ++ replaces it by all its children. Nothing is copied or changed.
+        //If can_erase is false, the value has been erased and frontier's top is already the next (++
+        //  does nothing).
+        PairingHeapPriorityQueue<T,tgt>* ref_pq;
+        PN**                             frontier;
+        int                              frontier_length;
+        int                              frontier_used = 0;
+        int                              remaining;          //Number of values not yet iterated over
+        int                              expected_mod_count;
+        bool                             can_erase = true;
+
+        //Called in friends begin/end: remaining is ref_pq's size for begin, 0 for end
+        Iterator(PairingHeapPriorityQueue<T,tgt>* iterate_over, int remaining);
+
+        //Helpers for frontier
+        void frontier_add      (PN* n);
+        void frontier_children (PN* n);           //frontier_add each child of n
+        PN*  frontier_remove   ();                //Remove/return the top
+        bool frontier_gt       (int f1, int f2) const;
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    //Names a queue: a queue's Family has merged_into == nullptr; a melded queue's Family points
+    //  (through merged_into) to the Family of the queue it was melded into
+    class Family {
+      public:
+        Family* merged_into = nullptr;
+        int     rank        = 0;                 //Longest merged_into path to this Family
+        int     refs        = 1;                 //Its queue, its nodes, and the Families merged into it
+    };
+
+    class PN {
+      public:
+        PN (const T& v, Family* f) : value(v), family(f) {++f->refs;}
+
+        T       value;
+        PN*     child    = nullptr;              //First (leftmost) child
+        PN*     sibling  = nullptr;              //Next sibling to the right
+        PN*     prev     = nullptr;              //Parent if the first child, else previous sibling; nullptr at the root
+        Family* family;                          //Of the queue it was enqueued into
+        int     handles  = 0;                    //Number of Handles naming it
+        bool    in_queue = true;                 //false once its value is dequeued, erased or cleared
+    };
+
+    bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
+    PN* root      = nullptr;
+    int used      = 0;                   //Number of values in the tree
+    int mod_count = 0;                   //For sensing concurrent modification
+    Family* family = nullptr;            //Allocated after a constructor checks gt
+
+
+    //Helper methods
+    PN*  link        (PN* a, PN* b);           //Link two roots, returning the new root
+    PN*  merge_pairs (PN* first);              //Two-pass merge of first and its siblings into one tree
+    void cut         (PN* n);                  //Detach n's tree from its parent (n != root)
+    PN*  remove      (PN* n);                  //Remove node n from the heap (but do not delete it)
+    PN*  checked     (const Handle& h, const char* where) const;  //h's node, or raise KeyError
+    void copy_values (const PairingHeapPriorityQueue<T,tgt>& from);
+    void delete_all  ();
+    static void release     (Family* f);       //Drop a reference to f
+    static void release     (PN* n);           //Delete n if it is out of the queue and no Handle names it
+    static void drop_handle (PN* n);           //A Handle naming n (if not nullptr) is gone
+  };
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//PairingHeapPriorityQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::~PairingHeapPriorityQueue() {
+  delete_all();
+  release(family);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::PairingHeapPriorityQueue(bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::default constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::default constructor: both specified and different");
+  family = new Family();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::PairingHeapPriorityQueue(const PairingHeapPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    gt = to_copy.gt;
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::copy constructor: both specified and different");
+  family = new Family();
+  copy_values(to_copy);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::PairingHeapPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::initializer_list constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::initializer_list constructor: both specified and different");
+  family = new Family();
+  for (const T& pq_elem : il)
+    enqueue(pq_elem);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+PairingHeapPriorityQueue<T,tgt>::PairingHeapPriorityQueue(const Iterable& i, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::Iterable constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("PairingHeapPriorityQueue::Iterable constructor: both specified and different");
+  family = new Family();
+  for (const T& v : i)
+    enqueue(v);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool PairingHeapPriorityQueue<T,tgt>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int PairingHeapPriorityQueue<T,tgt>::size() const {
+  return used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& PairingHeapPriorityQueue<T,tgt>::peek () const {
+  if (empty())
+    throw EmptyError("PairingHeapPriorityQueue::peek");
+  return root->value;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& PairingHeapPriorityQueue<T,tgt>::operator [] (const Handle& h) const {
+  return checked(h,"PairingHeapPriorityQueue::operator []")->value;
+}
+
+
+//Shows each node's children in parentheses, after the node
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string PairingHeapPriorityQueue<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "pairing_heap_priority_queue[";
+  ArrayStack<PN*> to_show;                      //nullptr means: close a child list
+  if (root != nullptr)
+    to_show.push(root);
+  while (!to_show.empty()) {
+    PN* n = to_show.pop();
+    if (n == nullptr) {
+      answer << ")";
+      continue;
+    }
+    answer << n->value;
+    if (n->sibling != nullptr)
+      to_show.push(n->sibling);
+    if (n->child != nullptr) {
+      to_show.push(nullptr);
+      to_show.push(n->child);
+      answer << "(";
+    }else if (n->sibling != nullptr)
+      answer << ",";
+  }
+  answer << "](used=" << used << ",mod_count=" << mod_count << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::enqueue(const T& element) -> Handle {
+  PN* n = new PN(element,family);
+  root = (root == nullptr ? n : link(root,n));
+  ++used;
+  ++mod_count;
+  return Handle(n);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T PairingHeapPriorityQueue<T,tgt>::dequeue() {
+  if (empty())
+    throw EmptyError("PairingHeapPriorityQueue::dequeue");
+  PN* to_delete = remove(root);
+  T answer = std::move(to_delete->value);
+  release(to_delete);
+  ++mod_count;
+  return answer;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::clear() {
+  delete_all();
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+int PairingHeapPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i) {
+    enqueue(v);
+    ++count;
+  }
+  return count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::meld (PairingHeapPriorityQueue<T,tgt>& other) {
+  if (this == &other || other.empty())
+    return;
+  if (gt != other.gt)
+    throw IcsError("PairingHeapPriorityQueue::meld: queues use different gt functions");
+  Family* fresh = new Family();                 //For other (allocated before anything changes)
+  root = (root == nullptr ? other.root : link(root,other.root));
+  used += other.used;
+  other.root = nullptr;
+  other.used = 0;
+
+  //The higher-ranked Family names this queue now; the other queue gets a new one
+  Family* mine   = family;
+  Family* theirs = other.family;
+  Family* top    = mine->rank >= theirs->rank ? mine : theirs;
+  Family* under  = top == mine ? theirs : mine;
+  under->merged_into = top;
+  ++top->refs;
+  if (under->rank == top->rank)
+    ++top->rank;
+  family = top;
+  ++top->refs;
+  other.family = fresh;
+  release(mine);
+  release(theirs);
+  ++mod_count;
+  ++other.mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::decrease_key (const Handle& h, const T& value) {
+  PN* n = checked(h,"PairingHeapPriorityQueue::decrease_key");
+  if (gt(n->value,value)) {
+    std::ostringstream answer;
+    answer << "PairingHeapPriorityQueue::decrease_key: value(" << value << ") has lower priority than " << n->value;
+    throw IcsError(answer.str());
+  }
+  n->value = value;
+  if (n != root) {
+    cut(n);
+    root = link(root,n);
+  }
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T PairingHeapPriorityQueue<T,tgt>::erase (const Handle& h) {
+  PN* to_delete = remove(checked(h,"PairingHeapPriorityQueue::erase"));
+  T answer = std::move(to_delete->value);
+  release(to_delete);
+  ++mod_count;
+  return answer;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>& PairingHeapPriorityQueue<T,tgt>::operator = (const PairingHeapPriorityQueue<T,tgt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  delete_all();
+  gt = rhs.gt;
+  copy_values(rhs);
+  ++mod_count;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool PairingHeapPriorityQueue<T,tgt>::operator == (const PairingHeapPriorityQueue<T,tgt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (gt != rhs.gt)
+    return false;
+  if (used != rhs.size())
+    return false;
+  for (Iterator l=begin(), r=rhs.begin(); l!=end(); ++l, ++r)
+    if (*l != *r)
+      return false;
+  return true;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool PairingHeapPriorityQueue<T,tgt>::operator != (const PairingHeapPriorityQueue<T,tgt>& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::ostream& operator << (std::ostream& outs, const PairingHeapPriorityQueue<T,tgt>& p) {
+  ArrayStack<const T*> temp;                    //Pointers into p: print highest last, copying no values
+  for (const T& v : p)
+    temp.push(&v);
+  outs << "priority_queue[";
+  if (!temp.empty()) {
+    outs << *temp.pop();
+    while (!temp.empty())
+      outs << "," << *temp.pop();
+  }
+  outs << "]:highest";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::begin () const -> PairingHeapPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<PairingHeapPriorityQueue<T,tgt>*>(this), used);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::end () const -> PairingHeapPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<PairingHeapPriorityQueue<T,tgt>*>(this), 0);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//Ties keep a as the root
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::link (PN* a, PN* b) -> PN* {
+  if (gt(b->value,a->value))
+    std::swap(a,b);
+  b->sibling = a->child;
+  if (a->child != nullptr)
+    a->child->prev = b;
+  b->prev  = a;
+  a->child = b;
+  a->sibling = a->prev = nullptr;
+  return a;
+}
+
+
+//Pass 1 links pairs left to right, pushing each result onto a list (linked through sibling);
+//  pass 2 pops that list (right to left), linking each tree into the accumulated result
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::merge_pairs (PN* first) -> PN* {
+  if (first == nullptr)
+    return nullptr;
+
+  PN* pairs = nullptr;
+  while (first != nullptr) {
+    PN* a = first;
+    PN* b = a->sibling;
+    first = (b == nullptr ? nullptr : b->sibling);
+    PN* linked = (b == nullptr ? a : link(a,b));
+    linked->sibling = pairs;
+    pairs = linked;
+  }
+
+  PN* answer = pairs;
+  pairs = pairs->sibling;
+  answer->sibling = answer->prev = nullptr;
+  while (pairs != nullptr) {
+    PN* next = pairs->sibling;
+    answer = link(answer,pairs);
+    pairs = next;
+  }
+  return answer;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::cut (PN* n) {
+  if (n->prev->child == n)
+    n->prev->child = n->sibling;
+  else
+    n->prev->sibling = n->sibling;
+  if (n->sibling != nullptr)
+    n->sibling->prev = n->prev;
+  n->sibling = n->prev = nullptr;
+}
+
+
+//The children of n are merged (by merge_pairs) into one tree, which takes n's place: as the root,
+//  or linked with the root
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::remove (PN* n) -> PN* {
+  if (n != root)
+    cut(n);
+  PN* children = merge_pairs(n->child);
+  n->child = nullptr;
+  if (n == root)
+    root = children;
+  else if (children != nullptr)
+    root = link(root,children);
+  n->in_queue = false;
+  --used;
+  return n;
+}
+
+
+//A node's Family leads (by merged_into) to the Family of the queue that the node is in
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::checked (const Handle& h, const char* where) const -> PN* {
+  PN* n = h.node;
+  if (n != nullptr && n->in_queue) {
+    Family* f = n->family;
+    while (f->merged_into != nullptr)
+      f = f->merged_into;
+    if (f == family)
+      return n;
+  }
+  throw KeyError(std::string(where)+": Handle names no value in this queue");
+}
+
+
+//Enqueue from's values, visiting its nodes with an explicit stack (sibling lists can be long)
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::copy_values (const PairingHeapPriorityQueue<T,tgt>& from) {
+  ArrayStack<PN*> to_copy;
+  if (from.root != nullptr)
+    to_copy.push(from.root);
+  while (!to_copy.empty()) {
+    PN* n = to_copy.pop();
+    enqueue(n->value);
+    if (n->sibling != nullptr)
+      to_copy.push(n->sibling);
+    if (n->child != nullptr)
+      to_copy.push(n->child);
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::delete_all () {
+  ArrayStack<PN*> to_delete;
+  if (root != nullptr)
+    to_delete.push(root);
+  while (!to_delete.empty()) {
+    PN* n = to_delete.pop();
+    if (n->sibling != nullptr)
+      to_delete.push(n->sibling);
+    if (n->child != nullptr)
+      to_delete.push(n->child);
+    n->in_queue = false;
+    release(n);
+  }
+  root = nullptr;
+  used = 0;
+}
+
+
+//Releasing a Family may release the Family it was merged into, and so on
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::release (Family* f) {
+  while (f != nullptr && --f->refs == 0) {
+    Family* into = f->merged_into;
+    delete f;
+    f = into;
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::release (PN* n) {
+  if (!n->in_queue && n->handles == 0) {
+    release(n->family);
+    delete n;
+  }
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::drop_handle (PN* n) {
+  if (n != nullptr) {
+    --n->handles;
+    release(n);
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::Iterator::Iterator(PairingHeapPriorityQueue<T,tgt>* iterate_over, int remaining)
+: ref_pq(iterate_over), frontier_length(4), remaining(remaining), expected_mod_count(iterate_over->mod_count) {
+  frontier = new PN*[frontier_length];
+  if (remaining > 0)
+    frontier_add(ref_pq->root);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::Iterator::Iterator(const Iterator& to_copy)
+: ref_pq(to_copy.ref_pq), frontier_length(to_copy.frontier_length), frontier_used(to_copy.frontier_used),
+  remaining(to_copy.remaining), expected_mod_count(to_copy.expected_mod_count), can_erase(to_copy.can_erase) {
+  frontier = new PN*[frontier_length];
+  for (int f=0; f<frontier_used; ++f)
+    frontier[f] = to_copy.frontier[f];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::Iterator::operator = (const Iterator& rhs) -> Iterator& {
+  if (this == &rhs)
+    return *this;
+  if (frontier_length < rhs.frontier_used) {
+    delete [] frontier;
+    frontier_length = rhs.frontier_length;
+    frontier = new PN*[frontier_length];
+  }
+  for (int f=0; f<rhs.frontier_used; ++f)
+    frontier[f] = rhs.frontier[f];
+  ref_pq             = rhs.ref_pq;
+  frontier_used      = rhs.frontier_used;
+  remaining          = rhs.remaining;
+  expected_mod_count = rhs.expected_mod_count;
+  can_erase          = rhs.can_erase;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+PairingHeapPriorityQueue<T,tgt>::Iterator::~Iterator()
+{delete [] frontier;}
+
+
+//The current node's children (all unvisited) are merged into one tree that takes its place (see
+//  remove); that tree's root joins the frontier. No other frontier subtree changes.
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T PairingHeapPriorityQueue<T,tgt>::Iterator::erase() {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("PairingHeapPriorityQueue::Iterator::erase Iterator cursor already erased");
+  if (remaining == 0)
+    throw CannotEraseError("PairingHeapPriorityQueue::Iterator::erase Iterator cursor beyond data structure");
+
+  can_erase = false;
+  --remaining;
+  PN* n = frontier_remove();
+  PN* children = n->child;
+  bool was_root = (n == ref_pq->root);
+  T to_erase = ref_pq->erase(Handle(n));
+  if (children != nullptr)
+    frontier_add(was_root ? ref_pq->root : ref_pq->root->child);  //See link: the merged tree is root's first child
+  expected_mod_count = ref_pq->mod_count;
+  return to_erase;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string PairingHeapPriorityQueue<T,tgt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_pq->str() << "/frontier=[";
+  for (int f=0; f<frontier_used; ++f)
+    answer << (f == 0 ? "" : ",") << frontier[f]->value;
+  answer << "]/remaining=" << remaining << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  return answer.str();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::Iterator::operator ++ () -> PairingHeapPriorityQueue<T,tgt>::Iterator& {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::operator ++");
+  if (remaining == 0)
+    return *this;
+  if (can_erase) {
+    frontier_children(frontier_remove());
+    --remaining;
+  }else
+    can_erase = true;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::Iterator::operator ++ (int) -> PairingHeapPriorityQueue<T,tgt>::Iterator {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::operator ++");
+  if (remaining == 0)
+    return *this;
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool PairingHeapPriorityQueue<T,tgt>::Iterator::operator == (const PairingHeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("PairingHeapPriorityQueue::Iterator::operator ==");
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::operator ==");
+  if (ref_pq != rhsASI->ref_pq)
+    throw ComparingDifferentIteratorsError("PairingHeapPriorityQueue::Iterator::operator ==");
+
+  return remaining == rhsASI->remaining;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool PairingHeapPriorityQueue<T,tgt>::Iterator::operator != (const PairingHeapPriorityQueue<T,tgt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("PairingHeapPriorityQueue::Iterator::operator !=");
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::operator !=");
+  if (ref_pq != rhsASI->ref_pq)
+    throw ComparingDifferentIteratorsError("PairingHeapPriorityQueue::Iterator::operator !=");
+
+  return remaining != rhsASI->remaining;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& PairingHeapPriorityQueue<T,tgt>::Iterator::operator *() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::operator *");
+  if (!can_erase || remaining == 0) {
+    std::ostringstream where;
+    where << remaining << " remaining when size = " << ref_pq->size();
+    throw IteratorPositionIllegal("PairingHeapPriorityQueue::Iterator::operator * Iterator illegal: "+where.str());
+  }
+
+  return frontier[0]->value;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T* PairingHeapPriorityQueue<T,tgt>::Iterator::operator ->() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("PairingHeapPriorityQueue::Iterator::operator ->");
+  if (!can_erase || remaining == 0) {
+    std::ostringstream where;
+    where << remaining << " remaining when size = " << ref_pq->size();
+    throw IteratorPositionIllegal("PairingHeapPriorityQueue::Iterator::operator -> Iterator illegal: "+where.str());
+  }
+
+  return &frontier[0]->value;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator private helper methods
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool PairingHeapPriorityQueue<T,tgt>::Iterator::frontier_gt(int f1, int f2) const
+{return ref_pq->gt(frontier[f1]->value, frontier[f2]->value);}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::Iterator::frontier_add(PN* n) {
+  if (frontier_used == frontier_length) {
+    PN** frontier_old = frontier;
+    frontier_length *= 2;
+    frontier = new PN*[frontier_length];
+    for (int f=0; f<frontier_used; ++f)
+      frontier[f] = frontier_old[f];
+    delete [] frontier_old;
+  }
+  int f = frontier_used++;
+  frontier[f] = n;
+  for (/*see above*/; f > 0 && frontier_gt(f,(f-1)/2); f=(f-1)/2)
+    std::swap(frontier[f],frontier[(f-1)/2]);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void PairingHeapPriorityQueue<T,tgt>::Iterator::frontier_children(PN* n) {
+  for (PN* c=n->child; c != nullptr; c=c->sibling)
+    frontier_add(c);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto PairingHeapPriorityQueue<T,tgt>::Iterator::frontier_remove() -> PN* {
+  PN* answer = frontier[0];
+  frontier[0] = frontier[--frontier_used];
+  for (int f=0, c=1; c < frontier_used; c=2*f+1) {
+    if (c+1 < frontier_used && frontier_gt(c+1,c))
+      ++c;
+    if (!frontier_gt(c,f))
+      break;
+    std::swap(frontier[f],frontier[c]);
+    f = c;
+  }
+  return answer;
+}
+
+}
+
+#endif /* PAIRING_HEAP_PRIORITY_QUEUE_HPP_ */
@@ -0,0 +1,796 @@
+#ifndef PERSISTENT_BST_MAP_HPP_
+#define PERSISTENT_BST_MAP_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <atomic>               //For PN::refs (nodes are shared by maps in different threads)
+#include "ics_exceptions.hpp"
+#include "pair.hpp"
+#include "array_stack.hpp"      //See Iterator
+
+
+namespace ics {
+
+
+#ifndef undefinedltdefined
+#define undefinedltdefined
+template<class T>
+bool undefinedlt (const T& a, const T& b) {return false;}
+#endif /* undefinedltdefined */
+
+//A persistent BST: maps share nodes, counting the references to each node, and a node is never
+//  changed once another map (or node) might refer to it. So copying a map (or calling snapshot) is
+//  O(1): it just refers to the same root. put/erase copy only the O(log N) nodes on their search
+//  path that are shared (path copying), and change in place the nodes that only they refer to.
+//A map (and its Iterators) must be used by one thread at a time, but different maps sharing nodes
+//  can be used in different threads with no locking: e.g., a writer can hand snapshots to readers
+//  and keep changing its own map. Only the reference counts are shared and changed (atomically).
+//The tree is weight balanced like BSTMap's, rebalanced by the same join, here copying shared nodes.
+//
+//Instantiate the templated class supplying tlt(a,b): true, iff a is less than b.
+//If tlt is defaulted to undefinedlt in the template, then a constructor must supply clt.
+//If both tlt and clt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedlt value supplied by tlt/clt is stored in the instance variable lt.
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b) = undefinedlt<KEY>> class PersistentBSTMap {
+  public:
+    typedef pair<KEY,T> Entry;
+    typedef bool (*ltfunc) (const KEY& a, const KEY& b);
+
+    //Destructor/Constructors
+    ~PersistentBSTMap();
+
+    PersistentBSTMap          (bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    PersistentBSTMap          (const PersistentBSTMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+    explicit PersistentBSTMap (const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit PersistentBSTMap (const Iterable& i, bool (*clt)(const KEY& a, const KEY& b) = undefinedlt<KEY>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    bool has_key    (const KEY& key) const;
+    bool has_value  (const T& value) const;
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+    PersistentBSTMap<KEY,T,tlt> snapshot() const; //O(1): unaffected by later changes to this map
+
+
+    //Commands
+    T    put   (const KEY& key, const T& value);
+    T    erase (const KEY& key);
+    void clear ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int put_all(const Iterable& i);
+
+
+    //Operators
+
+    //The non-const [] first copies key's node (and the path to it) if shared: so the reference it
+    //  returns can be used only until the next command on, copy of, or snapshot of this map
+    T&       operator [] (const KEY&);
+    const T& operator [] (const KEY&) const;
+    PersistentBSTMap<KEY,T,tlt>& operator = (const PersistentBSTMap<KEY,T,tlt>& rhs);   //O(1), like snapshot
+    bool operator == (const PersistentBSTMap<KEY,T,tlt>& rhs) const;
+    bool operator != (const PersistentBSTMap<KEY,T,tlt>& rhs) const;
+
+    template<class KEY2,class T2, bool (*lt2)(const KEY2& a, const KEY2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const PersistentBSTMap<KEY2,T2,lt2>& m);
+
+
+
+  private:
+    class PN;
+
+  public:
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of PersistentBSTMap<T>
+        ~Iterator();
+        Entry       erase();
+        std::string str  () const;
+        PersistentBSTMap<KEY,T,tlt>::Iterator& operator ++ ();
+        PersistentBSTMap<KEY,T,tlt>::Iterator  operator ++ (int);
+        bool operator == (const PersistentBSTMap<KEY,T,tlt>::Iterator& rhs) const;
+        bool operator != (const PersistentBSTMap<KEY,T,tlt>::Iterator& rhs) const;
+        const Entry& operator *  () const;          //const: a node may be shared with other maps
+        const Entry* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const PersistentBSTMap<KEY,T,tlt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+        friend Iterator PersistentBSTMap<KEY,T,tlt>::begin () const;
+        friend Iterator PersistentBSTMap<KEY,T,tlt>::end   () const;
+
+      private:
+        //The path of nodes still to visit: its top is the current node (empty when beyond the last
+        //  association). If can_erase is false, the top is already the "next" node (++ does nothing)
+        ArrayStack<PN*>              path;
+        PersistentBSTMap<KEY,T,tlt>* ref_map;
+        int                          expected_mod_count;
+        bool                         can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(PersistentBSTMap<KEY,T,tlt>* iterate_over, bool from_begin);
+        PN* current () const;                           //nullptr for end
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    //A PN's fields change only while refs is 1 (just one map or node refers to it, and it is being
+    //  changed by the thread using that map); each PN counts one reference to each of its children
+    class PN {
+      public:
+        PN (const Entry& v, PN* l = nullptr, PN* r = nullptr) : value(v), left(l), right(r), refs(1){
+          size=1+(l== nullptr ? 0 : l->size)+(r== nullptr ? 0 : r->size);
+        }
+        Entry            value;
+        PN*              left;
+        PN*              right;
+        int              size;                   //Number of nodes in this subtree
+        std::atomic<int> refs;                   //Number of maps/PNs referring to this one
+    };
+
+  //The tree is weight balanced, as in BSTMap (see Blelloch, Ferizovic, and Sun, "Just Join for
+  //  Parallel Ordered Sets"): for every node, each subtree's weight (size+1) is at least
+  //  ALPHA_PERCENT percent of the node's weight
+  static const int ALPHA_PERCENT = 29;
+
+  bool (*lt) (const KEY& a, const KEY& b); // The lt used for searching BST (from template or constructor)
+  PN* map       = nullptr;                 //One counted reference to the root
+  int mod_count = 0;                       //For sensing concurrent modification
+
+  //Helper methods for reading (find_key written iteratively, the rest recursively)
+  PN*   find_key            (PN* root, const KEY& key)                  const; //Returns key's node or nullptr
+  bool  has_value           (PN* root, const T& value)                  const;
+  std::string string_rotated(PN* root, std::string indent)              const;
+
+  //Reference counting: each of these (and the modifying helpers below) takes over the references
+  //  passed to it (e.g., own and release consume node's reference), and returns a counted one
+  static PN*  retain   (PN* node);                                            //Count another reference to node; return it
+  static void release  (PN* node);                                            //Delete node (and release its children) when uncounted
+  static PN*  own      (PN* node);                                            //node if unshared, else a copy of it (releasing node)
+
+  //Helpers for modifying: each consumes the references to the subtrees passed to it
+  PN*   insert              (PN* root, const KEY& key, const T& value, T*& value_in, bool& added, T& old_value);
+  PN*   remove              (PN* root, const KEY& key, T& removed);           //key must be in root's tree
+
+  //Helpers for rebalancing by join (m's children are overwritten: they must already be moved out)
+  static int  size_of       (PN* root);                                       //0 for nullptr
+  static bool balanced      (int weight1, int weight2);                       //Whether weights are within ALPHA_PERCENT
+  static PN*  link          (PN* m, PN* l, PN* r);                            //m with subtrees l and r (no rebalancing)
+  static PN*  rotate_left   (PN* root);                                       //root must be unshared
+  static PN*  rotate_right  (PN* root);
+  static PN*  join          (PN* l, PN* m, PN* r);                            //Balanced tree of l, m, r (l's keys < m's < r's)
+  static PN*  join_right    (PN* l, PN* m, PN* r);
+  static PN*  join_left     (PN* l, PN* m, PN* r);
+  static PN*  join2         (PN* l, PN* r);                                   //join without a middle node
+  static PN*  split_last    (PN* root, PN*& rest);                            //Return root's last node (unshared); rest is the others
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//PersistentBSTMap class and related definitions
+
+//Destructor/Constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>::~PersistentBSTMap() {
+  release(map);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>::PersistentBSTMap(bool (*clt)(const KEY& a, const KEY& b))
+:lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("PersistentBSTMap::default constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("PersistentBSTMap::default constructor: both specified and different");
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>::PersistentBSTMap(const PersistentBSTMap<KEY,T,tlt>& to_copy, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt), mod_count(to_copy.mod_count){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    lt=to_copy.lt;
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("PersistentBSTMap::copy constructor: both specified and different");
+  //share the tree
+  if(lt==to_copy.lt)
+    map=retain(to_copy.map);
+  else
+    for(auto e : to_copy)
+      put(e.first,e.second);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>::PersistentBSTMap(const std::initializer_list<Entry>& il, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("PersistentBSTMap::initializer_list constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("PersistentBSTMap::initializer_list constructor: both specified and different");
+
+  for(const PersistentBSTMap::Entry& i:il)
+    put(i.first,i.second);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template <class Iterable>
+PersistentBSTMap<KEY,T,tlt>::PersistentBSTMap(const Iterable& i, bool (*clt)(const KEY& a, const KEY& b))
+    :lt(tlt != (ltfunc)undefinedlt<KEY> ? tlt : clt){
+  if(lt==(ltfunc)undefinedlt<KEY>)
+    throw TemplateFunctionError("PersistentBSTMap::Iterable constructor: neither specified");
+  if(tlt!=(ltfunc)undefinedlt<KEY> && clt!=(ltfunc)undefinedlt<KEY> && tlt!=clt)
+    throw TemplateFunctionError("PersistentBSTMap::Iterable constructor: both specified and different");
+  for(const PersistentBSTMap::Entry& e:i)
+    put(e.first,e.second);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::empty() const {
+  return map== nullptr;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int PersistentBSTMap<KEY,T,tlt>::size() const {
+  return size_of(map);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::has_key (const KEY& key) const {
+  return find_key(map,key)!= nullptr;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::has_value (const T& value) const {
+  return has_value(map,value);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string PersistentBSTMap<KEY,T,tlt>::str() const {
+  std::ostringstream answer;
+  answer<<"persistent_bst_map[\n"<<string_rotated(map,"")<<"](used="<<size()<<",mod_count="<<mod_count<<")";
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::snapshot() const -> PersistentBSTMap<KEY,T,tlt> {
+  return PersistentBSTMap<KEY,T,tlt>(*this);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T PersistentBSTMap<KEY,T,tlt>::put(const KEY& key, const T& value) {
+  ++mod_count;
+  T* value_in;
+  bool added;
+  T old_value=value;                     //returned if key is added, as in BSTMap
+  map=insert(map,key,value,value_in,added,old_value);
+  return old_value;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T PersistentBSTMap<KEY,T,tlt>::erase(const KEY& key) {
+  if(find_key(map,key)== nullptr){
+    std::ostringstream answer;
+    answer << "PersistentBSTMap::erase: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  T removed;
+  map=remove(map,key,removed);
+  ++mod_count;
+  return removed;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void PersistentBSTMap<KEY,T,tlt>::clear() {
+  release(map);
+  map= nullptr;
+  mod_count++;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+template<class Iterable>
+int PersistentBSTMap<KEY,T,tlt>::put_all(const Iterable& i) {
+  int count=0;
+  for(const Entry& e : i) {
+    put(e.first, e.second);
+    count++;
+  }
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+T& PersistentBSTMap<KEY,T,tlt>::operator [] (const KEY& key) {
+  T* value_in;
+  bool added;
+  T old_value;
+  ++mod_count;                           //Even if key is there, its (shared) path might be copied
+  map=insert(map,key,T(),value_in,added,old_value);
+  if(!added)
+    *value_in=old_value;                 //insert replaced key's value with T()
+  return *value_in;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+const T& PersistentBSTMap<KEY,T,tlt>::operator [] (const KEY& key) const {
+  PN* node=find_key(map,key);
+  if(node== nullptr) {
+    std::ostringstream answer;
+    answer << "PersistentBSTMap::operator []: key(" << key << ") not in Map";
+    throw KeyError(answer.str());
+  }
+  return node->value.second;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>& PersistentBSTMap<KEY,T,tlt>::operator = (const PersistentBSTMap<KEY,T,tlt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  this->clear(); //release the old one
+  if(lt==rhs.lt)
+    map=retain(rhs.map);
+  else{
+    lt=rhs.lt;
+    for(auto e : rhs)
+      put(e.first,e.second);
+  }
+  ++mod_count;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::operator == (const PersistentBSTMap<KEY,T,tlt>& rhs) const {
+  if (this == &rhs || map==rhs.map)
+    return true;
+  if (size() != rhs.size())
+    return false;
+  for(const Entry& e : *this){
+    PN* node=rhs.find_key(rhs.map,e.first);
+    if(node== nullptr || !(node->value.second==e.second))
+      return false;
+  }
+  return true;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::operator != (const PersistentBSTMap<KEY,T,tlt>& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::ostream& operator << (std::ostream& outs, const PersistentBSTMap<KEY,T,tlt>& m) {
+  outs << "map[";
+  if(!m.empty()) {
+    auto i = m.begin();
+    outs << (*i).first << "->" << (*i).second;
+    for (++i; i != m.end(); ++i)
+      outs << "," << (*i).first << "->" << (*i).second;
+  }
+  outs << "]";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::begin () const -> PersistentBSTMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<PersistentBSTMap<KEY,T,tlt>*>(this),true);
+}
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::end () const -> PersistentBSTMap<KEY,T,tlt>::Iterator {
+  return Iterator(const_cast<PersistentBSTMap<KEY,T,tlt>*>(this),false);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::find_key (PN* root, const KEY& key) const {
+  for(PN* temp=root; temp!= nullptr; )
+    if(key == temp->value.first)
+      return temp;
+    else if(lt(key,temp->value.first))
+      temp=temp->left;
+    else
+      temp=temp->right;
+  return nullptr;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::has_value (PN* root, const T& value) const {
+  if(root== nullptr)
+    return false;
+  return root->value.second==value || has_value(root->left,value) || has_value(root->right,value);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string PersistentBSTMap<KEY,T,tlt>::string_rotated(PN* root, std::string indent) const {
+  if(root== nullptr)
+    return "";
+  std::ostringstream answer;
+  answer<<string_rotated(root->right,indent+"..");
+  answer<<indent<<root->value.first<<"->"<<root->value.second<<"(refs="<<root->refs.load()<<")\n";
+  answer<<string_rotated(root->left,indent+"..");
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::retain (PN* node) {
+  if(node!= nullptr)
+    node->refs.fetch_add(1,std::memory_order_relaxed);
+  return node;
+}
+
+
+//The thread that removes the last reference must see all other threads' uses of node as done
+//  before deleting it: so each decrement both releases and acquires
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+void PersistentBSTMap<KEY,T,tlt>::release (PN* node) {
+  while(node!= nullptr && node->refs.fetch_sub(1,std::memory_order_acq_rel)==1){
+    PN* right=node->right;
+    release(node->left);
+    delete node;
+    node=right;                          //Loop (not recur) down the right
+  }
+}
+
+
+//If refs is 1, only the caller refers to node, so no other thread can start to: it can be changed
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::own (PN* node) {
+  if(node->refs.load(std::memory_order_acquire)==1)
+    return node;
+  PN* copy=new PN(node->value,retain(node->left),retain(node->right));
+  release(node);
+  return copy;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::insert (PN* root, const KEY& key, const T& value, T*& value_in, bool& added, T& old_value) {
+  if(root== nullptr){
+    added=true;
+    root=new PN(Entry(key,value));
+    value_in=&root->value.second;
+    return root;
+  }
+  root=own(root);
+  if(key == root->value.first){
+    added=false;
+    old_value=root->value.second;
+    root->value.second=value;
+    value_in=&root->value.second;
+    return root;
+  }
+  if(lt(key,root->value.first))
+    root->left=insert(root->left,key,value,value_in,added,old_value);
+  else
+    root->right=insert(root->right,key,value,value_in,added,old_value);
+  return join(root->left,root,root->right);  //join may move (but not copy) the new/changed node
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::remove (PN* root, const KEY& key, T& removed) {
+  root=own(root);
+  if(key == root->value.first){
+    removed=root->value.second;
+    PN* l=root->left;
+    PN* r=root->right;
+    root->left=root->right= nullptr;
+    release(root);
+    return join2(l,r);
+  }
+  if(lt(key,root->value.first))
+    root->left=remove(root->left,key,removed);
+  else
+    root->right=remove(root->right,key,removed);
+  return join(root->left,root,root->right);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+int PersistentBSTMap<KEY,T,tlt>::size_of (PN* root) {
+  return root== nullptr ? 0 : root->size;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::balanced (int weight1, int weight2) {
+  long long total=(long long)weight1+weight2;
+  return ALPHA_PERCENT*total<=100LL*weight1 && ALPHA_PERCENT*total<=100LL*weight2;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::link (PN* m, PN* l, PN* r) {
+  m->left=l;
+  m->right=r;
+  m->size=1+size_of(l)+size_of(r);
+  return m;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::rotate_left (PN* root) {
+  PN* r=own(root->right);
+  return link(r, link(root,root->left,r->left), r->right);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::rotate_right (PN* root) {
+  PN* l=own(root->left);
+  return link(l, l->left, link(root,l->right,root->right));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::join (PN* l, PN* m, PN* r) {
+  int wl=size_of(l)+1, wr=size_of(r)+1;
+  if(balanced(wl,wr))
+    return link(m,l,r);
+  return wl>wr ? join_right(l,m,r) : join_left(l,m,r);
+}
+
+
+//As in BSTMap, but copying each shared node on l's right spine before changing it
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::join_right (PN* l, PN* m, PN* r) {
+  if(size_of(l)<=size_of(r) || balanced(size_of(l)+1,size_of(r)+1))
+    return link(m,l,r);
+  l=own(l);
+  PN* t=join_right(l->right,m,r);
+  int wll=size_of(l->left)+1;
+  if(balanced(wll,t->size+1))
+    return link(l,l->left,t);
+  if(t->left== nullptr || (balanced(wll,size_of(t->left)+1) && balanced(wll+size_of(t->left)+1,size_of(t->right)+1)))
+    return rotate_left(link(l,l->left,t));
+  return rotate_left(link(l,l->left,rotate_right(t)));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::join_left (PN* l, PN* m, PN* r) {
+  if(size_of(r)<=size_of(l) || balanced(size_of(l)+1,size_of(r)+1))
+    return link(m,l,r);
+  r=own(r);
+  PN* t=join_left(l,m,r->left);
+  int wrr=size_of(r->right)+1;
+  if(balanced(t->size+1,wrr))
+    return link(r,t,r->right);
+  if(t->right== nullptr || (balanced(size_of(t->right)+1,wrr) && balanced(size_of(t->left)+1,size_of(t->right)+1+wrr)))
+    return rotate_right(link(r,t,r->right));
+  return rotate_right(link(r,rotate_left(t),r->right));
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::join2 (PN* l, PN* r) {
+  if(l== nullptr)
+    return r;
+  PN* rest;
+  PN* last=split_last(l,rest);
+  return join(rest,last,r);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+typename PersistentBSTMap<KEY,T,tlt>::PN* PersistentBSTMap<KEY,T,tlt>::split_last (PN* root, PN*& rest) {
+  root=own(root);
+  if(root->right== nullptr){
+    rest=root->left;
+    root->left= nullptr;
+    return root;
+  }
+  PN* last=split_last(root->right,rest);
+  rest=join(root->left,root,rest);
+  return last;
+}
+
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>::Iterator::Iterator(PersistentBSTMap<KEY,T,tlt>* iterate_over, bool from_begin)
+: ref_map(iterate_over),expected_mod_count(ref_map->mod_count){
+  if(from_begin)
+    for(PN* node=ref_map->map; node!= nullptr; node=node->left)
+      path.push(node);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+PersistentBSTMap<KEY,T,tlt>::Iterator::~Iterator()
+{}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::Iterator::current() const -> PN* {
+  return path.empty() ? nullptr : path.peek();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::Iterator::erase() -> Entry {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("PersistentBSTMap::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("PersistentBSTMap::Iterator::erase Iterator cursor already erased");
+  if(path.empty())
+    throw CannotEraseError("PersistentBSTMap::Iterator::erase Iterator cursor beyond data structure");
+  Entry to_erase=path.peek()->value;
+  //erase copies (or frees) the nodes on the path to the erased one: walk down to the next key again
+  for(PN* node=path.pop()->right; node!= nullptr; node=node->left)
+    path.push(node);
+  can_erase=false;
+  bool at_end=path.empty();
+  KEY next_key=(at_end ? to_erase.first : path.peek()->value.first);
+  ref_map->erase(to_erase.first);
+  path.clear();
+  if(!at_end) {
+    for(PN* node=ref_map->map; node!= nullptr; )
+      if(ref_map->lt(node->value.first,next_key))
+        node=node->right;
+      else{
+        path.push(node);
+        if(next_key == node->value.first)
+          break;
+        node=node->left;
+      }
+  }
+  expected_mod_count=ref_map->mod_count;
+  return to_erase;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+std::string PersistentBSTMap<KEY,T,tlt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_map->str() << "/current=";
+  if(path.empty())
+    answer << "end";
+  else
+    answer << path.peek()->value.first << "->" << path.peek()->value.second;
+  answer << "/expected_mod_count=" << expected_mod_count << "/can_erase=" << can_erase;
+  return answer.str();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto  PersistentBSTMap<KEY,T,tlt>::Iterator::operator ++ () -> PersistentBSTMap<KEY,T,tlt>::Iterator& {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("PersistentBSTMap::Iterator::operator ++");
+  if(path.empty())
+    return *this;
+  if(can_erase)
+    for(PN* node=path.pop()->right; node!= nullptr; node=node->left)
+      path.push(node);
+  else
+    can_erase=true;
+  return *this;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::Iterator::operator ++ (int) -> PersistentBSTMap<KEY,T,tlt>::Iterator {
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("PersistentBSTMap::Iterator::operator ++");
+  if(path.empty())
+    return *this;
+  Iterator to_return(*this);
+  ++(*this);
+  return to_return;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::Iterator::operator == (const PersistentBSTMap<KEY,T,tlt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("PersistentBSTMap::Iterator::operator ==");
+  if (expected_mod_count != ref_map->mod_count)
+    throw ConcurrentModificationError("PersistentBSTMap::Iterator::operator ==");
+  if (ref_map != rhsASI->ref_map)
+    throw ComparingDifferentIteratorsError("PersistentBSTMap::Iterator::operator ==");
+  return current()==rhsASI->current();
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+bool PersistentBSTMap<KEY,T,tlt>::Iterator::operator != (const PersistentBSTMap<KEY,T,tlt>::Iterator& rhs) const {
+  return !(*this==rhs);
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::Iterator::operator *() const -> const Entry& {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("PersistentBSTMap::Iterator::operator *");
+  if (!can_erase || path.empty()) {
+    std::ostringstream where;
+    where << (path.empty() ? "end" : "erased") << " when size = " << ref_map->size();
+    throw IteratorPositionIllegal("PersistentBSTMap::Iterator::operator * Iterator illegal: "+where.str());
+  }
+  return path.peek()->value;
+}
+
+
+template<class KEY,class T, bool (*tlt)(const KEY& a, const KEY& b)>
+auto PersistentBSTMap<KEY,T,tlt>::Iterator::operator ->() const -> const Entry* {
+  if (expected_mod_count !=  ref_map->mod_count)
+    throw ConcurrentModificationError("PersistentBSTMap::Iterator::operator ->");
+  if (!can_erase || path.empty()) {
+    std::ostringstream where;
+    where << (path.empty() ? "end" : "erased") << " when size = " << ref_map->size();
+    throw IteratorPositionIllegal("PersistentBSTMap::Iterator::operator -> Iterator illegal: "+where.str());
+  }
+  return &path.peek()->value;
+}
+
+
+}
+
+#endif /* PERSISTENT_BST_MAP_HPP_ */
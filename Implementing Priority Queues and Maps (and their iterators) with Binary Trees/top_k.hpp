@@ -0,0 +1,360 @@
+#ifndef TOP_K_HPP_
+#define TOP_K_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include "ics_exceptions.hpp"
+#include <utility>              //For std::move/std::swap functions
+#include <algorithm>            //For std::max/std::min
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+//Collects the k highest-priority values of a stream of values, where tgt(a,b) is true iff a has
+//  higher priority than b (supplied as in HeapPriorityQueue: by the template, the constructor, or
+//  both if they are the same function; otherwise TemplateFunctionError is raised).
+//
+//It stores only k values, in a heap whose root is the lowest-priority value kept: a new value is
+//  kept only if it has higher priority than that root, which it replaces. So collecting the top k
+//  of N values costs O(N log k) time (O(N) when most values are rejected) and O(k) space, unlike
+//  a HeapPriorityQueue of all N values. For example
+//    TopK<CorpusEntry> best(10, corpus, entry_gt);  //Streams the entries of corpus through best
+//    for (const CorpusEntry& e : best) ...          //The 10 highest-priority entries, highest first
+//
+//Iterating (begin) first sorts the values kept, highest priority first, in place; a later enqueue
+//  reforms the heap. So begin/end are not const: a TopK must not be iterated while another thread
+//  uses it (operator << iterates over a sorted copy instead). Ties with the lowest-priority value
+//  kept do not displace it (the earlier one stays).
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class TopK {
+  public:
+    typedef bool (*gtfunc) (const T& a, const T& b);
+
+    //Destructor/Constructors
+    ~TopK();
+
+    explicit TopK(int k, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    TopK(const TopK<T,tgt>& to_copy);
+    explicit TopK(int k, const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit TopK(int k, const Iterable& i, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    int  capacity   () const;           //k
+    const T& lowest () const;           //Lowest-priority value kept: a value must beat it to be kept
+    std::string str () const;           //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    int  enqueue (const T& element);    //Returns 1 if element is kept (among the top k so far), else 0
+    void clear   ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    TopK<T,tgt>& operator = (const TopK<T,tgt>& rhs);
+
+    template<class T2, bool (*gt2)(const T2& a, const T2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const TopK<T2,gt2>& t);
+
+
+    //The values kept, highest priority first (begin sorts them in place)
+    const T* begin ();
+    const T* end   ();
+
+
+  private:
+    bool (*gt) (const T& a, const T& b); //The gt used by enqueue (from template or constructor)
+    int k;                               //Most values kept
+    T* kept;                             //Heap with the lowest-priority value at the root (or sorted)
+    int length    = 0;                   //Physical length of array: grows (doubling) up to k
+    int used      = 0;                   //Amount of array used: invariant: 0 <= used <= length <= k
+    bool sorted   = false;               //kept is sorted (highest priority first), not a heap
+
+    //Helper methods
+    void ensure_length  (int new_length);
+    bool lower          (const T& a, const T& b) const; //a has lower priority: nearer the root
+    void percolate_up   (int i);
+    void percolate_down (int i, int used);              //Within kept[0..used-1]
+    void heapify        ();
+    void sort           ();
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//TopK class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+TopK<T,tgt>::~TopK() {
+  delete [] kept;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+TopK<T,tgt>::TopK(int k, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt), k(std::max(0,k)) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("TopK::k constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("TopK::k constructor: both specified and different");
+  kept = new T[length];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+TopK<T,tgt>::TopK(const TopK<T,tgt>& to_copy)
+: gt(to_copy.gt), k(to_copy.k), length(to_copy.used), used(to_copy.used), sorted(to_copy.sorted) {
+  kept = new T[length];
+  for (int i=0; i<used; ++i)
+    kept[i] = to_copy.kept[i];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+TopK<T,tgt>::TopK(int k, const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt), k(std::max(0,k)) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("TopK::initializer_list constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("TopK::initializer_list constructor: both specified and different");
+  kept = new T[length];
+  for (const T& pq_elem : il)
+    enqueue(pq_elem);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+TopK<T,tgt>::TopK(int k, const Iterable& i, bool (*cgt)(const T& a, const T& b))
+: gt(tgt != (gtfunc)undefinedgt<T> ? tgt : cgt), k(std::max(0,k)) {
+  if (gt == (gtfunc)undefinedgt<T>)
+    throw TemplateFunctionError("TopK::Iterable constructor: neither specified");
+  if (tgt != (gtfunc)undefinedgt<T> && cgt != (gtfunc)undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("TopK::Iterable constructor: both specified and different");
+  kept = new T[length];
+  enqueue_all(i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool TopK<T,tgt>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int TopK<T,tgt>::size() const {
+  return used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int TopK<T,tgt>::capacity() const {
+  return k;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T& TopK<T,tgt>::lowest () const {
+  if (empty())
+    throw EmptyError("TopK::lowest");
+  return sorted ? kept[used-1] : kept[0];
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string TopK<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "top_k[";
+  for (int i=0; i<used; ++i)
+    answer << (i == 0 ? "" : ",") << i << ":" << kept[i];
+  answer << "](k=" << k << ",length=" << length << ",used=" << used << ",sorted=" << sorted << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int TopK<T,tgt>::enqueue(const T& element) {
+  if (sorted)
+    heapify();
+  if (used < k) {
+    ensure_length(used+1);
+    kept[used] = element;
+    percolate_up(used++);
+    return 1;
+  }
+  if (k == 0 || !gt(element,kept[0]))
+    return 0;
+  kept[0] = element;
+  percolate_down(0,used);
+  return 1;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void TopK<T,tgt>::clear() {
+  used   = 0;
+  sorted = false;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+int TopK<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+TopK<T,tgt>& TopK<T,tgt>::operator = (const TopK<T,tgt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  gt = rhs.gt;
+  k  = rhs.k;
+  ensure_length(rhs.used);
+  used   = rhs.used;
+  sorted = rhs.sorted;
+  for (int i=0; i<used; ++i)
+    kept[i] = rhs.kept[i];
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::ostream& operator << (std::ostream& outs, const TopK<T,tgt>& t) {
+  outs << "top_k[";
+  bool first = true;
+  TopK<T,tgt> in_order(t);                     //Iterating sorts; t is const
+  for (const T& v : in_order) {
+    outs << (first ? "" : ",") << v;
+    first = false;
+  }
+  outs << "]:k=" << t.k;
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterating
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T* TopK<T,tgt>::begin () {
+  sort();
+  return kept;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+const T* TopK<T,tgt>::end () {
+  return kept+used;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void TopK<T,tgt>::ensure_length(int new_length) {
+  if (length >= new_length)
+    return;
+  T* kept_old = kept;
+  length = std::min(k, std::max(new_length, 2*length));
+  kept = new T[length];
+  for (int i=0; i<used; ++i)
+    kept[i] = std::move(kept_old[i]);
+  delete [] kept_old;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool TopK<T,tgt>::lower(const T& a, const T& b) const
+{return gt(b,a);}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void TopK<T,tgt>::percolate_up(int i) {
+  T moving = std::move(kept[i]);
+  for (/*parameter*/; i > 0 && lower(moving,kept[(i-1)/2]); i=(i-1)/2)
+    kept[i] = std::move(kept[(i-1)/2]);
+  kept[i] = std::move(moving);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void TopK<T,tgt>::percolate_down(int i, int used) {
+  T moving = std::move(kept[i]);
+  for (int c=2*i+1; c < used; c=2*i+1) {
+    if (c+1 < used && lower(kept[c+1],kept[c]))
+      ++c;
+    if (!lower(kept[c],moving))
+      break;
+    kept[i] = std::move(kept[c]);
+    i = c;
+  }
+  kept[i] = std::move(moving);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void TopK<T,tgt>::heapify() {
+  for (int i=used/2-1; i >= 0; --i)
+    percolate_down(i,used);
+  sorted = false;
+}
+
+
+//Heapsort: repeatedly swap the lowest-priority value (the root) to the end of the shrinking heap,
+//  leaving the highest-priority value first
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void TopK<T,tgt>::sort() {
+  if (sorted)
+    return;
+  for (int n=used-1; n > 0; --n) {
+    std::swap(kept[0],kept[n]);
+    percolate_down(0,n);
+  }
+  sorted = true;
+}
+
+}
+
+#endif /* TOP_K_HPP_ */
@@ -0,0 +1,67 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include "heap_priority_queue.hpp"
+#include "top_k.hpp"
+
+
+//Two ways to find the k highest-priority of N (word,count) entries, like the most frequent words
+//  of a corpus: build a 4-ary HeapPriorityQueue of all N entries and iterate partial_sorted(k);
+//  or stream the N entries through a TopK of k (which keeps only k of them). Times include the
+//  build/stream and iterating the k entries in priority order.
+
+const int N = 10000000;
+
+struct Entry {
+  std::string word;
+  int         count;
+};
+std::ostream& operator << (std::ostream& outs, const Entry& e) {return outs << e.word;}
+bool entry_gt(const Entry& a, const Entry& b) {return a.count > b.count || (a.count == b.count && a.word < b.word);}
+
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+int main() {
+  std::mt19937 random(1);
+  std::vector<Entry> entries(N);
+  for (Entry& e : entries) {
+    e.word  = "w" + std::to_string(random()%100000000);
+    e.count = random() % 1000000;
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  ics::HeapPriorityQueue<Entry,entry_gt,4> pq(entries);
+  double build = ms_since(start);
+  std::cout << "HeapPriorityQueue of all " << N << " entries built in " << build << " ms" << std::endl;
+
+  for (int k : {10, 1000, 100000}) {
+    long long heap_sum = 0, top_sum = 0;
+    start = std::chrono::steady_clock::now();
+    for (const Entry& e : pq.partial_sorted(k))
+      heap_sum += e.count;
+    double walk = ms_since(start);
+
+    start = std::chrono::steady_clock::now();
+    ics::TopK<Entry,entry_gt> top(k,entries);
+    for (const Entry& e : top)
+      top_sum += e.count;
+    double stream = ms_since(start);
+
+    std::cout << "k=" << k << "  heap build+partial_sorted " << build+walk << " ms (partial_sorted "
+              << walk << " ms)  TopK " << stream << " ms" << (heap_sum == top_sum ? "" : "  (DIFFERENT)") << std::endl;
+  }
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2):
+//HeapPriorityQueue of all 10000000 entries built in 534 ms
+//k=10      heap build+partial_sorted 534 ms (partial_sorted  0.02 ms)  TopK  76 ms
+//k=1000    heap build+partial_sorted 534 ms (partial_sorted  0.40 ms)  TopK  70 ms
+//k=100000  heap build+partial_sorted 614 ms (partial_sorted 80.7 ms)   TopK 311 ms
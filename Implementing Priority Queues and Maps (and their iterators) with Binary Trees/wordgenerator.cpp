@@ -14,7 +14,6 @@
 #include "array_priority_queue.hpp"
 #include "array_set.hpp"
 #include "array_map.hpp"
-#include "heap_priority_queue.hpp"
 #include "bst_map.hpp"
 
 
@@ -48,13 +47,7 @@ bool queue_lt(const WordQueue& a, const WordQueue& b) {
   return false;
 }
 
-typedef ics::BSTMap<WordQueue,FollowSet,queue_lt>   Corpus;
-
-bool CorpusEntry_gt(const CorpusEntry& a, const CorpusEntry& b) {
-  return queue_lt(a.first,b.first); // reverse of lt for queues
-}
-
-typedef ics::HeapPriorityQueue<CorpusEntry,CorpusEntry_gt> CorpusPQ;
+typedef ics::BSTMap<WordQueue,FollowSet,queue_lt>   Corpus;     //Iterates in queue_lt order: no CorpusPQ needed to sort it
 
 
 
@@ -100,10 +93,9 @@ Corpus read_corpus(int os, std::ifstream &file) {
 
 void print_corpus(const Corpus& corpus) {
   std::cout << "\nCorpus of " << corpus.size() << " entries" << std::endl;
-  CorpusPQ words_sorted(corpus, CorpusEntry_gt);
   s_sort.stop();
   int min = std::numeric_limits<int>::max(), max = 0;
-  for (const CorpusEntry& kv : words_sorted) {
+  for (const CorpusEntry& kv : corpus) {
     std::cout << "  " << kv.first << " can be followed by any of " << kv.second << std::endl;
     if (kv.second.size() < min) min = kv.second.size();
     if (kv.second.size() > max) max = kv.second.size();
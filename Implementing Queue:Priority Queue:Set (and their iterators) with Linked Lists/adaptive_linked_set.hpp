@@ -0,0 +1,727 @@
+#ifndef ADAPTIVE_LINKED_SET_HPP_
+#define ADAPTIVE_LINKED_SET_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <utility>              //For std::move
+#include "ics_exceptions.hpp"
+
+
+namespace ics {
+
+
+#ifndef undefinedhashdefined
+#define undefinedhashdefined
+template<class T>
+int undefinedhash (const T& a) {return 0;}
+#endif /* undefinedhashdefined */
+
+//Instantiate the templated class supplying thash(a): produces a hash value for a.
+//If thash is defaulted to undefinedhash in the template, then a constructor must supply chash.
+//If both thash and chash are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedhash value supplied by thash/chash is stored in the instance variable hash.
+//
+//A LinkedSet (same interface, insertion-order Iterator, and trailer LN) that stays a plain linked
+//  list while it is small, where scanning a few LNs beats hashing, and above index_threshold values
+//  also links its LNs into the chains of a hash index, so contains/insert/erase are O(1) expected
+//  instead of O(N) (and insert_all/contains_all/retain_all/== are not quadratic). The index has at
+//  least as many bins as values (doubling as the set grows, halving as it shrinks) and is dropped
+//  when the set shrinks to index_threshold/2 values (not index_threshold, so a set whose size
+//  hovers around index_threshold does not build and drop its index over and over).
+//See adaptive_set_benchmark.cpp for how DEFAULT_INDEX_THRESHOLD was chosen.
+template<class T, int (*thash)(const T& a) = undefinedhash<T>> class AdaptiveLinkedSet {
+  public:
+    typedef int (*hashfunc) (const T& a);
+
+    static const int DEFAULT_INDEX_THRESHOLD = 8;
+
+    //Destructor/Constructors
+    ~AdaptiveLinkedSet();
+
+    AdaptiveLinkedSet          (int the_index_threshold = DEFAULT_INDEX_THRESHOLD, int (*chash)(const T& a) = undefinedhash<T>);
+    AdaptiveLinkedSet          (const AdaptiveLinkedSet<T,thash>& to_copy, int (*chash)(const T& a) = undefinedhash<T>);
+    explicit AdaptiveLinkedSet (const std::initializer_list<T>& il, int the_index_threshold = DEFAULT_INDEX_THRESHOLD, int (*chash)(const T& a) = undefinedhash<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit AdaptiveLinkedSet (const Iterable& i, int the_index_threshold = DEFAULT_INDEX_THRESHOLD, int (*chash)(const T& a) = undefinedhash<T>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    bool contains   (const T& element) const;
+    bool indexed    () const;  //true iff the hash index is in use
+    std::string str () const;  //supplies useful debugging information; contrast to operator <<
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    bool contains_all (const Iterable& i) const;
+
+
+    //Commands
+    int  insert (const T& element);
+    int  erase  (const T& element);
+    void clear  ();
+
+    //Iterable class must support "for" loop: .begin()/.end() and prefix ++ on returned result
+
+    template <class Iterable>
+    int insert_all(const Iterable& i);
+
+    template <class Iterable>
+    int erase_all(const Iterable& i);
+
+    template<class Iterable>
+    int retain_all(const Iterable& i);
+
+
+    //Operators
+    AdaptiveLinkedSet<T,thash>& operator = (const AdaptiveLinkedSet<T,thash>& rhs);
+    bool operator == (const AdaptiveLinkedSet<T,thash>& rhs) const;
+    bool operator != (const AdaptiveLinkedSet<T,thash>& rhs) const;
+    bool operator <= (const AdaptiveLinkedSet<T,thash>& rhs) const;
+    bool operator <  (const AdaptiveLinkedSet<T,thash>& rhs) const;
+    bool operator >= (const AdaptiveLinkedSet<T,thash>& rhs) const;
+    bool operator >  (const AdaptiveLinkedSet<T,thash>& rhs) const;
+
+    template<class T2, int (*hash2)(const T2& a)>
+    friend std::ostream& operator << (std::ostream& outs, const AdaptiveLinkedSet<T2,hash2>& s);
+
+
+
+  private:
+    class LN;
+
+  public:
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of AdaptiveLinkedSet<T,thash>
+        ~Iterator();
+        T           erase();
+        std::string str  () const;
+        AdaptiveLinkedSet<T,thash>::Iterator& operator ++ ();
+        AdaptiveLinkedSet<T,thash>::Iterator  operator ++ (int);
+        bool operator == (const AdaptiveLinkedSet<T,thash>::Iterator& rhs) const;
+        bool operator != (const AdaptiveLinkedSet<T,thash>::Iterator& rhs) const;
+        T& operator *  () const;
+        T* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const AdaptiveLinkedSet<T,thash>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+        friend Iterator AdaptiveLinkedSet<T,thash>::begin () const;
+        friend Iterator AdaptiveLinkedSet<T,thash>::end   () const;
+
+      private:
+        //If can_erase is false, current indexes the "next" value (must ++ to reach it)
+        LN*                         current;  //if can_erase is false, this value is unusable
+        AdaptiveLinkedSet<T,thash>* ref_set;
+        int                         expected_mod_count;
+        bool                        can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(AdaptiveLinkedSet<T,thash>* iterate_over, LN* initial);
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    //hash_code and chain are used only while the set is indexed
+    class LN {
+      public:
+        LN ()                      {}
+        LN (T v,  LN* n = nullptr) : value(v), next(n){}
+
+        T   value;
+        LN* next      = nullptr;
+        int hash_code = 0;         //hash(value), so rebuilding the index does not rehash values
+        LN* chain     = nullptr;   //Next LN in the same bin
+    };
+
+public:
+  int (*hash)(const T& k);         //Hashing function used (from template or constructor)
+private:
+  LN*  front     = nullptr;        //Allocated (as the trailer) once the constructor's checks pass
+  LN*  trailer   = nullptr;        //Always point to the special trailer LN
+  int  used      = 0;              //Cache the number of values in linked list
+  int  mod_count = 0;              //For sensing concurrent modification
+  int  index_threshold;            //Index the set when used > index_threshold
+  LN** index     = nullptr;        //Array of bins (each a chain of LNs), or nullptr when not indexed
+  int  bins      = 0;              //# bins in index (a power of 2)
+  int  bin_shift = 32;             //32-log2(bins): see hash_compress
+
+  //Helper methods
+  int  hash_compress   (int hash_code) const;  //hash_code ranged to [0,bins-1]
+  LN*  find_element    (const T& element, int& hash_code) const; //Returns element's LN or nullptr (and hash(element) if indexed)
+  void index_add       (LN* ln);
+  void index_remove    (LN* ln);
+  void rebuild_index   (int new_bins);           //new_bins == 0 drops the index
+  void ensure_index    ();                       //Build/grow/shrink/drop the index to suit used
+  int  erase_at        (LN* p);
+  void delete_list     ();                       //Deallocate all LNs (but trailer) and the index
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//AdaptiveLinkedSet class and related definitions
+
+//Destructor/Constructors
+
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>::~AdaptiveLinkedSet() {
+  delete_list();
+  delete front;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>::AdaptiveLinkedSet(int the_index_threshold, int (*chash)(const T& a))
+    : hash(thash != (hashfunc)undefinedhash<T> ? thash : chash), index_threshold(the_index_threshold) {
+  if (hash == (hashfunc)undefinedhash<T>)
+    throw TemplateFunctionError("AdaptiveLinkedSet::default constructor: neither specified");
+  if (thash != (hashfunc)undefinedhash<T> && chash != (hashfunc)undefinedhash<T> && thash != chash)
+    throw TemplateFunctionError("AdaptiveLinkedSet::default constructor: both specified and different");
+  front = trailer = new LN();
+}
+
+
+//Copies the values in order (they are already unique), then indexes them at once
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>::AdaptiveLinkedSet(const AdaptiveLinkedSet<T,thash>& to_copy, int (*chash)(const T& a))
+    : hash(thash != (hashfunc)undefinedhash<T> ? thash : chash), index_threshold(to_copy.index_threshold) {
+  if (hash == (hashfunc)undefinedhash<T>)
+    hash = to_copy.hash;
+  if (thash != (hashfunc)undefinedhash<T> && chash != (hashfunc)undefinedhash<T> && thash != chash)
+    throw TemplateFunctionError("AdaptiveLinkedSet::copy constructor: both specified and different");
+  front = trailer = new LN();
+  for (LN* p = to_copy.front; p != to_copy.trailer; p = p->next) {
+    trailer->value = p->value;
+    trailer = trailer->next = new LN();
+    ++used;
+  }
+  ensure_index();
+}
+
+
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>::AdaptiveLinkedSet(const std::initializer_list<T>& il, int the_index_threshold, int (*chash)(const T& a))
+    : hash(thash != (hashfunc)undefinedhash<T> ? thash : chash), index_threshold(the_index_threshold) {
+  if (hash == (hashfunc)undefinedhash<T>)
+    throw TemplateFunctionError("AdaptiveLinkedSet::initializer_list constructor: neither specified");
+  if (thash != (hashfunc)undefinedhash<T> && chash != (hashfunc)undefinedhash<T> && thash != chash)
+    throw TemplateFunctionError("AdaptiveLinkedSet::initializer_list constructor: both specified and different");
+  front = trailer = new LN();
+  insert_all(il);
+}
+
+
+template<class T, int (*thash)(const T& a)>
+template<class Iterable>
+AdaptiveLinkedSet<T,thash>::AdaptiveLinkedSet(const Iterable& i, int the_index_threshold, int (*chash)(const T& a))
+    : hash(thash != (hashfunc)undefinedhash<T> ? thash : chash), index_threshold(the_index_threshold) {
+  if (hash == (hashfunc)undefinedhash<T>)
+    throw TemplateFunctionError("AdaptiveLinkedSet::Iterable constructor: neither specified");
+  if (thash != (hashfunc)undefinedhash<T> && chash != (hashfunc)undefinedhash<T> && thash != chash)
+    throw TemplateFunctionError("AdaptiveLinkedSet::Iterable constructor: both specified and different");
+  front = trailer = new LN();
+  insert_all(i);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+int AdaptiveLinkedSet<T,thash>::size() const {
+  return used;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::contains (const T& element) const {
+  int hash_code;
+  return find_element(element,hash_code) != nullptr;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::indexed () const {
+  return index != nullptr;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+std::string AdaptiveLinkedSet<T,thash>::str() const {
+  std::ostringstream answer;
+  answer << "adaptive_linked_set[";
+  for (LN* p = front; p != trailer; p = p->next)
+    answer << p->value << (index != nullptr ? "@" : "") << (index != nullptr ? hash_compress(p->hash_code) : -1) << "->";
+  answer << "TRAILER](used=" << used << ",index_threshold=" << index_threshold << ",bins=" << bins
+         << ",front=" << front << ",trailer=" << trailer << ",mod_count=" << mod_count << ")";
+  return answer.str();
+}
+
+
+template<class T, int (*thash)(const T& a)>
+template<class Iterable>
+bool AdaptiveLinkedSet<T,thash>::contains_all (const Iterable& i) const {
+  for (const T& v : i)
+    if (!contains(v))
+      return false;
+  return true;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+//element is stored in the trailer LN, and a new trailer LN is linked after it
+template<class T, int (*thash)(const T& a)>
+int AdaptiveLinkedSet<T,thash>::insert(const T& element) {
+  int hash_code;
+  if (find_element(element,hash_code) != nullptr)
+    return 0;
+  LN* ln = trailer;
+  ln->value = element;
+  trailer = trailer->next = new LN();
+  ++used;
+  ++mod_count;
+  if (index != nullptr) {
+    ln->hash_code = hash_code;
+    index_add(ln);
+  }
+  ensure_index();
+  return 1;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+int AdaptiveLinkedSet<T,thash>::erase(const T& element) {
+  int hash_code;
+  LN* p = find_element(element,hash_code);
+  return p == nullptr ? 0 : erase_at(p);
+}
+
+
+template<class T, int (*thash)(const T& a)>
+void AdaptiveLinkedSet<T,thash>::clear() {
+  delete_list();
+  ++mod_count;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+template<class Iterable>
+int AdaptiveLinkedSet<T,thash>::insert_all(const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += insert(v);
+  return count;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+template<class Iterable>
+int AdaptiveLinkedSet<T,thash>::erase_all(const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += erase(v);
+  return count;
+}
+
+
+//erase_at(p) moves the next value into p, so p is checked again
+template<class T, int (*thash)(const T& a)>
+template<class Iterable>
+int AdaptiveLinkedSet<T,thash>::retain_all(const Iterable& i) {
+  AdaptiveLinkedSet<T,thash> s(i,index_threshold,hash);
+  int count = 0;
+  for (LN* p = front; p != trailer; /*see body*/)
+    if (!s.contains(p->value)) {
+      erase_at(p);
+      ++count;
+    }else
+      p = p->next;
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>& AdaptiveLinkedSet<T,thash>::operator = (const AdaptiveLinkedSet<T,thash>& rhs) {
+  if (this == &rhs)
+    return *this;
+  delete_list();
+  hash            = rhs.hash;
+  index_threshold = rhs.index_threshold;
+  for (LN* p = rhs.front; p != rhs.trailer; p = p->next) {
+    trailer->value = p->value;
+    trailer = trailer->next = new LN();
+    ++used;
+  }
+  ensure_index();
+  ++mod_count;
+  return *this;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::operator == (const AdaptiveLinkedSet<T,thash>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (used != rhs.used)
+    return false;
+  for (LN* p = front; p != trailer; p = p->next)
+    if (!rhs.contains(p->value))
+      return false;
+  return true;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::operator != (const AdaptiveLinkedSet<T,thash>& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::operator <= (const AdaptiveLinkedSet<T,thash>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (used > rhs.used)
+    return false;
+  for (LN* p = front; p != trailer; p = p->next)
+    if (!rhs.contains(p->value))
+      return false;
+  return true;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::operator < (const AdaptiveLinkedSet<T,thash>& rhs) const {
+  if (this == &rhs)
+    return false;
+  if (used >= rhs.used)
+    return false;
+  for (LN* p = front; p != trailer; p = p->next)
+    if (!rhs.contains(p->value))
+      return false;
+  return true;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::operator >= (const AdaptiveLinkedSet<T,thash>& rhs) const {
+  return rhs <= *this;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::operator > (const AdaptiveLinkedSet<T,thash>& rhs) const {
+  return rhs < *this;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+std::ostream& operator << (std::ostream& outs, const AdaptiveLinkedSet<T,thash>& s) {
+  outs << "set[";
+  for (typename AdaptiveLinkedSet<T,thash>::LN* p = s.front; p != s.trailer; p = p->next)
+    outs << (p == s.front ? "" : ",") << p->value;
+  outs << "]";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+template<class T, int (*thash)(const T& a)>
+auto AdaptiveLinkedSet<T,thash>::begin () const -> AdaptiveLinkedSet<T,thash>::Iterator {
+  return Iterator(const_cast<AdaptiveLinkedSet<T,thash>*>(this),front);
+}
+
+
+template<class T, int (*thash)(const T& a)>
+auto AdaptiveLinkedSet<T,thash>::end () const -> AdaptiveLinkedSet<T,thash>::Iterator {
+  return Iterator(const_cast<AdaptiveLinkedSet<T,thash>*>(this),trailer);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//Fibonacci hashing: the multiply mixes all of hash_code's bits into the top bits kept, so hash
+//  functions whose low bits are poor (e.g., multiples of 8) still spread over the bins
+template<class T, int (*thash)(const T& a)>
+int AdaptiveLinkedSet<T,thash>::hash_compress (int hash_code) const {
+  unsigned int mixed = (unsigned int)hash_code * 2654435769u;
+  return bin_shift == 32 ? 0 : int(mixed >> bin_shift);
+}
+
+
+template<class T, int (*thash)(const T& a)>
+auto AdaptiveLinkedSet<T,thash>::find_element (const T& element, int& hash_code) const -> LN* {
+  if (index != nullptr) {
+    hash_code = hash(element);
+    for (LN* p = index[hash_compress(hash_code)]; p != nullptr; p = p->chain)
+      if (p->hash_code == hash_code && p->value == element)
+        return p;
+  }else
+    for (LN* p = front; p != trailer; p = p->next)
+      if (p->value == element)
+        return p;
+  return nullptr;
+}
+
+
+//ln->hash_code must be hash(ln->value)
+template<class T, int (*thash)(const T& a)>
+void AdaptiveLinkedSet<T,thash>::index_add (LN* ln) {
+  LN*& bin  = index[hash_compress(ln->hash_code)];
+  ln->chain = bin;
+  bin       = ln;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+void AdaptiveLinkedSet<T,thash>::index_remove (LN* ln) {
+  LN** link = &index[hash_compress(ln->hash_code)];
+  while (*link != ln)
+    link = &(*link)->chain;
+  *link = ln->chain;
+}
+
+
+//Hashes each value only when it was not already indexed (its hash_code is then stale)
+template<class T, int (*thash)(const T& a)>
+void AdaptiveLinkedSet<T,thash>::rebuild_index (int new_bins) {
+  bool had_index = index != nullptr;
+  delete [] index;
+  index = nullptr;
+  bins  = new_bins;
+  bin_shift = 32;
+  for (int b = bins; b > 1; b >>= 1)
+    --bin_shift;
+  if (new_bins == 0)
+    return;
+  index = new LN*[bins]();
+  for (LN* p = front; p != trailer; p = p->next) {
+    if (!had_index)
+      p->hash_code = hash(p->value);
+    index_add(p);
+  }
+}
+
+
+//Indexed: bins in [used,4*used] (a power of 2); not indexed when used <= index_threshold/2
+template<class T, int (*thash)(const T& a)>
+void AdaptiveLinkedSet<T,thash>::ensure_index () {
+  if (index == nullptr) {
+    if (used > index_threshold) {
+      int new_bins = 1;
+      while (new_bins < 2*used)
+        new_bins *= 2;
+      rebuild_index(new_bins);
+    }
+  }else if (used <= index_threshold/2)
+    rebuild_index(0);
+  else if (used > bins)
+    rebuild_index(2*bins);
+  else if (4*used < bins && bins > 1)
+    rebuild_index(bins/2);
+}
+
+
+//Erase p's value by moving the next LN's value (and hash_code) into p and deleting the next LN,
+//  so an Iterator at p is then at the value after the erased one; when indexed, both LNs leave
+//  their bins and p rejoins the bin of the value it now holds
+template<class T, int (*thash)(const T& a)>
+int AdaptiveLinkedSet<T,thash>::erase_at(LN* p) {
+  LN* to_delete = p->next;
+  if (index != nullptr) {
+    index_remove(p);
+    if (to_delete != trailer)
+      index_remove(to_delete);
+  }
+  p->value     = std::move(to_delete->value);
+  p->hash_code = to_delete->hash_code;
+  p->next      = to_delete->next;
+  if (to_delete == trailer)
+    trailer = p;
+  else if (index != nullptr)
+    index_add(p);
+  delete to_delete;
+  --used;
+  ++mod_count;
+  ensure_index();
+  return 1;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+void AdaptiveLinkedSet<T,thash>::delete_list() {
+  while (front != trailer) {
+    LN* to_delete = front;
+    front = front->next;
+    delete to_delete;
+  }
+  delete [] index;
+  index = nullptr;
+  bins  = 0;
+  bin_shift = 32;
+  used  = 0;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>::Iterator::Iterator(AdaptiveLinkedSet<T,thash>* iterate_over, LN* initial)
+:current(initial), ref_set(iterate_over), expected_mod_count(iterate_over->mod_count) {
+}
+
+
+template<class T, int (*thash)(const T& a)>
+AdaptiveLinkedSet<T,thash>::Iterator::~Iterator()
+{}
+
+
+template<class T, int (*thash)(const T& a)>
+T AdaptiveLinkedSet<T,thash>::Iterator::erase() {
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("AdaptiveLinkedSet::Iterator::erase Iterator cursor already erased");
+  if (current == ref_set->trailer)
+    throw CannotEraseError("AdaptiveLinkedSet::Iterator::erase Iterator cursor beyond data structure");
+  can_erase = false;
+  T to_return = current->value;
+  ref_set->erase_at(current);
+  expected_mod_count = ref_set->mod_count;
+  return to_return;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+std::string AdaptiveLinkedSet<T,thash>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_set->str() << "(current=";
+  current == ref_set->trailer ? answer << "TRAILER" : answer << current->value;
+  answer << ",expected_mod_count=" << expected_mod_count << ",can_erase=" << can_erase << ")";
+  return answer.str();
+}
+
+
+template<class T, int (*thash)(const T& a)>
+auto AdaptiveLinkedSet<T,thash>::Iterator::operator ++ () -> AdaptiveLinkedSet<T,thash>::Iterator& {
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::operator ++");
+  if (current == ref_set->trailer)
+    return *this;
+  if (can_erase)
+    current = current->next;
+  else
+    can_erase = true;
+  return *this;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+auto AdaptiveLinkedSet<T,thash>::Iterator::operator ++ (int) -> AdaptiveLinkedSet<T,thash>::Iterator {
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::operator ++(int)");
+  if (current == ref_set->trailer)
+    return *this;
+  Iterator to_return(*this);
+  if (can_erase)
+    current = current->next;
+  else
+    can_erase = true;
+  return to_return;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::Iterator::operator == (const AdaptiveLinkedSet<T,thash>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("AdaptiveLinkedSet::Iterator::operator ==");
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::operator ==");
+  if (ref_set != rhsASI->ref_set)
+    throw ComparingDifferentIteratorsError("AdaptiveLinkedSet::Iterator::operator ==");
+  return current == rhsASI->current;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+bool AdaptiveLinkedSet<T,thash>::Iterator::operator != (const AdaptiveLinkedSet<T,thash>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("AdaptiveLinkedSet::Iterator::operator !=");
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::operator !=");
+  if (ref_set != rhsASI->ref_set)
+    throw ComparingDifferentIteratorsError("AdaptiveLinkedSet::Iterator::operator !=");
+  return current != rhsASI->current;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+T& AdaptiveLinkedSet<T,thash>::Iterator::operator *() const {
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::operator *");
+  if (!can_erase || current == ref_set->trailer) {
+    std::ostringstream where;
+    where << current << " when size = " << ref_set->used;
+    throw IteratorPositionIllegal("AdaptiveLinkedSet::Iterator::operator * Iterator illegal: "+where.str());
+  }
+  return current->value;
+}
+
+
+template<class T, int (*thash)(const T& a)>
+T* AdaptiveLinkedSet<T,thash>::Iterator::operator ->() const {
+  if (expected_mod_count != ref_set->mod_count)
+    throw ConcurrentModificationError("AdaptiveLinkedSet::Iterator::operator ->");
+  if (!can_erase || current == ref_set->trailer) {
+    std::ostringstream where;
+    where << current << " when size = " << ref_set->used;
+    throw IteratorPositionIllegal("AdaptiveLinkedSet::Iterator::operator -> Iterator illegal: "+where.str());
+  }
+  return &current->value;
+}
+
+
+}
+
+#endif /* ADAPTIVE_LINKED_SET_HPP_ */
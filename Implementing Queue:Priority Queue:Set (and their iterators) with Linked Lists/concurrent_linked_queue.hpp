@@ -0,0 +1,379 @@
+#ifndef CONCURRENT_LINKED_QUEUE_HPP_
+#define CONCURRENT_LINKED_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <algorithm>            //For std::sort/std::binary_search
+#include <new>                  //For placement new
+#include <type_traits>          //For std::aligned_storage
+#include <utility>              //For std::move
+#include "ics_exceptions.hpp"
+
+
+namespace ics {
+
+
+//An unbounded queue that any number of threads can enqueue into and dequeue from at once, without
+//  locks (Michael and Scott's algorithm): e.g., a file-parsing thread feeding several threads that
+//  process its lines. Like LinkedQueue it is a linked list of LNs, but front (head) always points
+//  to a "dummy" LN whose value was already dequeued (or never existed), so enqueue (which changes
+//  only rear and the last LN's next) and dequeue (which changes only front) each need one
+//  compare_exchange to succeed, and a thread that finds rear lagging behind the last LN helps to
+//  advance it.
+//A dequeued LN may still be being read by another thread that loaded front before the dequeue, so
+//  it is not deleted immediately: each thread announces the LNs it is about to read in its hazard
+//  pointers, and dequeued LNs are deleted (by the thread that dequeued them, once it has retired
+//  RETIRE_SCAN of them) only if no hazard pointer points to them. A thread that exits hands its
+//  remaining retired LNs to the next thread that scans.
+//
+//try_dequeue returns false if the queue is empty (when it looks); size_approx is exact only when
+//  no thread is enqueueing or dequeueing. There is no Iterator, and the queue cannot be copied.
+template<class T> class ConcurrentLinkedQueue {
+  public:
+    //Destructor/Constructors
+    ~ConcurrentLinkedQueue();
+
+    ConcurrentLinkedQueue          ();
+    ConcurrentLinkedQueue          (const ConcurrentLinkedQueue<T>& to_copy) = delete;
+    explicit ConcurrentLinkedQueue (const std::initializer_list<T>& il);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit ConcurrentLinkedQueue (const Iterable& i);
+
+
+    //Queries
+    bool empty       () const;
+    int  size_approx () const;
+    std::string str  () const; //supplies useful debugging information (only when no thread is changing it)
+
+
+    //Commands
+    int  enqueue     (const T& element);
+    bool try_dequeue (T& element);      //false (and element unchanged) if empty
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    ConcurrentLinkedQueue<T>& operator = (const ConcurrentLinkedQueue<T>& rhs) = delete;
+
+
+  private:
+    //value is raw storage: constructed by enqueue, destroyed by the dequeue that moves it out
+    class LN {
+      public:
+        LN () {}
+
+        T* value () {return reinterpret_cast<T*>(&storage);}
+
+        typename std::aligned_storage<sizeof(T),alignof(T)>::type storage;
+        std::atomic<LN*> next{nullptr};
+    };
+
+    //Each thread that uses a ConcurrentLinkedQueue<T> owns one HazardRecord (for all queues of T);
+    //  records are never deleted, but are reused by later threads after their owner exits
+    class HazardRecord {
+      public:
+        std::atomic<LN*>  hazard[2];
+        std::atomic<bool> active{true};
+        HazardRecord*     next = nullptr;
+    };
+
+    class ThreadState {
+      public:
+        ThreadState();
+        ~ThreadState();
+        HazardRecord*    record;
+        std::vector<LN*> retired;
+    };
+
+    static const int RETIRE_SCAN = 128;   //Scan when a thread has retired this many LNs
+
+    static std::atomic<HazardRecord*> records;   //Lock-free list of all records
+    static std::mutex                 orphans_lock;
+    static std::vector<LN*>           orphans;   //Retired by threads that have exited
+
+    char             pad0[64];
+    std::atomic<LN*> front;
+    char             pad1[64];           //front and rear change in different threads' caches
+    std::atomic<LN*> rear;
+    char             pad2[64];
+    std::atomic<int> used{0};
+
+    //Helper methods
+    static ThreadState& thread_state();
+    static LN*  protect(int h, const std::atomic<LN*>& source);  //Load source into hazard h
+    static void retire (LN* ln);
+    static void scan   (ThreadState& state);
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//ConcurrentLinkedQueue class and related definitions
+
+template<class T>
+std::atomic<typename ConcurrentLinkedQueue<T>::HazardRecord*> ConcurrentLinkedQueue<T>::records{nullptr};
+
+template<class T>
+std::mutex ConcurrentLinkedQueue<T>::orphans_lock;
+
+template<class T>
+std::vector<typename ConcurrentLinkedQueue<T>::LN*> ConcurrentLinkedQueue<T>::orphans;
+
+
+//Destructor/Constructors
+
+//Only the LNs after the dummy (front) store values
+template<class T>
+ConcurrentLinkedQueue<T>::~ConcurrentLinkedQueue() {
+  LN* ln = front.load();
+  for (LN* next = ln->next.load(); next != nullptr; ln = next, next = ln->next.load()) {
+    delete ln;
+    next->value()->~T();
+  }
+  delete ln;
+}
+
+
+template<class T>
+ConcurrentLinkedQueue<T>::ConcurrentLinkedQueue() {
+  LN* dummy = new LN();
+  front.store(dummy);
+  rear.store(dummy);
+}
+
+
+template<class T>
+ConcurrentLinkedQueue<T>::ConcurrentLinkedQueue(const std::initializer_list<T>& il)
+: ConcurrentLinkedQueue() {
+  for (const T& q_elem : il)
+    enqueue(q_elem);
+}
+
+
+template<class T>
+template<class Iterable>
+ConcurrentLinkedQueue<T>::ConcurrentLinkedQueue(const Iterable& i)
+: ConcurrentLinkedQueue() {
+  for (const T& v : i)
+    enqueue(v);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T>
+bool ConcurrentLinkedQueue<T>::empty() const {
+  return front.load()->next.load() == nullptr;
+}
+
+
+template<class T>
+int ConcurrentLinkedQueue<T>::size_approx() const {
+  return std::max(0,used.load());
+}
+
+
+template<class T>
+std::string ConcurrentLinkedQueue<T>::str() const {
+  std::ostringstream answer;
+  answer << "concurrent_queue[";
+  for (LN* ln = front.load()->next.load(); ln != nullptr; ln = ln->next.load())
+    answer << *ln->value() << (ln->next.load() == nullptr ? "" : "->");
+  answer << "](used=" << used.load() << ",front=" << front.load() << ",rear=" << rear.load() << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+//Link the new LN after the last one (found by starting at rear), then try to advance rear to it;
+//  if rear is not the last LN, some other enqueue linked its LN but has not yet advanced rear:
+//  advance rear for it and retry. If copying element throws, the new LN is deleted before it is
+//  linked, so the queue is unchanged.
+template<class T>
+int ConcurrentLinkedQueue<T>::enqueue(const T& element) {
+  ThreadState& state = thread_state();
+  LN* ln = new LN();
+  try {
+    new (ln->value()) T(element);
+  } catch (...) {
+    delete ln;
+    throw;
+  }
+  for (;;) {
+    LN* last = protect(0,rear);
+    LN* next = last->next.load();
+    if (last != rear.load())
+      continue;
+    if (next == nullptr) {
+      if (last->next.compare_exchange_weak(next,ln)) {
+        rear.compare_exchange_strong(last,ln);
+        break;
+      }
+    }else
+      rear.compare_exchange_strong(last,next);
+  }
+  state.record->hazard[0].store(nullptr);
+  ++used;
+  return 1;
+}
+
+
+//The thread whose compare_exchange moves front from the dummy to the first LN owns the first LN's
+//  value (the first LN becomes the new dummy): it moves the value out and retires the old dummy.
+//  Hazard 1 keeps the first LN from being deleted while the value is moved out.
+template<class T>
+bool ConcurrentLinkedQueue<T>::try_dequeue(T& element) {
+  ThreadState& state = thread_state();
+  for (;;) {
+    LN* dummy = protect(0,front);
+    LN* last  = rear.load();
+    LN* first = dummy->next.load();
+    state.record->hazard[1].store(first);
+    if (dummy != front.load())
+      continue;
+    if (first == nullptr) {
+      state.record->hazard[0].store(nullptr);
+      state.record->hazard[1].store(nullptr);
+      return false;
+    }
+    if (dummy == last) {
+      rear.compare_exchange_strong(last,first);
+      continue;
+    }
+    if (front.compare_exchange_weak(dummy,first)) {
+      element = std::move(*first->value());
+      first->value()->~T();
+      state.record->hazard[0].store(nullptr);
+      state.record->hazard[1].store(nullptr);
+      --used;
+      retire(dummy);
+      return true;
+    }
+  }
+}
+
+
+template<class T>
+template<class Iterable>
+int ConcurrentLinkedQueue<T>::enqueue_all(const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//Reuse an inactive record if there is one, else push a new one onto records
+template<class T>
+ConcurrentLinkedQueue<T>::ThreadState::ThreadState() {
+  for (record = records.load(); record != nullptr; record = record->next) {
+    bool inactive = false;
+    if (record->active.compare_exchange_strong(inactive,true))
+      return;
+  }
+  record = new HazardRecord();
+  record->hazard[0].store(nullptr);
+  record->hazard[1].store(nullptr);
+  record->next = records.load();
+  while (!records.compare_exchange_weak(record->next,record))
+    ;
+}
+
+
+template<class T>
+ConcurrentLinkedQueue<T>::ThreadState::~ThreadState() {
+  scan(*this);
+  if (!retired.empty()) {
+    std::lock_guard<std::mutex> guard(orphans_lock);
+    orphans.insert(orphans.end(),retired.begin(),retired.end());
+  }
+  record->hazard[0].store(nullptr);
+  record->hazard[1].store(nullptr);
+  record->active.store(false);
+}
+
+
+template<class T>
+auto ConcurrentLinkedQueue<T>::thread_state() -> ThreadState& {
+  static thread_local ThreadState state;
+  return state;
+}
+
+
+//Once the hazard is stored, source's LN cannot be deleted if source still points to it: a scan
+//  that does not see the hazard must have started after it was retired (removed from source)
+template<class T>
+auto ConcurrentLinkedQueue<T>::protect(int h, const std::atomic<LN*>& source) -> LN* {
+  std::atomic<LN*>& hazard = thread_state().record->hazard[h];
+  LN* ln = source.load();
+  for (;;) {
+    hazard.store(ln);
+    LN* again = source.load();
+    if (again == ln)
+      return ln;
+    ln = again;
+  }
+}
+
+
+template<class T>
+void ConcurrentLinkedQueue<T>::retire(LN* ln) {
+  ThreadState& state = thread_state();
+  state.retired.push_back(ln);
+  if (state.retired.size() >= RETIRE_SCAN)
+    scan(state);
+}
+
+
+//Delete each retired LN (this thread's, and any orphans) that no hazard pointer points to
+template<class T>
+void ConcurrentLinkedQueue<T>::scan(ThreadState& state) {
+  {
+    std::unique_lock<std::mutex> guard(orphans_lock, std::try_to_lock);
+    if (guard.owns_lock() && !orphans.empty()) {
+      state.retired.insert(state.retired.end(),orphans.begin(),orphans.end());
+      orphans.clear();
+    }
+  }
+
+  std::vector<LN*> hazards;
+  for (HazardRecord* r = records.load(); r != nullptr; r = r->next)
+    for (int h=0; h<2; ++h)
+      if (LN* ln = r->hazard[h].load())
+        hazards.push_back(ln);
+  std::sort(hazards.begin(),hazards.end());
+
+  std::vector<LN*> still_hazardous;
+  for (LN* ln : state.retired)
+    if (std::binary_search(hazards.begin(),hazards.end(),ln))
+      still_hazardous.push_back(ln);
+    else
+      delete ln;
+  state.retired.swap(still_hazardous);
+}
+
+}
+
+#endif /* CONCURRENT_LINKED_QUEUE_HPP_ */
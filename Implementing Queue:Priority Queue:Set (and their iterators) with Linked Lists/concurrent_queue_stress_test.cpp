@@ -0,0 +1,132 @@
+#include <string>
+#include <iostream>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include "concurrent_linked_queue.hpp"
+#include "concurrent_ring_queue.hpp"
+
+
+//Checks ConcurrentLinkedQueue and ConcurrentRingQueue (of capacities 1, 2 and 1024) with
+//  PRODUCERS producer threads each enqueueing VALUES values and CONSUMERS consumer threads
+//  dequeueing until all have arrived: each value must be dequeued exactly once, and each consumer
+//  must receive each producer's values in the order they were enqueued. Then checks, in one
+//  thread, that an enqueue whose copy constructor throws leaves each queue unchanged and usable.
+//Build it with -fsanitize=thread (or address,undefined) to check the queues' memory use too.
+//Prints one line per queue and returns non-0 if any check fails.
+
+const int PRODUCERS = 4;
+const int CONSUMERS = 4;
+const int VALUES    = 200000;   //Per producer
+
+int failures = 0;
+
+void check(bool ok, const std::string& what, const std::string& queue) {
+  if (!ok) {
+    std::cout << "FAILED: " << queue << " " << what << std::endl;
+    ++failures;
+  }
+}
+
+
+//A value encodes its producer and its index in that producer's sequence
+template<class Q>
+void stress(Q& q, const std::string& name) {
+  std::vector<std::atomic<int>> seen(PRODUCERS*VALUES);
+  for (std::atomic<int>& s : seen)
+    s.store(0);
+  std::atomic<int>  dequeued(0);
+  std::atomic<bool> in_order(true);
+  std::vector<std::thread> threads;
+  for (int p=0; p<PRODUCERS; ++p)
+    threads.push_back(std::thread([&q,p] {
+      for (int i=0; i<VALUES; ++i)
+        while (q.enqueue(p*VALUES+i) == 0)
+          std::this_thread::yield();
+    }));
+  for (int c=0; c<CONSUMERS; ++c)
+    threads.push_back(std::thread([&] {
+      std::vector<int> last(PRODUCERS,-1);
+      int v;
+      while (dequeued.load() < PRODUCERS*VALUES)
+        if (q.try_dequeue(v)) {
+          ++dequeued;
+          ++seen[v];
+          if (v%VALUES <= last[v/VALUES])
+            in_order.store(false);
+          last[v/VALUES] = v%VALUES;
+        }else
+          std::this_thread::yield();
+    }));
+  for (std::thread& t : threads)
+    t.join();
+
+  int once = 0;
+  for (std::atomic<int>& s : seen)
+    once += s.load() == 1;
+  check(once == PRODUCERS*VALUES, "each value dequeued once", name);
+  check(in_order.load(), "each producer's values in order", name);
+  check(q.empty(), "empty at end", name);
+  std::cout << name << ": " << once << " of " << PRODUCERS*VALUES << " values dequeued once"
+            << (in_order.load() ? ", in order" : ", OUT OF ORDER") << std::endl;
+}
+
+
+//Copying a Fragile throws when throw_next is set
+bool throw_next = false;
+
+struct Fragile {
+  int value;
+  Fragile(int v = 0) : value(v) {}
+  Fragile(const Fragile& f) : value(f.value) {
+    if (throw_next) {
+      throw_next = false;
+      throw 0;
+    }
+  }
+  Fragile& operator = (const Fragile& f) = default;
+};
+std::ostream& operator << (std::ostream& outs, const Fragile& f) {return outs << f.value;}
+
+
+template<class Q>
+void throwing_copy(Q& q, const std::string& name) {
+  bool ok = true;
+  for (int i=0; i<10; ++i) {
+    q.enqueue(Fragile(2*i));
+    throw_next = true;
+    try {
+      q.enqueue(Fragile(2*i+1));
+      ok = false;
+    } catch (int) {
+    }
+    throw_next = false;
+  }
+  Fragile f;
+  for (int i=0; i<10; ++i)
+    ok = ok && q.try_dequeue(f) && f.value == 2*i;
+  ok = ok && !q.try_dequeue(f) && q.enqueue(Fragile(99)) == 1 && q.try_dequeue(f) && f.value == 99;
+  check(ok, "unchanged after a throwing copy", name);
+  std::cout << name << " throwing copy: " << (ok ? "unchanged" : "CHANGED") << std::endl;
+}
+
+
+int main() {
+  {
+    ics::ConcurrentLinkedQueue<int> q;
+    stress(q,"ConcurrentLinkedQueue");
+  }
+  for (int capacity : {1, 2, 1024}) {
+    ics::ConcurrentRingQueue<int> q(capacity);
+    stress(q,"ConcurrentRingQueue(" + std::to_string(capacity) + ")");
+  }
+  {
+    ics::ConcurrentLinkedQueue<Fragile> q;
+    throwing_copy(q,"ConcurrentLinkedQueue");
+  }
+  {
+    ics::ConcurrentRingQueue<Fragile> q(16);
+    throwing_copy(q,"ConcurrentRingQueue(16)");
+  }
+  return failures == 0 ? 0 : 1;
+}
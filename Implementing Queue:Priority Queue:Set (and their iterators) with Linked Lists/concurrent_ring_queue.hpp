@@ -0,0 +1,225 @@
+#ifndef CONCURRENT_RING_QUEUE_HPP_
+#define CONCURRENT_RING_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <atomic>
+#include <cstddef>              //For std::size_t
+#include <new>                  //For placement new
+#include <type_traits>          //For std::aligned_storage
+#include <utility>              //For std::move
+#include "ics_exceptions.hpp"
+
+
+namespace ics {
+
+
+//A bounded queue that any number of threads can enqueue into and dequeue from at once, without
+//  locks (Vyukov's algorithm): a ring of capacity cells (capacity is rounded up to a power of 2,
+//  and to at least 2: with 1 cell, a dequeue's p+capacity would be the next enqueue's p+1),
+//  allocated once, so unlike ConcurrentLinkedQueue it never allocates while in use, and a full
+//  queue pushes back on producers (enqueue returns 0) instead of growing.
+//Each cell has a sequence number saying whose turn it is: the enqueue at position p may use cell
+//  p%capacity when its sequence is p, and then sets it to p+1; the dequeue at position p may use
+//  it when its sequence is p+1, and then sets it to p+capacity (the enqueue at p+capacity's turn).
+//  A thread claims a position by a compare_exchange on rear (or front), and then uses its cell
+//  without interference.
+//
+//enqueue returns 0 (and does not enqueue) if the queue is full; try_dequeue returns false if it
+//  is empty; size_approx is exact only when no thread is enqueueing or dequeueing. There is no
+//  Iterator, and the queue cannot be copied.
+template<class T> class ConcurrentRingQueue {
+  public:
+    //Destructor/Constructors
+    ~ConcurrentRingQueue();
+
+    explicit ConcurrentRingQueue (int capacity);
+    ConcurrentRingQueue          (const ConcurrentRingQueue<T>& to_copy) = delete;
+    explicit ConcurrentRingQueue (int capacity, const std::initializer_list<T>& il);
+
+
+    //Queries
+    bool empty       () const;
+    int  size_approx () const;
+    int  capacity    () const;
+    std::string str  () const; //supplies useful debugging information (only when no thread is changing it)
+
+
+    //Commands
+    int  enqueue     (const T& element);  //0 (and not enqueued) if full
+    bool try_dequeue (T& element);        //false (and element unchanged) if empty
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);  //Returns how many were enqueued (until full)
+
+
+    //Operators
+    ConcurrentRingQueue<T>& operator = (const ConcurrentRingQueue<T>& rhs) = delete;
+
+
+  private:
+    class Cell {
+      public:
+        T* value () {return reinterpret_cast<T*>(&storage);}
+
+        std::atomic<std::size_t> sequence;
+        typename std::aligned_storage<sizeof(T),alignof(T)>::type storage;
+    };
+
+    Cell*                    ring;
+    std::size_t              mask;       //capacity-1
+    char                     pad0[64];
+    std::atomic<std::size_t> front{0};   //Position of the next dequeue
+    char                     pad1[64];   //front and rear change in different threads' caches
+    std::atomic<std::size_t> rear{0};    //Position of the next enqueue
+    char                     pad2[64];
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//ConcurrentRingQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T>
+ConcurrentRingQueue<T>::~ConcurrentRingQueue() {
+  for (std::size_t p = front.load(); p != rear.load(); ++p)
+    ring[p & mask].value()->~T();
+  delete [] ring;
+}
+
+
+template<class T>
+ConcurrentRingQueue<T>::ConcurrentRingQueue(int capacity) {
+  if (capacity < 1) {
+    std::ostringstream answer;
+    answer << "ConcurrentRingQueue::capacity constructor: capacity(" << capacity << ") < 1";
+    throw IcsError(answer.str());
+  }
+  std::size_t length = 2;
+  while (length < std::size_t(capacity))
+    length *= 2;
+  mask = length-1;
+  ring = new Cell[length];
+  for (std::size_t p = 0; p < length; ++p)
+    ring[p].sequence.store(p);
+}
+
+
+template<class T>
+ConcurrentRingQueue<T>::ConcurrentRingQueue(int capacity, const std::initializer_list<T>& il)
+: ConcurrentRingQueue(capacity) {
+  for (const T& q_elem : il)
+    if (enqueue(q_elem) == 0)
+      throw IcsError("ConcurrentRingQueue::initializer_list constructor: more values than capacity");
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T>
+bool ConcurrentRingQueue<T>::empty() const {
+  return size_approx() == 0;
+}
+
+
+template<class T>
+int ConcurrentRingQueue<T>::size_approx() const {
+  std::size_t f = front.load(), r = rear.load();
+  return r > f ? int(r-f) : 0;
+}
+
+
+template<class T>
+int ConcurrentRingQueue<T>::capacity() const {
+  return mask+1;
+}
+
+
+template<class T>
+std::string ConcurrentRingQueue<T>::str() const {
+  std::ostringstream answer;
+  answer << "concurrent_ring[";
+  for (std::size_t p = front.load(); p != rear.load(); ++p)
+    answer << (p == front.load() ? "" : ",") << (p & mask) << ":" << *ring[p & mask].value();
+  answer << "](capacity=" << mask+1 << ",front=" << front.load() << ",rear=" << rear.load() << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+//A cell whose sequence is behind position still holds a value from a lap ago: the queue is full.
+//  element is copied before a position is claimed: a claimed cell whose sequence never advanced
+//  (because its copy threw) would stop every later dequeue.
+template<class T>
+int ConcurrentRingQueue<T>::enqueue(const T& element) {
+  T copy(element);
+  std::size_t position = rear.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = ring[position & mask];
+    std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    std::ptrdiff_t turn = std::ptrdiff_t(sequence) - std::ptrdiff_t(position);
+    if (turn == 0) {
+      if (rear.compare_exchange_weak(position, position+1, std::memory_order_relaxed)) {
+        new (cell.value()) T(std::move(copy));
+        cell.sequence.store(position+1, std::memory_order_release);
+        return 1;
+      }
+    }else if (turn < 0)
+      return 0;
+    else
+      position = rear.load(std::memory_order_relaxed);
+  }
+}
+
+
+//A cell whose sequence is behind position+1 has not been enqueued into yet: the queue is empty
+template<class T>
+bool ConcurrentRingQueue<T>::try_dequeue(T& element) {
+  std::size_t position = front.load(std::memory_order_relaxed);
+  for (;;) {
+    Cell& cell = ring[position & mask];
+    std::size_t sequence = cell.sequence.load(std::memory_order_acquire);
+    std::ptrdiff_t turn = std::ptrdiff_t(sequence) - std::ptrdiff_t(position+1);
+    if (turn == 0) {
+      if (front.compare_exchange_weak(position, position+1, std::memory_order_relaxed)) {
+        element = std::move(*cell.value());
+        cell.value()->~T();
+        cell.sequence.store(position+mask+1, std::memory_order_release);
+        return true;
+      }
+    }else if (turn < 0)
+      return false;
+    else
+      position = front.load(std::memory_order_relaxed);
+  }
+}
+
+
+template<class T>
+template<class Iterable>
+int ConcurrentRingQueue<T>::enqueue_all(const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    if (enqueue(v) == 0)
+      break;
+    else
+      ++count;
+  return count;
+}
+
+}
+
+#endif /* CONCURRENT_RING_QUEUE_HPP_ */
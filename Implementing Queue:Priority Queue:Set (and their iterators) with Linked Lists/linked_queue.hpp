@@ -5,19 +5,29 @@
 #include <iostream>
 #include <sstream>
 #include <initializer_list>
+#include <new>                  //For placement new
+#include <type_traits>          //For std::aligned_storage
+#include <utility>              //For std::move
 #include "ics_exceptions.hpp"
 
 
 namespace ics {
 
 
-template<class T> class LinkedQueue {
+//An unrolled linked list: each LN (chunk) stores up to CHUNK values (about CHUNK_BYTES bytes of
+//  them) in order, in slots[first..last-1]. enqueue fills the rear chunk and dequeue empties the
+//  front chunk, so there is one allocation per CHUNK values (not per value), and the per-value
+//  overhead of a next pointer is shared by CHUNK values. One emptied chunk is kept as a spare, so a
+//  queue whose size hovers at a chunk boundary does not allocate and free a chunk repeatedly.
+//Iterator::erase moves the values in the erased value's chunk (whichever side of it has fewer),
+//  and removes the chunk if that empties it.
+template<class T, int CHUNK_BYTES = 512> class LinkedQueue {
   public:
     //Destructor/Constructors
     ~LinkedQueue();
 
     LinkedQueue          ();
-    LinkedQueue          (const LinkedQueue<T>& to_copy);
+    LinkedQueue          (const LinkedQueue<T,CHUNK_BYTES>& to_copy);
     explicit LinkedQueue (const std::initializer_list<T>& il);
 
     //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
@@ -43,12 +53,12 @@ template<class T> class LinkedQueue {
 
 
     //Operators
-    LinkedQueue<T>& operator = (const LinkedQueue<T>& rhs);
-    bool operator == (const LinkedQueue<T>& rhs) const;
-    bool operator != (const LinkedQueue<T>& rhs) const;
+    LinkedQueue<T,CHUNK_BYTES>& operator = (const LinkedQueue<T,CHUNK_BYTES>& rhs);
+    bool operator == (const LinkedQueue<T,CHUNK_BYTES>& rhs) const;
+    bool operator != (const LinkedQueue<T,CHUNK_BYTES>& rhs) const;
 
-    template<class T2>
-    friend std::ostream& operator << (std::ostream& outs, const LinkedQueue<T2>& q);
+    template<class T2, int CHUNK_BYTES2>
+    friend std::ostream& operator << (std::ostream& outs, const LinkedQueue<T2,CHUNK_BYTES2>& q);
 
 
 
@@ -58,33 +68,36 @@ template<class T> class LinkedQueue {
   public:
     class Iterator {
       public:
-        //Private constructor called in begin/end, which are friends of LinkedQueue<T>
+        //Private constructor called in begin/end, which are friends of LinkedQueue<T,CHUNK_BYTES>
         ~Iterator();
         T           erase();
         std::string str  () const;
-        LinkedQueue<T>::Iterator& operator ++ ();
-        LinkedQueue<T>::Iterator  operator ++ (int);
-        bool operator == (const LinkedQueue<T>::Iterator& rhs) const;
-        bool operator != (const LinkedQueue<T>::Iterator& rhs) const;
+        LinkedQueue<T,CHUNK_BYTES>::Iterator& operator ++ ();
+        LinkedQueue<T,CHUNK_BYTES>::Iterator  operator ++ (int);
+        bool operator == (const LinkedQueue<T,CHUNK_BYTES>::Iterator& rhs) const;
+        bool operator != (const LinkedQueue<T,CHUNK_BYTES>::Iterator& rhs) const;
         T& operator *  () const;
         T* operator -> () const;
-        friend std::ostream& operator << (std::ostream& outs, const LinkedQueue<T>::Iterator& i) {
+        friend std::ostream& operator << (std::ostream& outs, const LinkedQueue<T,CHUNK_BYTES>::Iterator& i) {
           outs << i.str(); //Use the same meaning as the debugging .str() method
           return outs;
         }
-        friend Iterator LinkedQueue<T>::begin () const;
-        friend Iterator LinkedQueue<T>::end   () const;
+        friend Iterator LinkedQueue<T,CHUNK_BYTES>::begin () const;
+        friend Iterator LinkedQueue<T,CHUNK_BYTES>::end   () const;
 
       private:
-        //If can_erase is false, current indexes the "next" value (must ++ to reach it)
-        LN*             prev = nullptr;  //if nullptr, current at front of list
-        LN*             current;         //current == prev->next (if prev != nullptr)
-        LinkedQueue<T>* ref_queue;
-        int             expected_mod_count;
-        bool            can_erase = true;
+        //If can_erase is false, current/index refer to the "next" value (must ++ to reach it)
+        LN*                         prev = nullptr;  //if nullptr, current is the front chunk
+        LN*                         current;         //current == prev->next (if prev != nullptr); nullptr at end
+        int                         index;           //current->slots[index] (0 at end)
+        LinkedQueue<T,CHUNK_BYTES>* ref_queue;
+        int                         expected_mod_count;
+        bool                        can_erase = true;
 
         //Called in friends begin/end
-        Iterator(LinkedQueue<T>* iterate_over, LN* initial);
+        Iterator(LinkedQueue<T,CHUNK_BYTES>* iterate_over, LN* initial);
+
+        void next_chunk_if_past_last();
     };
 
 
@@ -93,24 +106,32 @@ template<class T> class LinkedQueue {
 
 
   private:
+    static const int CHUNK = sizeof(T) >= CHUNK_BYTES ? 1 : CHUNK_BYTES/sizeof(T);
+
+    //Slots are raw storage: only slots[first..last-1] hold (constructed) values
     class LN {
       public:
-        LN ()                      {}
-        LN (const LN& ln)          : value(ln.value), next(ln.next){}
-        LN (T v,  LN* n = nullptr) : value(v), next(n){}
+        LN () {}
 
-        T   value;
-        LN* next = nullptr;
+        T* at (int i) {return reinterpret_cast<T*>(&slots[i]);}
+
+        typename std::aligned_storage<sizeof(T),alignof(T)>::type slots[CHUNK];
+        int first = 0;
+        int last  = 0;
+        LN* next  = nullptr;
     };
 
 
     LN* front     =  nullptr;
     LN* rear      =  nullptr;
-    int used      =  0;            //Cache count of nodes in linked list
+    LN* spare     =  nullptr;      //An empty chunk, kept for the next new_chunk
+    int used      =  0;            //Cache count of values in all chunks
     int mod_count =  0;            //Alllows sensing concurrent modification
 
     //Helper methods
-    void delete_list(LN*& front);  //Deallocate all LNs, and set front's argument to nullptr;
+    LN*  new_chunk  ();
+    void free_chunk (LN* ln);      //ln's values must already be destroyed
+    void delete_list(LN*& front);  //Destroy all values and deallocate all LNs, and set front's argument to nullptr;
 };
 
 
@@ -121,44 +142,42 @@ template<class T> class LinkedQueue {
 //
 //LinkedQueue class and related definitions
 
+template<class T, int CHUNK_BYTES>
+const int LinkedQueue<T,CHUNK_BYTES>::CHUNK;
+
+
 //Destructor/Constructors
 
-template<class T>
-LinkedQueue<T>::~LinkedQueue() {
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>::~LinkedQueue() {
   delete_list(front);
+  delete spare;
 }
 
 
-template<class T>
-LinkedQueue<T>::LinkedQueue() {
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>::LinkedQueue() {
 }
 
 
-template<class T>
-LinkedQueue<T>::LinkedQueue(const LinkedQueue<T>& to_copy) {
-  LN* temp=to_copy.front;
-  if(temp!= nullptr){
-    LN* front_walker=rear=front=new LN(temp->value);
-    temp=temp->next;
-    while(temp!= nullptr){
-      rear=front_walker==front_walker->next=new LN(temp->value);
-      temp=temp->next;
-    }
-    used=to_copy.used;
-  }
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>::LinkedQueue(const LinkedQueue<T,CHUNK_BYTES>& to_copy) {
+  for(LN* c=to_copy.front; c!= nullptr; c=c->next)
+    for(int i=c->first; i<c->last; ++i)
+      enqueue(*c->at(i));
 }
 
 
-template<class T>
-LinkedQueue<T>::LinkedQueue(const std::initializer_list<T>& il) {
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>::LinkedQueue(const std::initializer_list<T>& il) {
   for (const T& q_elem : il)
     enqueue(q_elem);
 }
 
 
-template<class T>
+template<class T, int CHUNK_BYTES>
 template<class Iterable>
-LinkedQueue<T>::LinkedQueue(const Iterable& i) {
+LinkedQueue<T,CHUNK_BYTES>::LinkedQueue(const Iterable& i) {
   for (const T& v : i)
     enqueue(v);
 }
@@ -168,40 +187,37 @@ LinkedQueue<T>::LinkedQueue(const Iterable& i) {
 //
 //Queries
 
-template<class T>
-bool LinkedQueue<T>::empty() const {
+template<class T, int CHUNK_BYTES>
+bool LinkedQueue<T,CHUNK_BYTES>::empty() const {
   return front== nullptr;
 }
 
 
-template<class T>
-int LinkedQueue<T>::size() const {
+template<class T, int CHUNK_BYTES>
+int LinkedQueue<T,CHUNK_BYTES>::size() const {
   return used;
 }
 
 
-template<class T>
-T& LinkedQueue<T>::peek () const {
+template<class T, int CHUNK_BYTES>
+T& LinkedQueue<T,CHUNK_BYTES>::peek () const {
   if(this->empty())
     throw EmptyError("LinkedQueue::peek");
-  return front->value;
+  return *front->at(front->first);
 }
 
 
-template<class T>
-std::string LinkedQueue<T>::str() const {
+//Chunks are separated by |
+template<class T, int CHUNK_BYTES>
+std::string LinkedQueue<T,CHUNK_BYTES>::str() const {
   std::ostringstream answer;
   answer << "queue[";
-  LN* walker=front;
-  if(walker!= nullptr){
-    answer << walker->value;
-    walker=walker->next;
+  for(LN* c=front; c!= nullptr; c=c->next){
+    answer << (c==front ? "" : "|");
+    for(int i=c->first; i<c->last; ++i)
+      answer << (i==c->first ? "" : "->") << *c->at(i);
   }
-  while(walker!= nullptr){
-    answer<<"->"<<walker->value;
-    walker=walker->next;
-  }
-  answer <<"](used="<<used<<",front="<<front<<",rear="<<rear<<",mod_count="<<mod_count<<")";
+  answer <<"](used="<<used<<",CHUNK="<<CHUNK<<",front="<<front<<",rear="<<rear<<",mod_count="<<mod_count<<")";
   return answer.str();
 }
 
@@ -210,34 +226,54 @@ std::string LinkedQueue<T>::str() const {
 //
 //Commands
 
-template<class T>
-int LinkedQueue<T>::enqueue(const T& element) {
-  if(front== nullptr)
-    rear=front=new LN(element);
-  else
-    rear=rear->next=new LN(element);
+//A new chunk is linked only after element is copied into it: if the copy throws, the chunk
+//  becomes the spare (or is deleted) and the queue is unchanged
+template<class T, int CHUNK_BYTES>
+int LinkedQueue<T,CHUNK_BYTES>::enqueue(const T& element) {
+  if(front!= nullptr && rear->last<CHUNK)
+    new (rear->at(rear->last)) T(element);
+  else{
+    LN* ln=new_chunk();
+    try{
+      new (ln->at(0)) T(element);
+    }catch(...){
+      free_chunk(ln);
+      throw;
+    }
+    if(front== nullptr)
+      rear=front=ln;
+    else
+      rear=rear->next=ln;
+  }
+  ++rear->last;
   ++used;
   ++mod_count;
   return 1;
 }
 
 
-template<class T>
-T LinkedQueue<T>::dequeue() {
+template<class T, int CHUNK_BYTES>
+T LinkedQueue<T,CHUNK_BYTES>::dequeue() {
   if(front== nullptr)
     throw EmptyError("LinkedQueue::dequeue");
-  LN* temp=front;
-  T to_return=temp->value;
-  front=front->next;
-  delete temp;
+  T* value=front->at(front->first);
+  T to_return=std::move(*value);
+  value->~T();
+  if(++front->first==front->last){
+    LN* temp=front;
+    front=front->next;
+    if(front== nullptr)
+      rear= nullptr;
+    free_chunk(temp);
+  }
   --used;
   ++mod_count;
   return to_return;
 }
 
 
-template<class T>
-void LinkedQueue<T>::clear() {
+template<class T, int CHUNK_BYTES>
+void LinkedQueue<T,CHUNK_BYTES>::clear() {
   delete_list(front);
   rear=front= nullptr;
   used=0;
@@ -245,9 +281,9 @@ void LinkedQueue<T>::clear() {
 }
 
 
-template<class T>
+template<class T, int CHUNK_BYTES>
 template<class Iterable>
-int LinkedQueue<T>::enqueue_all(const Iterable& i) {
+int LinkedQueue<T,CHUNK_BYTES>::enqueue_all(const Iterable& i) {
   int count=0;
   for(const T& v:i)
     count+=enqueue(v);
@@ -259,70 +295,44 @@ int LinkedQueue<T>::enqueue_all(const Iterable& i) {
 //
 //Operators
 
-template<class T>
-LinkedQueue<T>& LinkedQueue<T>::operator = (const LinkedQueue<T>& rhs) {
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>& LinkedQueue<T,CHUNK_BYTES>::operator = (const LinkedQueue<T,CHUNK_BYTES>& rhs) {
   if(this==&rhs)
     return *this;
-  LN* lhs=front;
-  for(LN* rhs_front=rhs.front;rhs_front!= nullptr;rhs_front=rhs_front->next, lhs=lhs->next){
-    if(front== nullptr)
-      rear=lhs=front=new LN(rhs_front->value);
-    else if(lhs== nullptr){
-      rear->next=new LN(rhs_front->value);
-      lhs=rear=rear->next;
-    }
-    else{
-      lhs->value=rhs_front->value;
-    }
-    rear=lhs;
-  }
-  LN* lhs_temp=lhs;
-  for(;lhs!= nullptr;lhs=lhs->next){
-    LN* temp=lhs;
-    delete temp;
-  }
-  if(lhs_temp==front)
-    rear=front= nullptr;
-  else
-    rear->next= nullptr;
-  used=rhs.used;
+  clear();
+  for(LN* c=rhs.front; c!= nullptr; c=c->next)
+    for(int i=c->first; i<c->last; ++i)
+      enqueue(*c->at(i));
   return *this;
 }
 
 
-template<class T>
-bool LinkedQueue<T>::operator == (const LinkedQueue<T>& rhs) const {
+//Chunk boundaries can differ (after Iterator::erase), so compare value by value
+template<class T, int CHUNK_BYTES>
+bool LinkedQueue<T,CHUNK_BYTES>::operator == (const LinkedQueue<T,CHUNK_BYTES>& rhs) const {
   if(this==&rhs)
     return true;
-  LN* lhs=front,* p=rhs.front;
-  while(lhs!= nullptr && p!= nullptr){
-    if(lhs->value!=p->value)
+  if(used!=rhs.used)
+    return false;
+  for(Iterator l=begin(), r=rhs.begin(); l!=end(); ++l, ++r)
+    if(*l!=*r)
       return false;
-    lhs=lhs->next;
-    p=p->next;
-  }
-  return lhs==p;
+  return true;
 }
 
 
-template<class T>
-bool LinkedQueue<T>::operator != (const LinkedQueue<T>& rhs) const {
+template<class T, int CHUNK_BYTES>
+bool LinkedQueue<T,CHUNK_BYTES>::operator != (const LinkedQueue<T,CHUNK_BYTES>& rhs) const {
   return !(*this == rhs);
 }
 
 
-template<class T>
-std::ostream& operator << (std::ostream& outs, const LinkedQueue<T>& q) {
+template<class T, int CHUNK_BYTES>
+std::ostream& operator << (std::ostream& outs, const LinkedQueue<T,CHUNK_BYTES>& q) {
   outs << "queue[";
-  typename LinkedQueue<T>::LN* walker=q.front;
-  if(walker!= nullptr){
-    outs << walker->value;
-    walker=walker->next;
-  }
-  while(walker!= nullptr){
-    outs<<","<<walker->value;
-    walker=walker->next;
-  }
+  for(typename LinkedQueue<T,CHUNK_BYTES>::LN* c=q.front; c!= nullptr; c=c->next)
+    for(int i=c->first; i<c->last; ++i)
+      outs << (c==q.front && i==c->first ? "" : ",") << *c->at(i);
   outs <<"]:rear";
   return outs;
 }
@@ -332,14 +342,14 @@ std::ostream& operator << (std::ostream& outs, const LinkedQueue<T>& q) {
 //
 //Iterator constructors
 
-template<class T>
-auto LinkedQueue<T>::begin () const -> LinkedQueue<T>::Iterator {
-  return Iterator(const_cast<LinkedQueue<T>*>(this),front);
+template<class T, int CHUNK_BYTES>
+auto LinkedQueue<T,CHUNK_BYTES>::begin () const -> LinkedQueue<T,CHUNK_BYTES>::Iterator {
+  return Iterator(const_cast<LinkedQueue<T,CHUNK_BYTES>*>(this),front);
 }
 
-template<class T>
-auto LinkedQueue<T>::end () const -> LinkedQueue<T>::Iterator {
-  return Iterator(const_cast<LinkedQueue<T>*>(this), rear->next);
+template<class T, int CHUNK_BYTES>
+auto LinkedQueue<T,CHUNK_BYTES>::end () const -> LinkedQueue<T,CHUNK_BYTES>::Iterator {
+  return Iterator(const_cast<LinkedQueue<T,CHUNK_BYTES>*>(this), nullptr);
 }
 
 
@@ -347,12 +357,35 @@ auto LinkedQueue<T>::end () const -> LinkedQueue<T>::Iterator {
 //
 //Private helper methods
 
-template<class T>
-void LinkedQueue<T>::delete_list(LN*& front) {
+template<class T, int CHUNK_BYTES>
+auto LinkedQueue<T,CHUNK_BYTES>::new_chunk() -> LN* {
+  if(spare== nullptr)
+    return new LN();
+  LN* to_return=spare;
+  spare= nullptr;
+  to_return->first=to_return->last=0;
+  to_return->next= nullptr;
+  return to_return;
+}
+
+
+template<class T, int CHUNK_BYTES>
+void LinkedQueue<T,CHUNK_BYTES>::free_chunk(LN* ln) {
+  if(spare== nullptr)
+    spare=ln;
+  else
+    delete ln;
+}
+
+
+template<class T, int CHUNK_BYTES>
+void LinkedQueue<T,CHUNK_BYTES>::delete_list(LN*& front) {
   while(front!= nullptr){
     LN* temp=front;
     front=front->next;
-    delete temp;
+    for(int i=temp->first; i<temp->last; ++i)
+      temp->at(i)->~T();
+    free_chunk(temp);
   }
 }
 
@@ -364,19 +397,22 @@ void LinkedQueue<T>::delete_list(LN*& front) {
 //
 //Iterator class definitions
 
-template<class T>
-LinkedQueue<T>::Iterator::Iterator(LinkedQueue<T>* iterate_over, LN* initial)
-:current(initial), ref_queue(iterate_over),expected_mod_count(iterate_over->mod_count){
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>::Iterator::Iterator(LinkedQueue<T,CHUNK_BYTES>* iterate_over, LN* initial)
+:current(initial), index(initial== nullptr ? 0 : initial->first), ref_queue(iterate_over),expected_mod_count(iterate_over->mod_count){
 }
 
 
-template<class T>
-LinkedQueue<T>::Iterator::~Iterator()
+template<class T, int CHUNK_BYTES>
+LinkedQueue<T,CHUNK_BYTES>::Iterator::~Iterator()
 {}
 
 
-template<class T>
-T LinkedQueue<T>::Iterator::erase() {
+//Close the gap at index by moving the values before it (toward the rear) or after it (toward the
+//  front), whichever are fewer; afterward index refers to the value that followed the erased one.
+//If the chunk is then empty, unlink it (updating front/rear as needed).
+template<class T, int CHUNK_BYTES>
+T LinkedQueue<T,CHUNK_BYTES>::Iterator::erase() {
   if(expected_mod_count!=ref_queue->mod_count)
     throw ConcurrentModificationError("LinkedQueue::Iterator::erase");
   if(!can_erase)
@@ -384,44 +420,59 @@ T LinkedQueue<T>::Iterator::erase() {
   if(current== nullptr)
     throw CannotEraseError("LinkedQueue::Iterator::erase Iterator cursor beyond data structure");
   can_erase=false;
-  T to_return=current->value;
-  if(prev== nullptr){
-    current=current->next;
-    ref_queue->dequeue();
+  T to_return=std::move(*current->at(index));
+  if(index-current->first < current->last-1-index){
+    for(int i=index; i>current->first; --i)
+      *current->at(i)=std::move(*current->at(i-1));
+    current->at(current->first++)->~T();
+    ++index;
   }
   else{
+    for(int i=index; i<current->last-1; ++i)
+      *current->at(i)=std::move(*current->at(i+1));
+    current->at(--current->last)->~T();
+  }
+
+  if(current->first==current->last){
     LN* temp=current;
-    prev->next=current=current->next;
-    if(current== nullptr)
+    current=current->next;
+    index=(current== nullptr ? 0 : current->first);
+    if(prev== nullptr)
+      ref_queue->front=current;
+    else
+      prev->next=current;
+    if(ref_queue->rear==temp)
       ref_queue->rear=prev;
-    delete temp;
-    ref_queue->used--;
-    ref_queue->mod_count++;
+    ref_queue->free_chunk(temp);
   }
+  else
+    next_chunk_if_past_last();
+  ref_queue->used--;
+  ref_queue->mod_count++;
   expected_mod_count=ref_queue->mod_count;
   return to_return;
 }
 
 
-template<class T>
-std::string LinkedQueue<T>::Iterator::str() const {
+template<class T, int CHUNK_BYTES>
+std::string LinkedQueue<T,CHUNK_BYTES>::Iterator::str() const {
   std::ostringstream answer;
   answer<<ref_queue->str()<<"(current=";
-  current!= nullptr ? answer<<current->value : answer<<"nullptr";
-  answer<<",expected_mod_count="<<expected_mod_count<<",can_erase="<<can_erase<<")";
+  current!= nullptr ? answer<<*current->at(index) : answer<<"nullptr";
+  answer<<",index="<<index<<",expected_mod_count="<<expected_mod_count<<",can_erase="<<can_erase<<")";
   return answer.str();
 }
 
 
-template<class T>
-auto LinkedQueue<T>::Iterator::operator ++ () -> LinkedQueue<T>::Iterator& {
+template<class T, int CHUNK_BYTES>
+auto LinkedQueue<T,CHUNK_BYTES>::Iterator::operator ++ () -> LinkedQueue<T,CHUNK_BYTES>::Iterator& {
   if(expected_mod_count!=ref_queue->mod_count)
     throw ConcurrentModificationError("LinkedQueue::Iterator::operator ++");
-  if(current==ref_queue->rear->next)
+  if(current== nullptr)
     return *this;
   if(can_erase) {
-    prev = current;
-    current = current->next;
+    ++index;
+    next_chunk_if_past_last();
   }
   else
     can_erase=true;
@@ -429,16 +480,16 @@ auto LinkedQueue<T>::Iterator::operator ++ () -> LinkedQueue<T>::Iterator& {
 }
 
 
-template<class T>
-auto LinkedQueue<T>::Iterator::operator ++ (int) -> LinkedQueue<T>::Iterator {
+template<class T, int CHUNK_BYTES>
+auto LinkedQueue<T,CHUNK_BYTES>::Iterator::operator ++ (int) -> LinkedQueue<T,CHUNK_BYTES>::Iterator {
   if(expected_mod_count!=ref_queue->mod_count)
     throw ConcurrentModificationError("LinkedQueue::Iterator::operator ++");
-  if(current==ref_queue->rear->next)
+  if(current== nullptr)
     return *this;
   Iterator to_return(*this);
   if(can_erase){
-    prev=current;
-    current=current->next;
+    ++index;
+    next_chunk_if_past_last();
   }
   else
     can_erase=true;
@@ -446,8 +497,8 @@ auto LinkedQueue<T>::Iterator::operator ++ (int) -> LinkedQueue<T>::Iterator {
 }
 
 
-template<class T>
-bool LinkedQueue<T>::Iterator::operator == (const LinkedQueue<T>::Iterator& rhs) const {
+template<class T, int CHUNK_BYTES>
+bool LinkedQueue<T,CHUNK_BYTES>::Iterator::operator == (const LinkedQueue<T,CHUNK_BYTES>::Iterator& rhs) const {
   const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
   if(rhsASI == 0)
     throw IteratorTypeError("LinkedQueue::Iterator::operator ==");
@@ -456,12 +507,12 @@ bool LinkedQueue<T>::Iterator::operator == (const LinkedQueue<T>::Iterator& rhs)
   if(ref_queue != rhsASI->ref_queue)
     throw ComparingDifferentIteratorsError("LinkedQueue::Iterator::operator ==");
 
-  return current == rhsASI->current;
+  return current == rhsASI->current && index == rhsASI->index;
 }
 
 
-template<class T>
-bool LinkedQueue<T>::Iterator::operator != (const LinkedQueue<T>::Iterator& rhs) const {
+template<class T, int CHUNK_BYTES>
+bool LinkedQueue<T,CHUNK_BYTES>::Iterator::operator != (const LinkedQueue<T,CHUNK_BYTES>::Iterator& rhs) const {
   const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
   if(rhsASI == 0)
     throw IteratorTypeError("LinkedQueue::Iterator::operator ==");
@@ -470,12 +521,12 @@ bool LinkedQueue<T>::Iterator::operator != (const LinkedQueue<T>::Iterator& rhs)
   if(ref_queue != rhsASI->ref_queue)
     throw ComparingDifferentIteratorsError("LinkedQueue::Iterator::operator ==");
 
-  return current != rhsASI->current;
+  return current != rhsASI->current || index != rhsASI->index;
 }
 
 
-template<class T>
-T& LinkedQueue<T>::Iterator::operator *() const {
+template<class T, int CHUNK_BYTES>
+T& LinkedQueue<T,CHUNK_BYTES>::Iterator::operator *() const {
   if(expected_mod_count!=ref_queue->mod_count)
     throw ConcurrentModificationError("LinkedQueue::Iterator::operator *");
   if(!can_erase || current== nullptr){
@@ -485,12 +536,12 @@ T& LinkedQueue<T>::Iterator::operator *() const {
           << " and rear = " << ref_queue->rear;
     throw IteratorPositionIllegal("LinkedQueue::Iterator::operator * Iterator illegal: "+where.str());
   }
-  return current->value;
+  return *current->at(index);
 }
 
 
-template<class T>
-T* LinkedQueue<T>::Iterator::operator ->() const {
+template<class T, int CHUNK_BYTES>
+T* LinkedQueue<T,CHUNK_BYTES>::Iterator::operator ->() const {
   if(expected_mod_count!=ref_queue->mod_count)
     throw ConcurrentModificationError("LinkedQueue::Iterator::operator ->");
   if(!can_erase || current== nullptr){
@@ -501,7 +552,17 @@ T* LinkedQueue<T>::Iterator::operator ->() const {
     throw IteratorPositionIllegal("LinkedQueue::Iterator::operator -> Iterator illegal: "+where.str());
   }
 
-  return current;
+  return current->at(index);
+}
+
+
+template<class T, int CHUNK_BYTES>
+void LinkedQueue<T,CHUNK_BYTES>::Iterator::next_chunk_if_past_last() {
+  if(index==current->last){
+    prev=current;
+    current=current->next;
+    index=(current== nullptr ? 0 : current->first);
+  }
 }
 
 
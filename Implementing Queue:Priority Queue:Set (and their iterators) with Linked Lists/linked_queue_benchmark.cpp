@@ -0,0 +1,107 @@
+#include <string>
+#include <iostream>
+#include <chrono>
+#include <new>                //For std::bad_alloc
+#include <cstdlib>            //For std::malloc/std::free
+#include "linked_queue.hpp"
+
+
+//Time, heap allocations, and peak heap bytes for a LinkedQueue of ints and of short strings:
+//  filling it with N values and draining it; then STEADY_OPS enqueue/dequeue pairs on a queue
+//  holding STEADY_SIZE values (a BFS frontier or work queue at a steady size).
+//Allocations and bytes are counted by replacing the global operator new; each block records its
+//  size just before the address returned, so operator delete can subtract it.
+
+const int N           = 10000000;
+const int STEADY_SIZE = 100;
+const int STEADY_OPS  = 30000000;
+
+long long allocations = 0;
+long long live_bytes  = 0;
+long long peak_bytes  = 0;
+
+const std::size_t HEADER = 16;  //Keeps the returned address aligned for any type
+
+void* operator new (std::size_t n) {
+  ++allocations;
+  char* p = static_cast<char*>(std::malloc(n+HEADER));
+  if (p == nullptr)
+    throw std::bad_alloc();
+  *reinterpret_cast<std::size_t*>(p) = n;
+  if ((live_bytes += n) > peak_bytes)
+    peak_bytes = live_bytes;
+  return p+HEADER;
+}
+void* operator new[] (std::size_t n) {return operator new(n);}
+void  operator delete (void* p) noexcept {
+  if (p == nullptr)
+    return;
+  char* block = static_cast<char*>(p)-HEADER;
+  live_bytes -= *reinterpret_cast<std::size_t*>(block);
+  std::free(block);
+}
+void  operator delete[] (void* p) noexcept {operator delete(p);}
+
+
+int         make_int   (int i) {return i;}
+std::string make_string(int i) {return "w"+std::to_string(i%1000);}
+long long   weight(int v)                {return v;}
+long long   weight(const std::string& v) {return v.size();}
+
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+template<class T>
+void run(const char* name, T (*make)(int)) {
+  long long check = 0;
+  allocations = 0;
+  peak_bytes  = live_bytes;
+  long long base = live_bytes;
+  auto start = std::chrono::steady_clock::now();
+  {
+    ics::LinkedQueue<T> q;
+    for (int i=0; i<N; ++i)
+      q.enqueue(make(i));
+    double fill = ms_since(start);
+    long long peak = peak_bytes-base;
+    while (!q.empty())
+      check += weight(q.dequeue());
+    std::cout << name << " fill " << N << ": " << fill << " ms, peak " << peak/1048576.0 << " MB; fill+drain "
+              << ms_since(start) << " ms, " << allocations/double(N) << " allocations/value" << std::endl;
+  }
+
+  allocations = 0;
+  start = std::chrono::steady_clock::now();
+  {
+    ics::LinkedQueue<T> q;
+    for (int i=0; i<STEADY_SIZE; ++i)
+      q.enqueue(make(i));
+    for (int i=0; i<STEADY_OPS; ++i) {
+      q.enqueue(make(i));
+      check += weight(q.dequeue());
+    }
+    std::cout << name << " steady (size " << STEADY_SIZE << ", " << STEADY_OPS << " enqueue+dequeue): "
+              << ms_since(start) << " ms, " << allocations/double(STEADY_OPS) << " allocations/op"
+              << (check == 42 ? " " : "") << std::endl;
+  }
+}
+
+
+int main() {
+  run<int>        ("int   ",make_int);
+  run<std::string>("string",make_string);
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2); in parentheses, the same program built with the header from
+//  before values were stored in chunks (one LN allocated per value):
+//int     fill 10M:   69 ms, peak  39 MB, fill+drain  113 ms, 0.008 allocations/value
+//          (657 ms, 153 MB, 1000 ms, 1 allocation/value)
+//int     steady:    265 ms, 0 allocations/op  (874 ms, 1 allocation/op)
+//string  fill 10M:  693 ms, peak 315 MB, fill+drain  848 ms, 0.063 allocations/value
+//          (944 ms, 381 MB, 1196 ms, 1 allocation/value)
+//string  steady:   1559 ms, 0 allocations/op  (2558 ms, 1 allocation/op)
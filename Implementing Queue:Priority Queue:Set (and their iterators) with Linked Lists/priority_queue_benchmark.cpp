@@ -0,0 +1,78 @@
+#include <string>
+#include <iostream>
+#include <random>
+#include <chrono>
+#include <cstdlib>            //For std::atoi
+#include "linked_priority_queue.hpp"
+#include "skip_list_priority_queue.hpp"
+
+
+//Enqueue N random ints, iterate over them, and dequeue them all, in a LinkedPriorityQueue (whose
+//  enqueue is O(N)) and a SkipListPriorityQueue (expected O(log N)), for N = 10K, 100K, ... up to
+//  MAX_N. It prints the milliseconds for each phase. LinkedPriorityQueue is skipped for N above
+//  LINKED_MAX_N, where its O(N^2) enqueues would take hours.
+
+const int MAX_N        = 10000000;
+const int LINKED_MAX_N = 100000;
+
+bool int_gt(const int& a, const int& b) {return a < b;}
+
+
+double ms_since(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-start).count();
+}
+
+
+template<class PQ>
+void run(const char* name, int n) {
+  std::minstd_rand random(1);
+  PQ pq(int_gt);
+
+  auto start = std::chrono::steady_clock::now();
+  for (int i=0; i<n; ++i)
+    pq.enqueue(random());
+  double enqueue = ms_since(start);
+
+  start = std::chrono::steady_clock::now();
+  long long sum = 0;
+  for (int v : pq)
+    sum += v;
+  double iterate = ms_since(start);
+
+  start = std::chrono::steady_clock::now();
+  int last = -1;
+  bool ordered = true;
+  while (!pq.empty()) {
+    int v = pq.dequeue();
+    ordered = ordered && v >= last;
+    last = v;
+  }
+  double dequeue = ms_since(start);
+
+  if (!ordered || sum == 0)
+    std::cout << "ERROR: dequeued out of order" << std::endl;
+  std::cout << name << " " << n << "  " << enqueue << "  " << iterate << "  " << dequeue << std::endl;
+}
+
+
+//The optional argument is the largest N (default MAX_N)
+int main(int argc, char* argv[]) {
+  int max_n = argc > 1 ? std::atoi(argv[1]) : MAX_N;
+  std::cout << "queue N  enqueue  iterate  dequeue  (ms)" << std::endl;
+  for (int n=10000; n<=max_n; n *= 10) {
+    if (n <= LINKED_MAX_N)
+      run<ics::LinkedPriorityQueue<int>>("LinkedPriorityQueue  ",n);
+    run<ics::SkipListPriorityQueue<int>>("SkipListPriorityQueue",n);
+  }
+  return 0;
+}
+
+
+//Measured on a 1-core machine (-O2)
+//queue N  enqueue  iterate  dequeue  (ms)
+//LinkedPriorityQueue   10000  167.7  0.1  0.2
+//SkipListPriorityQueue 10000  3.2  0.1  0.3
+//LinkedPriorityQueue   100000  61951.2  3.3  2.9
+//SkipListPriorityQueue 100000  43.7  4.9  4.2
+//SkipListPriorityQueue 1000000  1977.8  158.5  173.4
+//SkipListPriorityQueue 10000000  52183.9  2269.6  2560.2
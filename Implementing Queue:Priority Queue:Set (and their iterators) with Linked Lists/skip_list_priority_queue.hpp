@@ -0,0 +1,615 @@
+#ifndef SKIP_LIST_PRIORITY_QUEUE_HPP_
+#define SKIP_LIST_PRIORITY_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <initializer_list>
+#include <cstddef>              //For std::size_t
+#include <new>                  //For ::operator new/placement new
+#include "ics_exceptions.hpp"
+#include "array_stack.hpp"      //See operator <<
+
+
+namespace ics {
+
+
+#ifndef undefinedgtdefined
+#define undefinedgtdefined
+template<class T>
+bool undefinedgt (const T& a, const T& b) {return false;}
+#endif /* undefinedgtdefined */
+
+//Instantiate the templated class supplying tgt(a,b): true, iff a has higher priority than b.
+//If tgt is defaulted to undefinedgt in the template, then a constructor must supply cgt.
+//If both tgt and cgt are supplied, then they must be the same (by ==) function.
+//If neither is supplied, or both are supplied but different, TemplateFunctionError is raised.
+//The (unique) non-undefinedgt value supplied by tgt/cgt is stored in the instance variable gt.
+//
+//A drop-in replacement for LinkedPriorityQueue (same interface and Iterator) whose values are in a
+//  skip list, highest priority first: level 0 links every LN (as LinkedPriorityQueue's list does),
+//  and each higher level links a random 1/4 of the LNs of the level below it, so enqueue skips
+//  over most LNs while finding where to insert: expected O(log N) instead of O(N). Values of equal
+//  priority are dequeued in the order they were enqueued. dequeue removes the first LN: O(1).
+//Each LN also links back to its predecessor on level 0: Iterator::erase walks back from the
+//  erased LN to find its predecessor on each of its levels (expected O(log N), independent of how
+//  many values have the same priority) without searching from the front.
+template<class T, bool (*tgt)(const T& a, const T& b) = undefinedgt<T>> class SkipListPriorityQueue {
+  public:
+    //Destructor/Constructors
+    ~SkipListPriorityQueue();
+
+    SkipListPriorityQueue          (bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    SkipListPriorityQueue          (const SkipListPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+    explicit SkipListPriorityQueue (const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    explicit SkipListPriorityQueue (const Iterable& i, bool (*cgt)(const T& a, const T& b) = undefinedgt<T>);
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    T&   peek       () const;
+    std::string str () const; //supplies useful debugging information; contrast to operator <<
+
+
+    //Commands
+    int  enqueue (const T& element);
+    T    dequeue ();
+    void clear   ();
+
+    //Iterable class must support "for-each" loop: .begin()/.end() and prefix ++ on returned result
+    template <class Iterable>
+    int enqueue_all (const Iterable& i);
+
+
+    //Operators
+    SkipListPriorityQueue<T,tgt>& operator = (const SkipListPriorityQueue<T,tgt>& rhs);
+    bool operator == (const SkipListPriorityQueue<T,tgt>& rhs) const;
+    bool operator != (const SkipListPriorityQueue<T,tgt>& rhs) const;
+
+    template<class T2, bool (*gt2)(const T2& a, const T2& b)>
+    friend std::ostream& operator << (std::ostream& outs, const SkipListPriorityQueue<T2,gt2>& pq);
+
+
+
+  private:
+    class LN;
+
+  public:
+    class Iterator {
+      public:
+        //Private constructor called in begin/end, which are friends of SkipListPriorityQueue<T,tgt>
+        ~Iterator();
+        T           erase();
+        std::string str  () const;
+        SkipListPriorityQueue<T,tgt>::Iterator& operator ++ ();
+        SkipListPriorityQueue<T,tgt>::Iterator  operator ++ (int);
+        bool operator == (const SkipListPriorityQueue<T,tgt>::Iterator& rhs) const;
+        bool operator != (const SkipListPriorityQueue<T,tgt>::Iterator& rhs) const;
+        T& operator *  () const;
+        T* operator -> () const;
+        friend std::ostream& operator << (std::ostream& outs, const SkipListPriorityQueue<T,tgt>::Iterator& i) {
+          outs << i.str(); //Use the same meaning as the debugging .str() method
+          return outs;
+        }
+        friend Iterator SkipListPriorityQueue<T,tgt>::begin () const;
+        friend Iterator SkipListPriorityQueue<T,tgt>::end   () const;
+
+      private:
+        //If can_erase is false, current indexes the "next" value (must ++ to reach it)
+        LN*             current;
+        SkipListPriorityQueue<T,tgt>* ref_pq;
+        int             expected_mod_count;
+        bool            can_erase = true;
+
+        //Called in friends begin/end
+        Iterator(SkipListPriorityQueue<T,tgt>* iterate_over, LN* initial);
+    };
+
+
+    Iterator begin () const;
+    Iterator end   () const;
+
+
+  private:
+    //An LN of height h is followed (in the same allocation: see new_node) by its h next pointers,
+    //  one for each level 0..h-1 that it is linked into
+    class LN {
+      public:
+        LN (const T& v, int h) : value(v), height(h) {}
+
+        LN*& next (int level) {
+          std::size_t offset = (sizeof(LN)+sizeof(LN*)-1) / sizeof(LN*) * sizeof(LN*);
+          return reinterpret_cast<LN**>(reinterpret_cast<char*>(this) + offset)[level];
+        }
+
+        T   value;
+        LN* prev = nullptr;              //Predecessor on level 0 (nullptr if first)
+        int height;
+    };
+
+    static const int MAX_LEVEL = 16;     //Expected O(log N) up to 4^16 values
+
+
+    bool (*gt) (const T& a, const T& b); // The gt used by enqueue (from template or constructor)
+    LN*  head[MAX_LEVEL];                //head[l] is the first LN on level l (nullptr if none)
+    int  levels    =  1;                 //Levels that have LNs (at least 1)
+    int  used      =  0;                 //Cache count of nodes in linked list
+    int  mod_count =  0;                 //Allows sensing concurrent modification
+    unsigned int random_state = 2463534242u;
+
+    //Helper methods
+    static LN* new_node   (const T& value, int height);
+    static void delete_node(LN* ln);
+    int  random_height    ();             //1 + number of times a 1/4 chance succeeds
+    void remove           (LN* ln);       //Unlink ln from each of its levels and delete it
+    void copy_list        (const SkipListPriorityQueue<T,tgt>& from); //Append from's LNs (same gt) to an empty list
+    void delete_list      ();             //Deallocate all LNs, and empty head
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//SkipListPriorityQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>::~SkipListPriorityQueue() {
+  delete_list();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>::SkipListPriorityQueue(bool (*cgt)(const T& a, const T& b))
+:gt(tgt != undefinedgt<T> ? tgt : cgt), head{} {
+  if (gt == undefinedgt<T>)
+    throw TemplateFunctionError("SkipListPriorityQueue::default constructor: neither specified");
+  if (tgt != undefinedgt<T> && cgt != undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("SkipListPriorityQueue::default constructor: both specified and different");
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>::SkipListPriorityQueue(const SkipListPriorityQueue<T,tgt>& to_copy, bool (*cgt)(const T& a, const T& b))
+:gt(tgt != undefinedgt<T> ? tgt : cgt), head{} {
+  if (gt == undefinedgt<T>)
+    gt = to_copy.gt;//throw TemplateFunctionError("SkipListPriorityQueue::copy constructor: neither specified");
+  if (tgt != undefinedgt<T> && cgt != undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("SkipListPriorityQueue::copy constructor: both specified and different");
+  if (gt == to_copy.gt)
+    copy_list(to_copy);
+  else
+    for (const T& element : to_copy)
+      enqueue(element);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>::SkipListPriorityQueue(const std::initializer_list<T>& il, bool (*cgt)(const T& a, const T& b))
+:gt(tgt != undefinedgt<T> ? tgt : cgt), head{} {
+  if (gt == undefinedgt<T>)
+    throw TemplateFunctionError("SkipListPriorityQueue::initializer_list constructor: neither specified");
+  if (tgt != undefinedgt<T> && cgt != undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("SkipListPriorityQueue::initializer_list constructor: both specified and different");
+  for (const T& element : il)
+    enqueue(element);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template<class Iterable>
+SkipListPriorityQueue<T,tgt>::SkipListPriorityQueue(const Iterable& i, bool (*cgt)(const T& a, const T& b))
+:gt(tgt != undefinedgt<T> ? tgt : cgt), head{} {
+  if (gt == undefinedgt<T>)
+    throw TemplateFunctionError("SkipListPriorityQueue::Iterable constructor: neither specified");
+  if (tgt != undefinedgt<T> && cgt != undefinedgt<T> && tgt != cgt)
+    throw TemplateFunctionError("SkipListPriorityQueue::Iterable constructor: both specified and different");
+  for (const T& element : i)
+    enqueue(element);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool SkipListPriorityQueue<T,tgt>::empty() const {
+  return used == 0;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int SkipListPriorityQueue<T,tgt>::size() const {
+  return used;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T& SkipListPriorityQueue<T,tgt>::peek () const {
+  if (empty())
+    throw EmptyError("SkipListPriorityQueue::peek");
+  return head[0]->value;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string SkipListPriorityQueue<T,tgt>::str() const {
+  std::ostringstream answer;
+  answer << "SkipListPriorityQueue[HEADER";
+  for (LN* p = head[0]; p != nullptr; p = p->next(0))
+    answer << "->" << p->value << "^" << p->height;
+  answer << "](used=" << used << ",levels=" << levels << ",mod_count=" << mod_count << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+//On each level (from the top down) move forward past every LN whose value has priority >= element's,
+//  remembering the link on that level that the new LN must be spliced into
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int SkipListPriorityQueue<T,tgt>::enqueue(const T& element) {
+  LN** update[MAX_LEVEL];
+  LN*  prev = nullptr;
+  for (int level = levels-1; level >= 0; --level) {
+    LN** link = (prev == nullptr ? &head[level] : &prev->next(level));
+    while (*link != nullptr && !gt(element,(*link)->value)) {
+      prev = *link;
+      link = &prev->next(level);
+    }
+    update[level] = link;
+  }
+
+  int height = random_height();
+  for (; levels < height; ++levels)
+    update[levels] = &head[levels];
+
+  LN* ln = new_node(element,height);
+  for (int level = 0; level < height; ++level) {
+    ln->next(level) = *update[level];
+    *update[level]  = ln;
+  }
+  ln->prev = prev;
+  if (ln->next(0) != nullptr)
+    ln->next(0)->prev = ln;
+  ++used;
+  ++mod_count;
+  return 1;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T SkipListPriorityQueue<T,tgt>::dequeue() {
+  if (this->empty())
+    throw EmptyError("SkipListPriorityQueue::dequeue");
+  T to_return = head[0]->value;
+  remove(head[0]);
+  ++mod_count;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void SkipListPriorityQueue<T,tgt>::clear() {
+  delete_list();
+  ++mod_count;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+template <class Iterable>
+int SkipListPriorityQueue<T,tgt>::enqueue_all (const Iterable& i) {
+  int count = 0;
+  for (const T& v : i)
+    count += enqueue(v);
+  return count;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Operators
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>& SkipListPriorityQueue<T,tgt>::operator = (const SkipListPriorityQueue<T,tgt>& rhs) {
+  if (this == &rhs)
+    return *this;
+  delete_list();
+  gt = rhs.gt;
+  copy_list(rhs);
+  ++mod_count;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool SkipListPriorityQueue<T,tgt>::operator == (const SkipListPriorityQueue<T,tgt>& rhs) const {
+  if (this == &rhs)
+    return true;
+  if (gt != rhs.gt)
+    return false;
+  if (used != rhs.used)
+    return false;
+  LN* p_lhs = head[0];
+  for (LN* p_rhs = rhs.head[0]; p_rhs != nullptr; p_rhs = p_rhs->next(0), p_lhs = p_lhs->next(0))
+    if (p_lhs->value != p_rhs->value)
+      return false;
+  return true;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool SkipListPriorityQueue<T,tgt>::operator != (const SkipListPriorityQueue<T,tgt>& rhs) const {
+  return !(*this == rhs);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::ostream& operator << (std::ostream& outs, const SkipListPriorityQueue<T,tgt>& pq) {
+  ArrayStack<T> temp;
+  for (typename SkipListPriorityQueue<T,tgt>::LN* p = pq.head[0]; p != nullptr; p = p->next(0))
+    temp.push(p->value);
+  outs << "priority_queue[";
+  if (!temp.empty())
+    outs << temp.pop();
+  while (!temp.empty())
+    outs << "," << temp.pop();
+  outs << "]:highest";
+  return outs;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator constructors
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto SkipListPriorityQueue<T,tgt>::begin () const -> SkipListPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<SkipListPriorityQueue<T,tgt>*>(this),head[0]);
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto SkipListPriorityQueue<T,tgt>::end () const -> SkipListPriorityQueue<T,tgt>::Iterator {
+  return Iterator(const_cast<SkipListPriorityQueue<T,tgt>*>(this),nullptr);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+//One allocation holds the LN and (after it, suitably aligned) its height next pointers
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto SkipListPriorityQueue<T,tgt>::new_node(const T& value, int height) -> LN* {
+  std::size_t offset = (sizeof(LN)+sizeof(LN*)-1) / sizeof(LN*) * sizeof(LN*);
+  void* memory = ::operator new(offset + height*sizeof(LN*));
+  LN* ln;
+  try {
+    ln = new (memory) LN(value,height);
+  } catch (...) {
+    ::operator delete(memory);
+    throw;
+  }
+  for (int level = 0; level < height; ++level)
+    ln->next(level) = nullptr;
+  return ln;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void SkipListPriorityQueue<T,tgt>::delete_node(LN* ln) {
+  ln->~LN();
+  ::operator delete(ln);
+}
+
+
+//xorshift32; each pair of low bits that is 0 (a 1/4 chance) adds a level
+template<class T, bool (*tgt)(const T& a, const T& b)>
+int SkipListPriorityQueue<T,tgt>::random_height() {
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  int height = 1;
+  for (unsigned int bits = random_state; height < MAX_LEVEL && (bits & 3) == 0; bits >>= 2)
+    ++height;
+  return height;
+}
+
+
+//ln's predecessor on level l is the closest LN before it whose height is > l: walk back (on
+//  level 0) from ln, moving further back only when the predecessor found so far is too short
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void SkipListPriorityQueue<T,tgt>::remove(LN* ln) {
+  LN* prev = ln->prev;
+  for (int level = 0; level < ln->height; ++level) {
+    while (prev != nullptr && prev->height <= level)
+      prev = prev->prev;
+    (prev == nullptr ? head[level] : prev->next(level)) = ln->next(level);
+  }
+  if (ln->next(0) != nullptr)
+    ln->next(0)->prev = ln->prev;
+  while (levels > 1 && head[levels-1] == nullptr)
+    --levels;
+  delete_node(ln);
+  --used;
+}
+
+
+//Copies each LN with its height, so the copy has the same shape as from
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void SkipListPriorityQueue<T,tgt>::copy_list(const SkipListPriorityQueue<T,tgt>& from) {
+  LN** tail[MAX_LEVEL];
+  for (int level = 0; level < MAX_LEVEL; ++level)
+    tail[level] = &head[level];
+  LN* last = nullptr;
+  for (LN* p = from.head[0]; p != nullptr; p = p->next(0)) {
+    LN* ln = new_node(p->value,p->height);
+    for (int level = 0; level < ln->height; ++level) {
+      *tail[level] = ln;
+      tail[level]  = &ln->next(level);
+    }
+    ln->prev = last;
+    last = ln;
+    ++used;
+  }
+  levels = from.levels;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+void SkipListPriorityQueue<T,tgt>::delete_list() {
+  for (LN* p = head[0]; p != nullptr; /*see body*/) {
+    LN* to_delete = p;
+    p = p->next(0);
+    delete_node(to_delete);
+  }
+  for (int level = 0; level < MAX_LEVEL; ++level)
+    head[level] = nullptr;
+  levels = 1;
+  used   = 0;
+}
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Iterator class definitions
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>::Iterator::Iterator(SkipListPriorityQueue<T,tgt>* iterate_over, LN* initial)
+:current(initial), ref_pq(iterate_over), expected_mod_count(ref_pq->mod_count) {
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+SkipListPriorityQueue<T,tgt>::Iterator::~Iterator()
+{}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T SkipListPriorityQueue<T,tgt>::Iterator::erase() {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::erase");
+  if (!can_erase)
+    throw CannotEraseError("SkipListPriorityQueue::Iterator::erase Iterator cursor already erased");
+  if (current == nullptr)
+    throw CannotEraseError("SkipListPriorityQueue::Iterator::erase Iterator cursor beyond data structure");
+  can_erase = false;
+  T to_return = current->value;
+  LN* to_erase = current;
+  current = current->next(0);
+  ref_pq->remove(to_erase);
+  ref_pq->mod_count++;
+  expected_mod_count = ref_pq->mod_count;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+std::string SkipListPriorityQueue<T,tgt>::Iterator::str() const {
+  std::ostringstream answer;
+  answer << ref_pq->str() << "(current=";
+  current != nullptr ? answer << current->value : answer << "nullptr";
+  answer << ",expected_mod_count=" << expected_mod_count << ",can_erase=" << can_erase << ")";
+  return answer.str();
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto SkipListPriorityQueue<T,tgt>::Iterator::operator ++ () -> SkipListPriorityQueue<T,tgt>::Iterator& {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::operator ++");
+  if (current == nullptr)
+    return *this;
+  if (can_erase)
+    current = current->next(0);
+  else
+    can_erase = true;
+  return *this;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+auto SkipListPriorityQueue<T,tgt>::Iterator::operator ++ (int) -> SkipListPriorityQueue<T,tgt>::Iterator {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::operator ++(int)");
+  if (current == nullptr)
+    return *this;
+  Iterator to_return(*this);
+  if (can_erase)
+    current = current->next(0);
+  else
+    can_erase = true;
+  return to_return;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool SkipListPriorityQueue<T,tgt>::Iterator::operator == (const SkipListPriorityQueue<T,tgt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("SkipListPriorityQueue::Iterator::operator ==");
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::operator ==");
+  if (ref_pq != rhsASI->ref_pq)
+    throw ComparingDifferentIteratorsError("SkipListPriorityQueue::Iterator::operator ==");
+  return current == rhsASI->current;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+bool SkipListPriorityQueue<T,tgt>::Iterator::operator != (const SkipListPriorityQueue<T,tgt>::Iterator& rhs) const {
+  const Iterator* rhsASI = dynamic_cast<const Iterator*>(&rhs);
+  if (rhsASI == 0)
+    throw IteratorTypeError("SkipListPriorityQueue::Iterator::operator !=");
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::operator !=");
+  if (ref_pq != rhsASI->ref_pq)
+    throw ComparingDifferentIteratorsError("SkipListPriorityQueue::Iterator::operator !=");
+  return current != rhsASI->current;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T& SkipListPriorityQueue<T,tgt>::Iterator::operator *() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::operator *");
+  if (!can_erase || current == nullptr) {
+    std::ostringstream where;
+    where << current << " when used = " << ref_pq->used;
+    throw IteratorPositionIllegal("SkipListPriorityQueue::Iterator::operator * Iterator illegal: "+where.str());
+  }
+  return current->value;
+}
+
+
+template<class T, bool (*tgt)(const T& a, const T& b)>
+T* SkipListPriorityQueue<T,tgt>::Iterator::operator ->() const {
+  if (expected_mod_count != ref_pq->mod_count)
+    throw ConcurrentModificationError("SkipListPriorityQueue::Iterator::operator ->");
+  if (!can_erase || current == nullptr) {
+    std::ostringstream where;
+    where << current << " when used = " << ref_pq->used;
+    throw IteratorPositionIllegal("SkipListPriorityQueue::Iterator::operator -> Iterator illegal: "+where.str());
+  }
+  return &current->value;
+}
+
+
+}
+
+#endif /* SKIP_LIST_PRIORITY_QUEUE_HPP_ */
@@ -0,0 +1,338 @@
+#ifndef SPSC_RING_QUEUE_HPP_
+#define SPSC_RING_QUEUE_HPP_
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstddef>              //For std::size_t
+#include <new>                  //For placement new
+#include <type_traits>          //For std::aligned_storage
+#include <utility>              //For std::move
+#include <algorithm>            //For std::min
+#include "ics_exceptions.hpp"
+
+
+namespace ics {
+
+
+//Wait strategies for SPSCRingQueue: wait(ready) returns once ready() is true; notify() is called
+//  after each change that might make a waiting thread's ready() true.
+
+//Spin briefly, then yield the core until ready: lowest latency when each stage has its own core
+class SpinYieldWait {
+  public:
+    template<class Ready>
+    void wait (Ready ready) {
+      for (int spins=0; !ready(); ++spins)
+        if (spins >= 64)
+          std::this_thread::yield();
+    }
+    void notify () {}
+};
+
+
+//Spin briefly, then sleep on a condition_variable: uses no CPU while a stage is idle, at the cost
+//  of a system call to wake it. waiting is checked (after a fence) by notify, so a queue with no
+//  sleeping thread never locks the mutex.
+class BlockingWait {
+  public:
+    template<class Ready>
+    void wait (Ready ready) {
+      for (int spins=0; spins < 64; ++spins)
+        if (ready())
+          return;
+      ++waiting;
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        changed.wait(guard, ready);
+      }
+      --waiting;
+    }
+    void notify () {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (waiting.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> guard(lock);
+        changed.notify_all();
+      }
+    }
+
+  private:
+    std::mutex              lock;
+    std::condition_variable changed;
+    std::atomic<int>        waiting{0};
+};
+
+
+//A bounded queue connecting exactly one producer thread (which calls only the enqueue methods) to
+//  one consumer thread (which calls only the dequeue methods): a ring of capacity slots (rounded up
+//  to a power of 2), allocated once. Only the producer writes rear and only the consumer writes
+//  front, so no compare_exchange is needed, and each is on its own cache line. Each side also keeps
+//  a cached copy of the other's index and reloads it (moving its cache line between cores) only
+//  when the cached copy says the ring is full (or empty). The bulk enqueue_n/dequeue_n move many
+//  values per index update.
+//enqueue waits (using a Wait strategy, see above) while the ring is full, and dequeue waits while
+//  it is empty; the try_ methods do not wait. When the producer is done it calls close: then the
+//  consumer's dequeue raises EmptyError (and dequeue_n returns 0) once the ring is empty.
+//
+//size is exact only when neither thread is enqueueing or dequeueing. There is no Iterator, and the
+//  queue cannot be copied.
+template<class T, class Wait = SpinYieldWait> class SPSCRingQueue {
+  public:
+    //Destructor/Constructors
+    ~SPSCRingQueue();
+
+    explicit SPSCRingQueue (int capacity);
+    SPSCRingQueue          (const SPSCRingQueue<T,Wait>& to_copy) = delete;
+
+
+    //Queries
+    bool empty      () const;
+    int  size       () const;
+    int  capacity   () const;
+    bool closed     () const;
+    std::string str () const; //supplies useful debugging information (only when no thread is changing it)
+
+
+    //Commands (producer)
+    int  enqueue     (const T& element);            //Waits while full
+    bool try_enqueue (const T& element);            //false (and not enqueued) if full
+    int  enqueue_n   (const T* elements, int n);    //Waits until all n are enqueued
+    void close       ();                            //No more enqueues
+
+    //Commands (consumer)
+    T    dequeue     ();                            //Waits while empty (EmptyError if empty and closed)
+    bool try_dequeue (T& element);                  //false (and element unchanged) if empty
+    int  dequeue_n   (T* elements, int n);          //Waits for at least 1, dequeues up to n (0 if empty and closed)
+
+
+    //Operators
+    SPSCRingQueue<T,Wait>& operator = (const SPSCRingQueue<T,Wait>& rhs) = delete;
+
+
+  private:
+    typedef typename std::aligned_storage<sizeof(T),alignof(T)>::type Slot;
+
+    Slot*       ring;
+    std::size_t mask;                          //capacity-1
+
+    char                     pad0[64];
+    std::atomic<std::size_t> rear{0};          //Written by the producer
+    std::size_t              front_cache = 0;  //Producer's copy of front
+    char                     pad1[64];
+    std::atomic<std::size_t> front{0};         //Written by the consumer
+    std::size_t              rear_cache = 0;   //Consumer's copy of rear
+    char                     pad2[64];
+    std::atomic<bool>        is_closed{false};
+    Wait                     not_empty;        //The consumer waits here
+    Wait                     not_full;         //The producer waits here
+
+    //Helper methods
+    T*  at          (std::size_t position) {return reinterpret_cast<T*>(&ring[position & mask]);}
+    int free_slots  ();                        //Producer: at least this many can be enqueued
+    int used_slots  ();                        //Consumer: at least this many can be dequeued
+};
+
+
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//SPSCRingQueue class and related definitions
+
+//Destructor/Constructors
+
+template<class T, class Wait>
+SPSCRingQueue<T,Wait>::~SPSCRingQueue() {
+  for (std::size_t p = front.load(); p != rear.load(); ++p)
+    at(p)->~T();
+  delete [] ring;
+}
+
+
+template<class T, class Wait>
+SPSCRingQueue<T,Wait>::SPSCRingQueue(int capacity) {
+  if (capacity < 1) {
+    std::ostringstream answer;
+    answer << "SPSCRingQueue::capacity constructor: capacity(" << capacity << ") < 1";
+    throw IcsError(answer.str());
+  }
+  std::size_t length = 1;
+  while (length < std::size_t(capacity))
+    length *= 2;
+  mask = length-1;
+  ring = new Slot[length];
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Queries
+
+template<class T, class Wait>
+bool SPSCRingQueue<T,Wait>::empty() const {
+  return size() == 0;
+}
+
+
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::size() const {
+  std::size_t f = front.load(), r = rear.load();
+  return r > f ? int(r-f) : 0;
+}
+
+
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::capacity() const {
+  return mask+1;
+}
+
+
+template<class T, class Wait>
+bool SPSCRingQueue<T,Wait>::closed() const {
+  return is_closed.load();
+}
+
+
+template<class T, class Wait>
+std::string SPSCRingQueue<T,Wait>::str() const {
+  std::ostringstream answer;
+  answer << "spsc_ring[";
+  for (std::size_t p = front.load(); p != rear.load(); ++p)
+    answer << (p == front.load() ? "" : ",") << (p & mask) << ":"
+           << *reinterpret_cast<const T*>(&ring[p & mask]);
+  answer << "](capacity=" << mask+1 << ",front=" << front.load() << ",rear=" << rear.load()
+         << ",front_cache=" << front_cache << ",rear_cache=" << rear_cache << ",closed=" << is_closed.load() << ")";
+  return answer.str();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Commands
+
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::enqueue(const T& element) {
+  if (!try_enqueue(element)) {
+    not_full.wait([this] {return free_slots() > 0;});
+    try_enqueue(element);
+  }
+  return 1;
+}
+
+
+template<class T, class Wait>
+bool SPSCRingQueue<T,Wait>::try_enqueue(const T& element) {
+  if (free_slots() == 0)
+    return false;
+  std::size_t r = rear.load(std::memory_order_relaxed);
+  new (at(r)) T(element);
+  rear.store(r+1, std::memory_order_release);
+  not_empty.notify();
+  return true;
+}
+
+
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::enqueue_n(const T* elements, int n) {
+  for (int done = 0; done < n; /*see body*/) {
+    int room = free_slots();
+    if (room == 0) {
+      not_full.wait([this] {return free_slots() > 0;});
+      continue;
+    }
+    std::size_t r = rear.load(std::memory_order_relaxed);
+    int batch = std::min(room, n-done);
+    for (int i=0; i<batch; ++i)
+      new (at(r+i)) T(elements[done+i]);
+    rear.store(r+batch, std::memory_order_release);
+    not_empty.notify();
+    done += batch;
+  }
+  return n;
+}
+
+
+template<class T, class Wait>
+void SPSCRingQueue<T,Wait>::close() {
+  is_closed.store(true);
+  not_empty.notify();
+}
+
+
+template<class T, class Wait>
+T SPSCRingQueue<T,Wait>::dequeue() {
+  T to_return;
+  if (dequeue_n(&to_return,1) == 0)
+    throw EmptyError("SPSCRingQueue::dequeue");
+  return to_return;
+}
+
+
+template<class T, class Wait>
+bool SPSCRingQueue<T,Wait>::try_dequeue(T& element) {
+  if (used_slots() == 0)
+    return false;
+  std::size_t f = front.load(std::memory_order_relaxed);
+  element = std::move(*at(f));
+  at(f)->~T();
+  front.store(f+1, std::memory_order_release);
+  not_full.notify();
+  return true;
+}
+
+
+//is_closed is checked before used_slots: if the ring is empty after close was seen, the producer
+//  has finished (every enqueue precedes its close)
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::dequeue_n(T* elements, int n) {
+  if (n <= 0)
+    return 0;
+  int available = used_slots();
+  if (available == 0) {
+    not_empty.wait([this] {return is_closed.load() || used_slots() > 0;});
+    available = used_slots();
+    if (available == 0)
+      return 0;
+  }
+  std::size_t f = front.load(std::memory_order_relaxed);
+  int batch = std::min(available, n);
+  for (int i=0; i<batch; ++i) {
+    elements[i] = std::move(*at(f+i));
+    at(f+i)->~T();
+  }
+  front.store(f+batch, std::memory_order_release);
+  not_full.notify();
+  return batch;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+//Private helper methods
+
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::free_slots() {
+  std::size_t r = rear.load(std::memory_order_relaxed);
+  if (r - front_cache > mask)
+    front_cache = front.load(std::memory_order_acquire);
+  return int(mask+1 - (r - front_cache));
+}
+
+
+template<class T, class Wait>
+int SPSCRingQueue<T,Wait>::used_slots() {
+  std::size_t f = front.load(std::memory_order_relaxed);
+  if (rear_cache == f)
+    rear_cache = rear.load(std::memory_order_acquire);
+  return int(rear_cache - f);
+}
+
+}
+
+#endif /* SPSC_RING_QUEUE_HPP_ */
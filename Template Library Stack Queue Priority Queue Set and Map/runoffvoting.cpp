@@ -96,9 +96,12 @@ CandidateTally evaluate_ballot(const Preferences& preferences, const CandidateSe
 CandidateSet remaining_candidates(const CandidateTally& tally) {
   CandidateSet candidateSet;
   int minimal_votes=std::numeric_limits<int>::max();
-  for(const TallyEntry& kv:TallyEntryPQ(tally, (bool (*)(const TallyEntry& a, const TallyEntry& b)){
-    [](const TallyEntry&a, const TallyEntry&b){return a.second<b.second;}}))
-    kv.second<=minimal_votes? minimal_votes=kv.second : candidateSet.insert(kv.first);
+  for(const TallyEntry& kv:tally)           //Only the minimum matters: no need to sort the tally
+    if(kv.second<minimal_votes)
+      minimal_votes=kv.second;
+  for(const TallyEntry& kv:tally)
+    if(kv.second>minimal_votes)
+      candidateSet.insert(kv.first);
   return candidateSet;
 }
 